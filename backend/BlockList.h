@@ -0,0 +1,190 @@
+//
+// BlockList.h - Sorted sequence stored as fixed-size blocks, for versions
+// that are copied on every write. A copy shares every block with the
+// original and takes its own copy of a block only when it changes one, so
+// an edit costs the block list plus the blocks it touches rather than the
+// whole sequence. A version that has been published must not be changed;
+// edit a copy and publish that instead.
+//
+
+#ifndef BLOCK_LIST_H
+#define BLOCK_LIST_H
+
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+
+template <typename T>
+class BlockList {
+public:
+    // A full block splits in two on the next insert; one that falls below a
+    // quarter of this merges with a neighbour when both fit in one block
+    static const size_t BLOCK_SIZE = 512;
+
+private:
+    typedef std::vector<T> Block;
+
+    // No block is empty. One whose count is 1 belongs to this list alone
+    // (writers are serialized, and older versions only ever let go of
+    // theirs), so it can be changed in place.
+    std::vector<std::shared_ptr<Block>> blocks;
+    size_t count;
+
+    Block& writable(size_t index) {
+        if (blocks[index].use_count() != 1) {
+            blocks[index] = std::make_shared<Block>(*blocks[index]);
+        }
+        return *blocks[index];
+    }
+
+    void mergeIfSparse(size_t index) {
+        if (blocks[index]->size() >= BLOCK_SIZE / 4 || blocks.size() < 2) return;
+        size_t first = index + 1 < blocks.size() ? index : index - 1;
+        if (blocks[first]->size() + blocks[first + 1]->size() > BLOCK_SIZE) return;
+        Block& into = writable(first);
+        into.insert(into.end(), blocks[first + 1]->begin(), blocks[first + 1]->end());
+        blocks.erase(blocks.begin() + static_cast<std::ptrdiff_t>(first + 1));
+    }
+
+public:
+    // ------------------------------------------------------------------------
+    // Iterator - Read-only and bidirectional; invalidated by any change to
+    // the list's shape (insert, erase, push_back), not by replace()
+    // ------------------------------------------------------------------------
+    class Iterator {
+    private:
+        friend class BlockList;
+        const BlockList* list;
+        size_t block;
+        size_t offset;
+
+        Iterator(const BlockList* list, size_t block, size_t offset) : list(list), block(block), offset(offset) {}
+
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        Iterator() : list(nullptr), block(0), offset(0) {}
+
+        const T& operator*() const { return (*list->blocks[block])[offset]; }
+        const T* operator->() const { return &**this; }
+
+        Iterator& operator++() {
+            if (++offset == list->blocks[block]->size()) {
+                block++;
+                offset = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator was = *this;
+            ++*this;
+            return was;
+        }
+
+        Iterator& operator--() {
+            if (offset == 0) {
+                offset = list->blocks[--block]->size();
+            }
+            offset--;
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator was = *this;
+            --*this;
+            return was;
+        }
+
+        bool operator==(const Iterator& other) const { return block == other.block && offset == other.offset; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+    };
+
+    typedef Iterator const_iterator;
+    typedef std::reverse_iterator<Iterator> const_reverse_iterator;
+
+    BlockList() : count(0) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Iterator begin() const { return Iterator(this, 0, 0); }
+    Iterator end() const { return Iterator(this, blocks.size(), 0); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // First element for which less(element, key) is false, given the list
+    // is partitioned by it
+    template <typename Key, typename Less>
+    Iterator lowerBound(const Key& key, Less less) const {
+        auto in = std::partition_point(blocks.begin(), blocks.end(),
+            [&](const std::shared_ptr<Block>& block) { return less(block->back(), key); });
+        if (in == blocks.end()) return end();
+        auto at = std::lower_bound((*in)->begin(), (*in)->end(), key, less);
+        return Iterator(this, static_cast<size_t>(in - blocks.begin()), static_cast<size_t>(at - (*in)->begin()));
+    }
+
+    // First element for which less(key, element) is true
+    template <typename Key, typename Less>
+    Iterator upperBound(const Key& key, Less less) const {
+        auto in = std::partition_point(blocks.begin(), blocks.end(),
+            [&](const std::shared_ptr<Block>& block) { return !less(key, block->back()); });
+        if (in == blocks.end()) return end();
+        auto at = std::upper_bound((*in)->begin(), (*in)->end(), key, less);
+        return Iterator(this, static_cast<size_t>(in - blocks.begin()), static_cast<size_t>(at - (*in)->begin()));
+    }
+
+    // Insert before at, which must be an iterator into this list
+    void insert(Iterator at, T value) {
+        // At the end, fill the last block before starting another
+        if (at.block == blocks.size()) {
+            push_back(std::move(value));
+            return;
+        }
+        Block& block = writable(at.block);
+        block.insert(block.begin() + static_cast<std::ptrdiff_t>(at.offset), std::move(value));
+        count++;
+        if (block.size() > BLOCK_SIZE) {
+            auto half = block.begin() + static_cast<std::ptrdiff_t>(block.size() / 2);
+            std::shared_ptr<Block> upper = std::make_shared<Block>(std::make_move_iterator(half),
+                                                                    std::make_move_iterator(block.end()));
+            block.erase(half, block.end());
+            blocks.insert(blocks.begin() + static_cast<std::ptrdiff_t>(at.block + 1), std::move(upper));
+        }
+    }
+
+    void erase(Iterator at) {
+        Block& block = writable(at.block);
+        block.erase(block.begin() + static_cast<std::ptrdiff_t>(at.offset));
+        count--;
+        if (block.empty()) {
+            blocks.erase(blocks.begin() + static_cast<std::ptrdiff_t>(at.block));
+        } else {
+            mergeIfSparse(at.block);
+        }
+    }
+
+    void replace(Iterator at, T value) {
+        writable(at.block)[at.offset] = std::move(value);
+    }
+
+    void push_back(T value) {
+        if (blocks.empty() || blocks.back()->size() >= BLOCK_SIZE) {
+            blocks.push_back(std::make_shared<Block>());
+            blocks.back()->reserve(BLOCK_SIZE);
+        }
+        writable(blocks.size() - 1).push_back(std::move(value));
+        count++;
+    }
+
+    // Blocks, for tests and metrics
+    size_t blockCount() const { return blocks.size(); }
+};
+
+#endif // BLOCK_LIST_H
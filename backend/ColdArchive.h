@@ -0,0 +1,453 @@
+//
+// ColdArchive.h - Immutable, compressed segments for archived items
+// Archived and claimed items leave the in-memory store at a checkpoint and
+// are written to a cold segment file (<snapshot>.cold.N). Layout
+// (little-endian):
+//   [header][compressed blocks][block table][index][ids]
+// Items are sorted by id and serialized into blocks of about
+// COLD_BLOCK_SIZE raw bytes, each compressed on its own. The index has a
+// fixed 16-byte entry per item (id position, kind, block, offset in
+// block), so a lookup is a binary search over the mapping and one block
+// decode, and counting by type decodes nothing. Segments are never
+// modified; deleting or changing an archived item leaves a tombstone in
+// memory until a later checkpoint rewrites the segment without it.
+//
+
+#ifndef COLD_ARCHIVE_H
+#define COLD_ARCHIVE_H
+
+#include "DataStructures.h"
+#include "ImageCodec.h"
+#include "Compression.h"
+#include "Snapshot.h"
+#include "Wal.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+static const char COLD_MAGIC[8] = {'L', 'F', 'C', 'O', 'L', 'D', '\r', '\n'};
+static const uint32_t COLD_VERSION = 1;
+static const size_t COLD_BLOCK_SIZE = 64 * 1024;   // Raw record bytes per block, about
+static const size_t COLD_MAX_ID_LENGTH = UINT16_MAX;    // Longer ids don't fit the index; such items stay hot
+
+// Item type as kept in the index, so counts by type need no decoding
+enum ColdItemKind : uint8_t {
+    COLD_OTHER = 0,
+    COLD_LOST = 1,
+    COLD_FOUND = 2
+};
+
+inline ColdItemKind coldKind(const std::string& type) {
+    if (type == "lost") return COLD_LOST;
+    if (type == "found") return COLD_FOUND;
+    return COLD_OTHER;
+}
+
+struct ColdHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerChecksum;    // crc32 of the header with this field zeroed
+    uint64_t itemCount;
+    uint64_t blockCount;
+    uint64_t blockTableOffset;  // Block table, index and ids follow each other to the end
+    uint64_t indexOffset;
+    uint64_t idsOffset;
+    uint64_t idsSize;
+    uint32_t tableChecksum;     // crc32 from blockTableOffset to the end of the file
+    uint32_t reserved;
+};
+
+struct ColdBlock {
+    uint64_t offset;
+    uint32_t compressedSize;
+    uint32_t rawSize;
+    uint32_t checksum;          // crc32 of the compressed bytes
+    uint32_t reserved;
+};
+
+struct ColdIndexEntry {
+    uint32_t idOffset;
+    uint16_t idLength;
+    uint8_t kind;
+    uint8_t reserved;
+    uint32_t block;
+    uint32_t offset;            // Of the record within the decoded block
+};
+
+static_assert(sizeof(ColdHeader) == 72, "cold segment header layout changed");
+static_assert(sizeof(ColdBlock) == 24, "cold block layout changed");
+static_assert(sizeof(ColdIndexEntry) == 16, "cold index layout changed");
+
+inline void putColdItem(ImageWriter& out, const Item& item) {
+    out.str(item.id);
+    out.str(item.name);
+    out.str(item.color);
+    out.str(item.location);
+    out.str(item.owner);
+    out.str(item.email);
+    out.str(item.type);
+    out.str(item.description);
+    out.str(item.claimedBy);
+    out.u64(static_cast<uint64_t>(item.timestamp));
+    out.u64(static_cast<uint64_t>(item.expiresAt));
+    out.u64(static_cast<uint64_t>(item.claimedAt));
+    out.u8(static_cast<uint8_t>(item.category));
+    out.u8(item.archived ? 1 : 0);
+    out.u8(item.claimed ? 1 : 0);
+}
+
+inline bool getColdItem(ImageReader& in, Item& item) {
+    item.id = in.str();
+    item.name = in.str();
+    item.color = in.str();
+    item.location = in.str();
+    item.owner = in.str();
+    item.email = in.str();
+    item.type = in.str();
+    item.description = in.str();
+    item.claimedBy = in.str();
+    item.timestamp = static_cast<long long>(in.u64());
+    item.expiresAt = static_cast<long long>(in.u64());
+    item.claimedAt = static_cast<long long>(in.u64());
+    uint8_t category = in.u8();
+    item.category = category <= static_cast<uint8_t>(Category::OTHER) ? static_cast<Category>(category) : Category::OTHER;
+    item.archived = in.u8() != 0;
+    item.claimed = in.u8() != 0;
+    return in.ok();
+}
+
+// ============================================================================
+// COLD SEGMENT - One read-only segment file, mapped
+// ============================================================================
+class ColdSegment {
+private:
+    MappedFile file;
+    ColdHeader header;
+    uint64_t number;
+
+    ColdBlock block(size_t index) const {
+        ColdBlock entry;
+        std::memcpy(&entry, file.data() + header.blockTableOffset + index * sizeof(ColdBlock), sizeof(entry));
+        return entry;
+    }
+
+    ColdIndexEntry entry(size_t index) const {
+        ColdIndexEntry entry;
+        std::memcpy(&entry, file.data() + header.indexOffset + index * sizeof(ColdIndexEntry), sizeof(entry));
+        return entry;
+    }
+
+    int compareId(size_t index, const std::string& id) const {
+        ColdIndexEntry at = entry(index);
+        const char* stored = file.data() + header.idsOffset + at.idOffset;
+        int order = std::memcmp(stored, id.data(), std::min<size_t>(at.idLength, id.size()));
+        if (order != 0) return order;
+        return at.idLength < id.size() ? -1 : (at.idLength > id.size() ? 1 : 0);
+    }
+
+    bool decodeBlock(size_t index, std::string& raw) const {
+        ColdBlock entry = block(index);
+        if (entry.offset + entry.compressedSize > header.blockTableOffset) return false;
+        const char* data = file.data() + entry.offset;
+        return crc32(data, entry.compressedSize) == entry.checksum &&
+               lzDecompress(data, entry.compressedSize, entry.rawSize, raw);
+    }
+
+public:
+    ColdSegment() : number(0) {
+        std::memset(&header, 0, sizeof(header));
+    }
+
+    // The complete file for items, which must be sorted by id without
+    // repeats and have ids of at most COLD_MAX_ID_LENGTH bytes
+    static std::string encode(const std::vector<const Item*>& items) {
+        std::string blocks;
+        std::vector<ColdBlock> table;
+        std::vector<ColdIndexEntry> index;
+        std::string ids;
+        std::string raw;
+        ImageWriter out(raw);
+
+        auto flush = [&]() {
+            if (raw.empty()) return;
+            std::string compressed = lzCompress(raw.data(), raw.size());
+            ColdBlock entry;
+            std::memset(&entry, 0, sizeof(entry));
+            entry.offset = sizeof(ColdHeader) + blocks.size();
+            entry.compressedSize = static_cast<uint32_t>(compressed.size());
+            entry.rawSize = static_cast<uint32_t>(raw.size());
+            entry.checksum = crc32(compressed.data(), compressed.size());
+            table.push_back(entry);
+            blocks += compressed;
+            raw.clear();
+        };
+
+        for (const Item* item : items) {
+            ColdIndexEntry entry;
+            std::memset(&entry, 0, sizeof(entry));
+            entry.idOffset = static_cast<uint32_t>(ids.size());
+            entry.idLength = static_cast<uint16_t>(item->id.size());
+            entry.kind = coldKind(item->type);
+            entry.block = static_cast<uint32_t>(table.size());
+            entry.offset = static_cast<uint32_t>(raw.size());
+            ids += item->id;
+            index.push_back(entry);
+            putColdItem(out, *item);
+            if (raw.size() >= COLD_BLOCK_SIZE) flush();
+        }
+        flush();
+
+        ColdHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, COLD_MAGIC, sizeof(header.magic));
+        header.version = COLD_VERSION;
+        header.itemCount = index.size();
+        header.blockCount = table.size();
+        header.blockTableOffset = sizeof(ColdHeader) + blocks.size();
+        header.indexOffset = header.blockTableOffset + table.size() * sizeof(ColdBlock);
+        header.idsOffset = header.indexOffset + index.size() * sizeof(ColdIndexEntry);
+        header.idsSize = ids.size();
+
+        std::string tail;
+        tail.append(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(ColdBlock));
+        tail.append(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(ColdIndexEntry));
+        tail += ids;
+        header.tableChecksum = crc32(tail.data(), tail.size());
+        header.headerChecksum = crc32(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::string file;
+        file.reserve(sizeof(header) + blocks.size() + tail.size());
+        file.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        file += blocks;
+        file += tail;
+        return file;
+    }
+
+    // Checks everything but the blocks, which are checked as they are read
+    bool open(const std::string& path, uint64_t segmentNumber, std::string& error) {
+        number = segmentNumber;
+        if (!file.open(path)) {
+            error = "cannot read " + path;
+            return false;
+        }
+        if (!hostIsLittleEndian() || file.size() < sizeof(ColdHeader)) {
+            error = path + " is not a cold segment";
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        uint32_t checksum = header.headerChecksum;
+        header.headerChecksum = 0;
+        if (std::memcmp(header.magic, COLD_MAGIC, sizeof(header.magic)) != 0 ||
+            crc32(reinterpret_cast<const char*>(&header), sizeof(header)) != checksum ||
+            header.version != COLD_VERSION) {
+            error = path + " is not a cold segment or its header is damaged";
+            return false;
+        }
+        if (header.blockTableOffset > file.size() ||
+            header.blockCount > (file.size() - header.blockTableOffset) / sizeof(ColdBlock) ||
+            header.indexOffset != header.blockTableOffset + header.blockCount * sizeof(ColdBlock) ||
+            header.itemCount > (file.size() - header.indexOffset) / sizeof(ColdIndexEntry) ||
+            header.idsOffset != header.indexOffset + header.itemCount * sizeof(ColdIndexEntry) ||
+            header.idsOffset + header.idsSize != file.size() ||
+            crc32(file.data() + header.blockTableOffset, file.size() - header.blockTableOffset) != header.tableChecksum) {
+            error = path + " is truncated or damaged";
+            return false;
+        }
+        for (size_t i = 0; i < header.itemCount; i++) {
+            ColdIndexEntry at = entry(i);
+            if (static_cast<uint64_t>(at.idOffset) + at.idLength > header.idsSize || at.block >= header.blockCount) {
+                error = path + " has a damaged index";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t getNumber() const { return number; }
+    size_t size() const { return static_cast<size_t>(header.itemCount); }
+    size_t bytes() const { return file.size(); }
+
+    // Position of id, or size() if it isn't here
+    size_t find(const std::string& id) const {
+        size_t low = 0, high = size();
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (compareId(middle, id) < 0) low = middle + 1;
+            else high = middle;
+        }
+        return (low < size() && compareId(low, id) == 0) ? low : size();
+    }
+
+    std::string id(size_t index) const {
+        ColdIndexEntry at = entry(index);
+        return std::string(file.data() + header.idsOffset + at.idOffset, at.idLength);
+    }
+
+    ColdItemKind kind(size_t index) const {
+        return static_cast<ColdItemKind>(entry(index).kind);
+    }
+
+    // False if its block is damaged
+    bool item(size_t index, Item& item) const {
+        ColdIndexEntry at = entry(index);
+        std::string raw;
+        if (!decodeBlock(at.block, raw) || at.offset >= raw.size()) return false;
+        ImageReader in(raw.data() + at.offset, raw.size() - at.offset);
+        return getColdItem(in, item);
+    }
+
+    // Every item in id order, a block at a time. Items in a damaged block
+    // are skipped and the result is false.
+    bool forEach(const std::function<void(const Item&)>& visit) const {
+        bool intact = true;
+        std::string raw;
+        Item item;
+        for (size_t i = 0; i < header.blockCount; i++) {
+            if (!decodeBlock(i, raw)) {
+                intact = false;
+                continue;
+            }
+            ImageReader in(raw.data(), raw.size());
+            while (!in.atEnd() && getColdItem(in, item)) {
+                visit(item);
+            }
+            intact = intact && in.atEnd();
+        }
+        return intact;
+    }
+};
+
+// ============================================================================
+// COLD ARCHIVE - The live segments and what has been deleted from them
+// Copied and republished on every change; readers keep the version they
+// loaded. An id is live in at most one place, the hot store included:
+// taking an item out of a segment (delete, or an update that moves it back
+// into memory) always tombstones it there.
+// ============================================================================
+class ColdArchive {
+public:
+    struct Tier {
+        std::shared_ptr<const ColdSegment> segment;
+        std::unordered_set<std::string> deleted;
+    };
+
+private:
+    std::vector<Tier> tiers;    // Oldest first
+
+    bool live(const Tier& tier, size_t index) const {
+        return tier.deleted.empty() || tier.deleted.count(tier.segment->id(index)) == 0;
+    }
+
+public:
+    const std::vector<Tier>& getTiers() const { return tiers; }
+
+    void add(Tier tier) {
+        tiers.push_back(std::move(tier));
+    }
+
+    // Replace the tiers at positions (ascending) with one new tier, or just
+    // drop them if merged has no segment
+    void replace(const std::vector<size_t>& positions, Tier merged) {
+        for (auto it = positions.rbegin(); it != positions.rend(); ++it) {
+            tiers.erase(tiers.begin() + *it);
+        }
+        if (merged.segment) tiers.push_back(std::move(merged));
+    }
+
+    bool find(const std::string& id, Item& item) const {
+        for (auto tier = tiers.rbegin(); tier != tiers.rend(); ++tier) {
+            size_t at = tier->segment->find(id);
+            if (at < tier->segment->size() && tier->deleted.count(id) == 0) {
+                return tier->segment->item(at, item);
+            }
+        }
+        return false;
+    }
+
+    // Tombstone id; false if it isn't live here
+    bool remove(const std::string& id) {
+        for (auto tier = tiers.rbegin(); tier != tiers.rend(); ++tier) {
+            if (tier->segment->find(id) < tier->segment->size() && tier->deleted.insert(id).second) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Live items, each tier in id order
+    bool forEach(const std::function<void(const Item&)>& visit) const {
+        bool intact = true;
+        for (const Tier& tier : tiers) {
+            intact = tier.segment->forEach([&tier, &visit](const Item& item) {
+                if (tier.deleted.count(item.id) == 0) visit(item);
+            }) && intact;
+        }
+        return intact;
+    }
+
+    size_t count() const {
+        size_t total = 0;
+        for (const Tier& tier : tiers) {
+            total += tier.segment->size() - tier.deleted.size();
+        }
+        return total;
+    }
+
+    size_t count(ColdItemKind kind) const {
+        size_t total = 0;
+        for (const Tier& tier : tiers) {
+            for (size_t i = 0; i < tier.segment->size(); i++) {
+                if (tier.segment->kind(i) == kind && live(tier, i)) total++;
+            }
+        }
+        return total;
+    }
+
+    size_t tombstones() const {
+        size_t total = 0;
+        for (const Tier& tier : tiers) {
+            total += tier.deleted.size();
+        }
+        return total;
+    }
+
+    size_t bytes() const {
+        size_t total = 0;
+        for (const Tier& tier : tiers) {
+            total += tier.segment->bytes();
+        }
+        return total;
+    }
+
+    std::vector<uint64_t> segmentNumbers() const {
+        std::vector<uint64_t> numbers;
+        for (const Tier& tier : tiers) {
+            numbers.push_back(tier.segment->getNumber());
+        }
+        return numbers;
+    }
+
+    // Tiers worth rewriting alongside the next new segment: those with
+    // tombstones, then the smallest others until at most maxSegments remain
+    std::vector<size_t> compactionPlan(size_t maxSegments) const {
+        std::vector<size_t> plan, kept;
+        for (size_t i = 0; i < tiers.size(); i++) {
+            (tiers[i].deleted.empty() ? kept : plan).push_back(i);
+        }
+        std::sort(kept.begin(), kept.end(), [this](size_t a, size_t b) {
+            return tiers[a].segment->size() < tiers[b].segment->size();
+        });
+        for (size_t i = 0; i < kept.size() && kept.size() - i + 1 > maxSegments; i++) {
+            plan.push_back(kept[i]);
+        }
+        std::sort(plan.begin(), plan.end());
+        return plan;
+    }
+};
+
+#endif // COLD_ARCHIVE_H
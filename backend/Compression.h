@@ -0,0 +1,114 @@
+//
+// Compression.h - Small LZ77 block compressor, no external dependencies
+// A block is a run of sequences, each a token byte (literal count in the
+// high nibble, match length - 4 in the low one; 15 means more length
+// bytes follow, 255 at a time), the literals, then a little-endian u16
+// distance back into the output. The last sequence has literals only.
+// Meant for item records, which repeat field values and id prefixes a lot:
+// fast to decode and a few times smaller, not a general purpose codec.
+//
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+static const size_t LZ_MIN_MATCH = 4;
+static const size_t LZ_MAX_DISTANCE = 65535;
+static const int LZ_HASH_BITS = 13;
+
+inline void lzPutLength(std::string& out, size_t length) {
+    while (length >= 255) {
+        out += static_cast<char>(255);
+        length -= 255;
+    }
+    out += static_cast<char>(length);
+}
+
+inline void lzPutSequence(std::string& out, const char* literals, size_t literalCount,
+                          size_t distance, size_t matchLength) {
+    size_t matchCode = matchLength > 0 ? matchLength - LZ_MIN_MATCH : 0;
+    uint8_t token = static_cast<uint8_t>((literalCount < 15 ? literalCount : 15) << 4);
+    token |= static_cast<uint8_t>(matchCode < 15 ? matchCode : 15);
+    out += static_cast<char>(token);
+    if (literalCount >= 15) lzPutLength(out, literalCount - 15);
+    out.append(literals, literalCount);
+    if (matchLength == 0) return;
+    out += static_cast<char>(distance & 0xFF);
+    out += static_cast<char>(distance >> 8);
+    if (matchCode >= 15) lzPutLength(out, matchCode - 15);
+}
+
+inline std::string lzCompress(const char* data, size_t size) {
+    std::string out;
+    out.reserve(size / 2 + 16);
+    std::vector<uint32_t> table(static_cast<size_t>(1) << LZ_HASH_BITS, UINT32_MAX);
+    auto hashAt = [data](size_t pos) {
+        uint32_t word;
+        std::memcpy(&word, data + pos, 4);
+        return (word * 2654435761u) >> (32 - LZ_HASH_BITS);
+    };
+
+    size_t anchor = 0;      // First byte not yet emitted
+    size_t pos = 0;
+    while (pos + LZ_MIN_MATCH <= size) {
+        uint32_t& slot = table[hashAt(pos)];
+        size_t candidate = slot;
+        slot = static_cast<uint32_t>(pos);
+        if (candidate == UINT32_MAX || pos - candidate > LZ_MAX_DISTANCE ||
+            std::memcmp(data + candidate, data + pos, LZ_MIN_MATCH) != 0) {
+            pos++;
+            continue;
+        }
+        size_t length = LZ_MIN_MATCH;
+        while (pos + length < size && data[candidate + length] == data[pos + length]) length++;
+        lzPutSequence(out, data + anchor, pos - anchor, pos - candidate, length);
+        pos += length;
+        anchor = pos;
+    }
+    lzPutSequence(out, data + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+// False if block is damaged or doesn't decode to exactly rawSize bytes
+inline bool lzDecompress(const char* block, size_t size, size_t rawSize, std::string& out) {
+    out.clear();
+    out.reserve(rawSize);
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(block);
+    const uint8_t* end = in + size;
+    auto readLength = [&in, end](size_t& length) {
+        while (true) {
+            if (in == end) return false;
+            uint8_t more = *in++;
+            length += more;
+            if (more != 255) return true;
+        }
+    };
+
+    while (in < end) {
+        uint8_t token = *in++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(literals)) return false;
+        if (static_cast<size_t>(end - in) < literals || out.size() + literals > rawSize) return false;
+        out.append(reinterpret_cast<const char*>(in), literals);
+        in += literals;
+        if (in == end) break;      // Final, literal-only sequence
+
+        if (end - in < 2) return false;
+        size_t distance = in[0] | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        size_t length = token & 0x0F;
+        if (length == 15 && !readLength(length)) return false;
+        length += LZ_MIN_MATCH;
+        if (distance == 0 || distance > out.size() || out.size() + length > rawSize) return false;
+        // Byte by byte: a match may overlap the bytes it produces
+        size_t from = out.size() - distance;
+        for (size_t i = 0; i < length; i++) out += out[from + i];
+    }
+    return out.size() == rawSize;
+}
+
+#endif // COMPRESSION_H
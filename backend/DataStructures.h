@@ -1,6 +1,6 @@
 //
 // DataStructures.h - Custom DSA implementations for Lost & Found System
-// Contains: Trie, HashMap, Graph (with Dijkstra), MaxHeap, BST
+// Contains: Trie, Graph (with Dijkstra), MaxHeap, inverted index, clusters
 //
 
 #ifndef DATA_STRUCTURES_H
@@ -18,6 +18,10 @@
 #include <ctime>
 #include <sstream>
 #include <map>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "ImageCodec.h"
 
 // ============================================================================
 // CATEGORY ENUM - Item categories for filtering
@@ -70,98 +74,496 @@ inline std::vector<std::string> getAllCategories() {
 
 // ============================================================================
 // TRIE - For autocomplete search functionality
+// Nodes and edges live in flat arrays and refer to each other by index. A
+// node's children are one block of the edge arrays, sorted by character;
+// a full block moves to one twice the size and its old slot is reused by
+// the next node that needs that size. A node that ends a word holds a word
+// id, and all spellings share one character buffer.
+// Every node also keeps the ids of the best ranked words below it, updated
+// on insert, so autocomplete answers from the one node its prefix reaches.
 // ============================================================================
-class TrieNode {
-public:
-    std::unordered_map<char, TrieNode*> children;
-    bool isEndOfWord;
-    std::string fullWord;
-    
-    TrieNode() : isEndOfWord(false) {}
-    
-    ~TrieNode() {
-        for (auto& pair : children) {
-            delete pair.second;
-        }
-    }
+
+// One report of an item name, as the autocomplete tries count them
+struct NameReport {
+    const std::string* name;
+    long long reportedAt;
+    Category category;
 };
 
 class Trie {
 private:
-    TrieNode* root;
+    static const uint32_t NO_WORD = UINT32_MAX;
+    static const uint32_t NO_BLOCK = UINT32_MAX;
+    static const int SIZE_CLASSES = 9;      // Blocks of 1, 2, 4 ... 256 slots
+    static const uint16_t SCAN_LIMIT = 16;  // Up to this many children, a linear scan beats bisection
+    static const uint32_t TOP_K = 10;       // Ranked words kept per node
+    
+    // Each report of a name counts 2^(reportedAt / RANK_HALF_LIFE), so one
+    // reported twice a week ago ranks with one reported once today. A rank
+    // is log2 of its sum: it only grows, and comparing two ranks gives the
+    // same answer whenever it is done.
+    static constexpr double RANK_HALF_LIFE = 7 * 24 * 60 * 60;
+    static constexpr double NO_RANK = -std::numeric_limits<double>::infinity();
+    
+    struct Node {
+        uint32_t firstEdge;     // Start of the child block, or NO_BLOCK
+        uint32_t firstRank;     // Start of the ranked block, or NO_BLOCK
+        uint32_t word;          // Word id, or NO_WORD
+        uint16_t childCount;
+        uint8_t sizeClass;      // The child block holds 1 << sizeClass edges
+        uint8_t rankCount;
+        uint8_t rankClass;      // The ranked block holds 1 << rankClass ids
+    };
+    
+    struct Word {
+        uint32_t offset;        // Spelling, in spellingText
+        uint32_t length;
+        double rank;
+    };
+    
+    // Blocks carved from the end of parallel arrays; outgrown ones are kept
+    // by size for reuse
+    struct BlockPool {
+        std::vector<uint32_t> reusable[SIZE_CLASSES];
+        uint32_t end = 0;
+        
+        uint32_t allocate(int sizeClass) {
+            if (!reusable[sizeClass].empty()) {
+                uint32_t block = reusable[sizeClass].back();
+                reusable[sizeClass].pop_back();
+                return block;
+            }
+            uint32_t block = end;
+            end += 1u << sizeClass;
+            return block;
+        }
+        
+        void release(uint32_t block, int sizeClass) {
+            reusable[sizeClass].push_back(block);
+        }
+        
+        void clear() {
+            for (auto& blocks : reusable) blocks.clear();
+            end = 0;
+        }
+    };
+    
+    std::vector<Node> nodes;                // nodes[0] is the root
+    std::vector<unsigned char> edgeLabels;
+    std::vector<uint32_t> edgeTargets;      // Parallel to edgeLabels
+    BlockPool edgeBlocks;
+    std::vector<uint32_t> rankedWords;      // Word ids, best first within a block
+    BlockPool rankBlocks;
+    std::vector<Word> words;                // By word id
+    std::string spellingText;
+    
+    static unsigned char fold(char c) {
+        return static_cast<unsigned char>(::tolower(c));
+    }
+    
+    static int sizeClassFor(size_t count) {
+        int sizeClass = 0;
+        while ((static_cast<size_t>(1) << sizeClass) < count) sizeClass++;
+        return sizeClass;
+    }
+    
+    static double combineRanks(double a, double b) {
+        if (a < b) std::swap(a, b);
+        if (b == NO_RANK) return a;
+        return a + std::log2(1 + std::exp2(b - a));
+    }
+    
+    // Ties go to the word first in trie order, so they come out the same
+    // however the trie was built
+    bool outranks(uint32_t a, uint32_t b) const {
+        const Word& x = words[a];
+        const Word& y = words[b];
+        if (x.rank != y.rank) return x.rank > y.rank;
+        auto spelling = spellingText.begin();
+        return std::lexicographical_compare(spelling + x.offset, spelling + x.offset + x.length,
+                                            spelling + y.offset, spelling + y.offset + y.length,
+                                            [](char l, char r) { return fold(l) < fold(r); });
+    }
     
-    void collectWords(TrieNode* node, std::vector<std::string>& results, int limit) {
-        if (results.size() >= limit) return;
+    // Node reached from node by c, or 0 if none (the root is nobody's child)
+    uint32_t child(const Node& node, unsigned char c) const {
+        if (node.childCount == 0) return 0;
+        const unsigned char* labels = edgeLabels.data() + node.firstEdge;
+        if (node.childCount > SCAN_LIMIT) {
+            const unsigned char* found = std::lower_bound(labels, labels + node.childCount, c);
+            if (found == labels + node.childCount || *found != c) return 0;
+            return edgeTargets[node.firstEdge + (found - labels)];
+        }
+        for (uint16_t i = 0; i < node.childCount; i++) {
+            if (labels[i] >= c) return labels[i] == c ? edgeTargets[node.firstEdge + i] : 0;
+        }
+        return 0;
+    }
+    
+    // Node for prefix; found is false if no word starts with it
+    uint32_t find(const std::string& prefix, bool& found) const {
+        uint32_t current = 0;
+        for (char c : prefix) {
+            current = child(nodes[current], fold(c));
+            if (current == 0) {
+                found = false;
+                return 0;
+            }
+        }
+        found = true;
+        return current;
+    }
+    
+    // Gives parent room for at least count children
+    void reserveChildren(uint32_t parent, size_t count) {
+        Node node = nodes[parent];
+        if (node.firstEdge != NO_BLOCK && count <= (static_cast<size_t>(1) << node.sizeClass)) return;
+        int sizeClass = sizeClassFor(count);
+        uint32_t block = edgeBlocks.allocate(sizeClass);
+        if (edgeBlocks.end > edgeLabels.size()) {
+            edgeLabels.resize(edgeBlocks.end);
+            edgeTargets.resize(edgeBlocks.end);
+        }
+        if (node.firstEdge != NO_BLOCK) {
+            std::copy_n(edgeLabels.begin() + node.firstEdge, node.childCount, edgeLabels.begin() + block);
+            std::copy_n(edgeTargets.begin() + node.firstEdge, node.childCount, edgeTargets.begin() + block);
+            edgeBlocks.release(node.firstEdge, node.sizeClass);
+        }
+        nodes[parent].firstEdge = block;
+        nodes[parent].sizeClass = static_cast<uint8_t>(sizeClass);
+    }
+    
+    // Gives index room for at least count ranked words
+    void reserveRanks(uint32_t index, size_t count) {
+        Node node = nodes[index];
+        if (node.firstRank != NO_BLOCK && count <= (static_cast<size_t>(1) << node.rankClass)) return;
+        int rankClass = sizeClassFor(count);
+        uint32_t block = rankBlocks.allocate(rankClass);
+        if (rankBlocks.end > rankedWords.size()) rankedWords.resize(rankBlocks.end);
+        if (node.firstRank != NO_BLOCK) {
+            std::copy_n(rankedWords.begin() + node.firstRank, node.rankCount, rankedWords.begin() + block);
+            rankBlocks.release(node.firstRank, node.rankClass);
+        }
+        nodes[index].firstRank = block;
+        nodes[index].rankClass = static_cast<uint8_t>(rankClass);
+    }
+    
+    // New empty child of parent for c, which parent must not have yet
+    uint32_t addChild(uint32_t parent, unsigned char c) {
+        reserveChildren(parent, nodes[parent].childCount + 1u);
+        uint32_t created = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{NO_BLOCK, NO_BLOCK, NO_WORD, 0, 0, 0, 0});
         
-        if (node->isEndOfWord) {
-            results.push_back(node->fullWord);
+        Node& node = nodes[parent];
+        unsigned char* labels = edgeLabels.data() + node.firstEdge;
+        uint32_t* targets = edgeTargets.data() + node.firstEdge;
+        size_t at = std::lower_bound(labels, labels + node.childCount, c) - labels;
+        std::memmove(labels + at + 1, labels + at, node.childCount - at);
+        std::memmove(targets + at + 1, targets + at, (node.childCount - at) * sizeof(uint32_t));
+        labels[at] = c;
+        targets[at] = created;
+        node.childCount++;
+        return created;
+    }
+    
+    // Word id of index, made one if it isn't yet, spelled as word. A new
+    // spelling of a word overwrites the old one in place: folding keeps the
+    // length, so only a new word grows the buffer.
+    uint32_t setWord(uint32_t index, const std::string& word) {
+        uint32_t id = nodes[index].word;
+        if (id != NO_WORD && word.size() <= words[id].length) {
+            spellingText.replace(words[id].offset, word.size(), word);
+            words[id].length = static_cast<uint32_t>(word.size());
+            return id;
+        }
+        uint32_t offset = static_cast<uint32_t>(spellingText.size());
+        spellingText += word;
+        if (id == NO_WORD) {
+            id = static_cast<uint32_t>(words.size());
+            nodes[index].word = id;
+            words.push_back(Word{offset, static_cast<uint32_t>(word.size()), NO_RANK});
+        } else {
+            words[id].offset = offset;
+            words[id].length = static_cast<uint32_t>(word.size());
         }
+        return id;
+    }
+    
+    std::string wordAt(uint32_t id) const {
+        return spellingText.substr(words[id].offset, words[id].length);
+    }
+    
+    // Moves id up the ranked list of index after its rank grew, entering
+    // it if it now beats the last one there
+    void promote(uint32_t index, uint32_t id) {
+        uint32_t count = nodes[index].rankCount;
+        uint32_t at = 0;
+        while (at < count && rankedWords[nodes[index].firstRank + at] != id) at++;
+        if (at == count) {
+            if (count == TOP_K) {
+                if (!outranks(id, rankedWords[nodes[index].firstRank + count - 1])) return;
+                at = count - 1;
+            } else {
+                reserveRanks(index, count + 1);
+                nodes[index].rankCount++;
+            }
+        }
+        uint32_t* ranked = rankedWords.data() + nodes[index].firstRank;
+        while (at > 0 && outranks(id, ranked[at - 1])) {
+            ranked[at] = ranked[at - 1];
+            at--;
+        }
+        ranked[at] = id;
+    }
+    
+    void insertRanked(const std::string& word, double rank) {
+        std::vector<uint32_t> path;
+        path.reserve(word.size() + 1);
+        path.push_back(0);
+        uint32_t current = 0;
+        for (char c : word) {
+            unsigned char key = fold(c);
+            uint32_t next = child(nodes[current], key);
+            current = next != 0 ? next : addChild(current, key);
+            path.push_back(current);
+        }
+        uint32_t id = setWord(current, word);
+        words[id].rank = combineRanks(words[id].rank, rank);
+        for (uint32_t index : path) {
+            promote(index, id);
+        }
+    }
+    
+    // Words below start in character order, after the ranked ones already
+    // in results, until there are limit
+    void collectUnranked(uint32_t start, std::vector<std::string>& results, size_t limit) const {
+        const Node& top = nodes[start];
+        const uint32_t* ranked = rankedWords.data() + top.firstRank;
+        std::vector<uint32_t> pending;
+        pending.reserve(64);
+        pending.push_back(start);
+        while (!pending.empty() && results.size() < limit) {
+            const Node& node = nodes[pending.back()];
+            pending.pop_back();
+            if (node.word != NO_WORD && std::find(ranked, ranked + top.rankCount, node.word) == ranked + top.rankCount) {
+                results.push_back(wordAt(node.word));
+            }
+            for (uint16_t i = node.childCount; i > 0; i--) {
+                pending.push_back(edgeTargets[node.firstEdge + i - 1]);
+            }
+        }
+    }
+    
+    // Deeper images are refused rather than risk the stack; a name that long
+    // just means the trie is rebuilt from the items instead
+    static const int MAX_IMAGE_DEPTH = 4096;
+    
+    void saveNode(uint32_t index, ImageWriter& out) const {
+        const Node& node = nodes[index];
+        out.u8(node.word != NO_WORD ? 1 : 0);
+        if (node.word != NO_WORD) {
+            out.str(wordAt(node.word));
+            uint64_t rankBits;
+            std::memcpy(&rankBits, &words[node.word].rank, sizeof(rankBits));
+            out.u64(rankBits);
+        }
+        out.u32(node.childCount);
+        for (uint16_t i = 0; i < node.childCount; i++) {
+            out.u8(edgeLabels[node.firstEdge + i]);
+            saveNode(edgeTargets[node.firstEdge + i], out);
+        }
+    }
+    
+    // Ranked lists aren't saved: each is rebuilt from the node's own word and
+    // its children's lists once they are loaded
+    bool loadNode(uint32_t index, ImageReader& in, int depth) {
+        if (in.u8() != 0) {
+            uint32_t id = setWord(index, in.str());
+            uint64_t rankBits = in.u64();
+            std::memcpy(&words[id].rank, &rankBits, sizeof(rankBits));
+            if (std::isnan(words[id].rank)) return false;
+        }
+        uint32_t count = in.u32();
+        if (!in.has(count, 5) || count > 256 || (count > 0 && depth >= MAX_IMAGE_DEPTH)) return false;
+        if (count > 0) reserveChildren(index, count);
+        for (uint32_t i = 0; i < count; i++) {
+            unsigned char c = in.u8();
+            if (child(nodes[index], c) != 0) return false;
+            if (!loadNode(addChild(index, c), in, depth + 1)) return false;
+        }
+        if (!in.ok()) return false;
         
-        for (auto& pair : node->children) {
-            collectWords(pair.second, results, limit);
+        std::vector<uint32_t> candidates;
+        if (nodes[index].word != NO_WORD) candidates.push_back(nodes[index].word);
+        for (uint16_t i = 0; i < nodes[index].childCount; i++) {
+            const Node& below = nodes[edgeTargets[nodes[index].firstEdge + i]];
+            candidates.insert(candidates.end(), rankedWords.begin() + below.firstRank,
+                              rankedWords.begin() + below.firstRank + below.rankCount);
         }
+        if (candidates.empty()) return true;
+        size_t kept = std::min<size_t>(candidates.size(), TOP_K);
+        std::partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end(),
+                          [this](uint32_t a, uint32_t b) { return outranks(a, b); });
+        reserveRanks(index, kept);
+        std::copy_n(candidates.begin(), kept, rankedWords.begin() + nodes[index].firstRank);
+        nodes[index].rankCount = static_cast<uint8_t>(kept);
+        return true;
     }
     
 public:
     Trie() {
-        root = new TrieNode();
+        clear();
     }
     
-    ~Trie() {
-        delete root;
+    void insert(const std::string& word, long long reportedAt) {
+        insertRanked(word, reportedAt / RANK_HALF_LIFE);
     }
     
-    void insert(const std::string& word) {
-        TrieNode* current = root;
-        std::string lowerWord = word;
-        std::transform(lowerWord.begin(), lowerWord.end(), lowerWord.begin(), ::tolower);
-        
-        for (char c : lowerWord) {
-            if (current->children.find(c) == current->children.end()) {
-                current->children[c] = new TrieNode();
-            }
-            current = current->children[c];
+    void insertAll(const std::vector<NameReport>& reports) {
+        for (const NameReport& report : reports) {
+            insert(*report.name, report.reportedAt);
         }
-        current->isEndOfWord = true;
-        current->fullWord = word;
     }
     
-    bool search(const std::string& word) {
-        TrieNode* current = root;
-        std::string lowerWord = word;
-        std::transform(lowerWord.begin(), lowerWord.end(), lowerWord.begin(), ::tolower);
+    bool search(const std::string& word) const {
+        bool found;
+        uint32_t index = find(word, found);
+        return found && nodes[index].word != NO_WORD;
+    }
+    
+    // Up to limit words under prefix, most often and most recently reported
+    // first. Beyond the TOP_K kept ranked, the rest follow in character order.
+    std::vector<std::string> autocomplete(const std::string& prefix, int limit = 10) const {
+        std::vector<std::string> results;
+        bool found;
+        uint32_t start = find(prefix, found);
+        if (!found || limit <= 0) return results;
         
-        for (char c : lowerWord) {
-            if (current->children.find(c) == current->children.end()) {
-                return false;
-            }
-            current = current->children[c];
+        const Node& node = nodes[start];
+        size_t wanted = static_cast<size_t>(limit);
+        for (uint32_t i = 0; i < node.rankCount && results.size() < wanted; i++) {
+            results.push_back(wordAt(rankedWords[node.firstRank + i]));
+        }
+        // A list short of TOP_K already holds every word below
+        if (results.size() < wanted && node.rankCount == TOP_K) {
+            collectUnranked(start, results, wanted);
         }
-        return current->isEndOfWord;
+        return results;
     }
     
-    std::vector<std::string> autocomplete(const std::string& prefix, int limit = 10) {
+    // Typos tolerated in a query of this length: none under 3 characters,
+    // where one edit already matches nearly everything, one under 6
+    static int editsAllowed(size_t length) {
+        return length >= 6 ? 2 : length >= 3 ? 1 : 0;
+    }
+    
+    // Up to limit words under any prefix within maxEdits edits of prefix
+    // (a character inserted, dropped, changed, or swapped with its
+    // neighbour), fewest edits first and then by rank; short prefixes are
+    // held to editsAllowed(). The walk carries one row of the edit distance
+    // table per trie level, which is the state of a Levenshtein automaton
+    // for prefix, and leaves a branch once every entry of its row is over.
+    std::vector<std::string> fuzzyAutocomplete(const std::string& prefix, int maxEdits, int limit = 10) const {
+        std::string query;
+        for (char c : prefix) query += static_cast<char>(fold(c));
+        maxEdits = std::min(std::max(maxEdits, 0), editsAllowed(query.size()));
+        if (maxEdits == 0) return autocomplete(prefix, limit);
         std::vector<std::string> results;
-        TrieNode* current = root;
-        std::string lowerPrefix = prefix;
-        std::transform(lowerPrefix.begin(), lowerPrefix.end(), lowerPrefix.begin(), ::tolower);
-        
-        // Navigate to the end of prefix
-        for (char c : lowerPrefix) {
-            if (current->children.find(c) == current->children.end()) {
-                return results; // Prefix not found
+        if (limit <= 0) return results;
+        
+        struct Step {
+            uint32_t node;
+            uint32_t depth;
+            char label;
+        };
+        size_t width = query.size() + 1;
+        std::vector<int> rows(width);           // One per depth along the current path
+        for (size_t j = 0; j < width; j++) rows[j] = static_cast<int>(j);
+        std::string path;                       // Characters along the current path
+        std::vector<Step> pending;
+        std::vector<std::pair<int, uint32_t>> matches;  // Edits and word id
+        auto pushChildren = [&](uint32_t index, uint32_t depth) {
+            const Node& node = nodes[index];
+            for (uint16_t i = node.childCount; i > 0; i--) {
+                uint32_t edge = node.firstEdge + i - 1;
+                pending.push_back(Step{edgeTargets[edge], depth + 1, static_cast<char>(edgeLabels[edge])});
+            }
+        };
+        pushChildren(0, 0);
+        
+        while (!pending.empty()) {
+            Step step = pending.back();
+            pending.pop_back();
+            // Depth first, so the rows and path above step are its ancestors';
+            // whatever a finished sibling left at its depth is overwritten
+            if (rows.size() < (step.depth + 1) * width) rows.resize((step.depth + 1) * width);
+            path.resize(step.depth);
+            path[step.depth - 1] = step.label;
+            int* row = rows.data() + step.depth * width;
+            const int* above = row - width;
+            
+            row[0] = static_cast<int>(step.depth);
+            int fewest = row[0];
+            for (size_t j = 1; j < width; j++) {
+                int edits = std::min({above[j] + 1, row[j - 1] + 1, above[j - 1] + (query[j - 1] != step.label)});
+                if (step.depth > 1 && j > 1 && query[j - 1] == path[step.depth - 2] && query[j - 2] == step.label) {
+                    edits = std::min(edits, (above - width)[j - 2] + 1);
+                }
+                row[j] = edits;
+                fewest = std::min(fewest, edits);
+            }
+            if (fewest > maxEdits) continue;
+            
+            // Deeper nodes can match with fewer edits, so keep going either way
+            const Node& node = nodes[step.node];
+            if (row[width - 1] <= maxEdits) {
+                for (uint32_t i = 0; i < node.rankCount; i++) {
+                    matches.emplace_back(row[width - 1], rankedWords[node.firstRank + i]);
+                }
             }
-            current = current->children[c];
+            pushChildren(step.node, step.depth);
         }
         
-        // Collect all words from this point
-        collectWords(current, results, limit);
+        // A word reached from several matching prefixes counts its best
+        std::sort(matches.begin(), matches.end(), [](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) {
+            return a.second != b.second ? a.second < b.second : a.first < b.first;
+        });
+        matches.erase(std::unique(matches.begin(), matches.end(),
+            [](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) { return a.second == b.second; }),
+            matches.end());
+        std::sort(matches.begin(), matches.end(), [this](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) {
+            return a.first != b.first ? a.first < b.first : outranks(a.second, b.second);
+        });
+        for (size_t i = 0; i < matches.size() && results.size() < static_cast<size_t>(limit); i++) {
+            results.push_back(wordAt(matches[i].second));
+        }
         return results;
     }
     
     void clear() {
-        delete root;
-        root = new TrieNode();
+        nodes.assign(1, Node{NO_BLOCK, NO_BLOCK, NO_WORD, 0, 0, 0, 0});
+        edgeLabels.clear();
+        edgeTargets.clear();
+        edgeBlocks.clear();
+        rankedWords.clear();
+        rankBlocks.clear();
+        words.clear();
+        spellingText.clear();
+    }
+    
+    // Preorder image: per node its end flag, the spelling and rank (f64
+    // bits) if it ends a word, the child count, then each child as its
+    // character and subtree
+    void save(ImageWriter& out) const {
+        saveNode(0, out);
+    }
+    
+    // Replace the contents with a saved image; empty and false if damaged
+    bool load(ImageReader& in) {
+        clear();
+        if (loadNode(0, in, 0)) return true;
+        clear();
+        return false;
     }
 };
 
@@ -207,61 +609,6 @@ struct Item {
     }
 };
 
-// ============================================================================
-// HASHMAP - O(1) item lookup by ID
-// ============================================================================
-class ItemHashMap {
-private:
-    std::unordered_map<std::string, Item> items;
-    
-public:
-    void insert(const std::string& id, const Item& item) {
-        items[id] = item;
-    }
-    
-    Item* get(const std::string& id) {
-        auto it = items.find(id);
-        if (it != items.end()) {
-            return &(it->second);
-        }
-        return nullptr;
-    }
-    
-    bool remove(const std::string& id) {
-        return items.erase(id) > 0;
-    }
-    
-    bool exists(const std::string& id) {
-        return items.find(id) != items.end();
-    }
-    
-    std::vector<Item> getAllItems() {
-        std::vector<Item> result;
-        for (auto& pair : items) {
-            result.push_back(pair.second);
-        }
-        return result;
-    }
-    
-    std::vector<Item> getItemsByType(const std::string& type) {
-        std::vector<Item> result;
-        for (auto& pair : items) {
-            if (pair.second.type == type) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
-    }
-    
-    size_t size() {
-        return items.size();
-    }
-    
-    void clear() {
-        items.clear();
-    }
-};
-
 // ============================================================================
 // GRAPH - Location proximity with Dijkstra's algorithm
 // ============================================================================
@@ -322,7 +669,7 @@ public:
                 continue;
             }
             
-            for (auto& [neighbor, weight] : adjacencyList[current]) {
+            for (auto& [neighbor, weight] : adjacencyList.at(current)) {
                 int newDist = dist + weight;
                 if (newDist < distances[neighbor]) {
                     distances[neighbor] = newDist;
@@ -334,6 +681,28 @@ public:
         return distances[end];
     }
     
+    // Hash of every location and edge, independent of map order; anything
+    // derived from the graph and saved is only reused while this matches
+    uint64_t fingerprint() const {
+        std::vector<std::string> entries;
+        for (const auto& pair : adjacencyList) {
+            entries.push_back(pair.first);
+            for (const auto& edge : pair.second) {
+                entries.push_back(pair.first + '\0' + edge.first + '\0' + std::to_string(edge.second));
+            }
+        }
+        std::sort(entries.begin(), entries.end());
+        
+        uint64_t hash = 1469598103934665603ULL;     // FNV-1a
+        for (const auto& entry : entries) {
+            for (char c : entry) {
+                hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+            }
+            hash = (hash ^ 0xFF) * 1099511628211ULL;
+        }
+        return hash;
+    }
+    
     bool isNear(const std::string& loc1, const std::string& loc2, int threshold = 100) {
         int dist = getDistance(loc1, loc2);
         return dist <= threshold;
@@ -530,96 +899,67 @@ public:
 };
 
 // ============================================================================
-// BST - For sorted history by timestamp
+// INVERTED INDEX - For multi-field search (name + color + location)
 // ============================================================================
-class BSTNode {
-public:
-    Item item;
-    BSTNode* left;
-    BSTNode* right;
-    
-    BSTNode(const Item& item) : item(item), left(nullptr), right(nullptr) {}
-};
-
-class ItemBST {
+class InvertedIndex {
 private:
-    BSTNode* root;
-    
-    BSTNode* insert(BSTNode* node, const Item& item) {
-        if (node == nullptr) {
-            return new BSTNode(item);
+    typedef std::unordered_map<std::string, std::set<std::string>> PostingMap;
+    typedef std::vector<std::pair<std::string, const std::string*>> TermIds;
+    
+    PostingMap nameIndex;
+    PostingMap colorIndex;
+    PostingMap locationIndex;
+    PostingMap categoryIndex;
+    
+    // Group ids by term, then sort and dedupe each group so the set is
+    // filled in order, every insert landing at the end
+    static void buildPostings(PostingMap& index, TermIds& pairs) {
+        std::unordered_map<std::string, std::vector<const std::string*>> groups;
+        for (auto& pair : pairs) {
+            groups[std::move(pair.first)].push_back(pair.second);
         }
-        
-        if (item.timestamp < node->item.timestamp) {
-            node->left = insert(node->left, item);
-        } else {
-            node->right = insert(node->right, item);
+        pairs.clear();
+        for (auto& group : groups) {
+            std::vector<const std::string*>& ids = group.second;
+            std::sort(ids.begin(), ids.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
+            ids.erase(std::unique(ids.begin(), ids.end(), [](const std::string* a, const std::string* b) { return *a == *b; }),
+                      ids.end());
+            std::set<std::string>& postings = index[group.first];
+            for (const std::string* id : ids) {
+                postings.emplace_hint(postings.end(), *id);
+            }
         }
-        
-        return node;
-    }
-    
-    void inorderTraversal(BSTNode* node, std::vector<Item>& result) {
-        if (node == nullptr) return;
-        
-        inorderTraversal(node->left, result);
-        result.push_back(node->item);
-        inorderTraversal(node->right, result);
-    }
-    
-    void reverseInorderTraversal(BSTNode* node, std::vector<Item>& result) {
-        if (node == nullptr) return;
-        
-        reverseInorderTraversal(node->right, result);
-        result.push_back(node->item);
-        reverseInorderTraversal(node->left, result);
-    }
-    
-    void destroyTree(BSTNode* node) {
-        if (node == nullptr) return;
-        destroyTree(node->left);
-        destroyTree(node->right);
-        delete node;
-    }
-    
-public:
-    ItemBST() : root(nullptr) {}
-    
-    ~ItemBST() {
-        destroyTree(root);
     }
     
-    void insert(const Item& item) {
-        root = insert(root, item);
-    }
-    
-    std::vector<Item> getSortedHistory(bool ascending = true) {
-        std::vector<Item> result;
-        if (ascending) {
-            inorderTraversal(root, result);
-        } else {
-            reverseInorderTraversal(root, result);
+    static void savePostings(const PostingMap& index, ImageWriter& out) {
+        out.u64(index.size());
+        for (const auto& entry : index) {
+            out.str(entry.first);
+            out.u32(static_cast<uint32_t>(entry.second.size()));
+            for (const auto& id : entry.second) {
+                out.str(id);
+            }
         }
-        return result;
     }
     
-    void clear() {
-        destroyTree(root);
-        root = nullptr;
+    // Ids were saved in set order, so each insert lands at the end
+    static bool loadPostings(PostingMap& index, ImageReader& in) {
+        uint64_t terms = in.u64();
+        if (!in.has(terms, 8)) return false;
+        index.reserve(static_cast<size_t>(terms));
+        for (uint64_t i = 0; i < terms; i++) {
+            std::string term = in.str();
+            uint32_t count = in.u32();
+            if (!in.has(count, 4)) return false;
+            std::set<std::string>& postings = index[std::move(term)];
+            for (uint32_t j = 0; j < count; j++) {
+                postings.emplace_hint(postings.end(), in.str());
+            }
+        }
+        return in.ok();
     }
-};
-
-// ============================================================================
-// INVERTED INDEX - For multi-field search (name + color + location)
-// ============================================================================
-class InvertedIndex {
-private:
-    std::unordered_map<std::string, std::set<std::string>> nameIndex;
-    std::unordered_map<std::string, std::set<std::string>> colorIndex;
-    std::unordered_map<std::string, std::set<std::string>> locationIndex;
-    std::unordered_map<std::string, std::set<std::string>> categoryIndex;
     
-    std::vector<std::string> tokenize(const std::string& text) {
+    static std::vector<std::string> tokenize(const std::string& text) {
         std::vector<std::string> tokens;
         std::string lower = text;
         std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
@@ -653,6 +993,30 @@ public:
         categoryIndex[categoryToString(item.category)].insert(item.id);
     }
     
+    // indexItem() for many items at once, built with one sort per field
+    void indexItems(const std::vector<const Item*>& items) {
+        TermIds names, colors, locations, categories;
+        colors.reserve(items.size());
+        locations.reserve(items.size());
+        categories.reserve(items.size());
+        for (const Item* item : items) {
+            for (auto& token : tokenize(item->name)) {
+                names.emplace_back(std::move(token), &item->id);
+            }
+            std::string lowerColor = item->color;
+            std::transform(lowerColor.begin(), lowerColor.end(), lowerColor.begin(), ::tolower);
+            colors.emplace_back(std::move(lowerColor), &item->id);
+            std::string lowerLoc = item->location;
+            std::transform(lowerLoc.begin(), lowerLoc.end(), lowerLoc.begin(), ::tolower);
+            locations.emplace_back(std::move(lowerLoc), &item->id);
+            categories.emplace_back(categoryToString(item->category), &item->id);
+        }
+        buildPostings(nameIndex, names);
+        buildPostings(colorIndex, colors);
+        buildPostings(locationIndex, locations);
+        buildPostings(categoryIndex, categories);
+    }
+    
     void removeItem(const Item& item) {
         for (const auto& token : tokenize(item.name)) {
             nameIndex[token].erase(item.id);
@@ -693,8 +1057,9 @@ public:
         if (!name.empty()) {
             std::set<std::string> nameMatches;
             for (const auto& token : tokenize(name)) {
-                if (nameIndex.find(token) != nameIndex.end()) {
-                    for (const auto& id : nameIndex[token]) {
+                auto postings = nameIndex.find(token);
+                if (postings != nameIndex.end()) {
+                    for (const auto& id : postings->second) {
                         nameMatches.insert(id);
                     }
                 }
@@ -706,8 +1071,9 @@ public:
         if (!color.empty()) {
             std::string lowerColor = color;
             std::transform(lowerColor.begin(), lowerColor.end(), lowerColor.begin(), ::tolower);
-            if (colorIndex.find(lowerColor) != colorIndex.end()) {
-                intersectOrInit(colorIndex[lowerColor]);
+            auto postings = colorIndex.find(lowerColor);
+            if (postings != colorIndex.end()) {
+                intersectOrInit(postings->second);
             } else if (!firstFilter) {
                 result.clear();
             }
@@ -717,8 +1083,9 @@ public:
         if (!location.empty()) {
             std::string lowerLoc = location;
             std::transform(lowerLoc.begin(), lowerLoc.end(), lowerLoc.begin(), ::tolower);
-            if (locationIndex.find(lowerLoc) != locationIndex.end()) {
-                intersectOrInit(locationIndex[lowerLoc]);
+            auto postings = locationIndex.find(lowerLoc);
+            if (postings != locationIndex.end()) {
+                intersectOrInit(postings->second);
             } else if (!firstFilter) {
                 result.clear();
             }
@@ -728,8 +1095,9 @@ public:
         if (!category.empty()) {
             std::string lowerCat = category;
             std::transform(lowerCat.begin(), lowerCat.end(), lowerCat.begin(), ::tolower);
-            if (categoryIndex.find(lowerCat) != categoryIndex.end()) {
-                intersectOrInit(categoryIndex[lowerCat]);
+            auto postings = categoryIndex.find(lowerCat);
+            if (postings != categoryIndex.end()) {
+                intersectOrInit(postings->second);
             } else if (!firstFilter) {
                 result.clear();
             }
@@ -738,12 +1106,52 @@ public:
         return result;
     }
     
+    // Whether search() would find item, for items that aren't indexed
+    static bool matches(const Item& item, const std::string& name, const std::string& color,
+                        const std::string& location, const std::string& category) {
+        auto lower = [](std::string text) {
+            std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+            return text;
+        };
+        if (!name.empty()) {
+            std::vector<std::string> itemTokens = tokenize(item.name);
+            bool any = false;
+            for (const auto& token : tokenize(name)) {
+                any = any || std::find(itemTokens.begin(), itemTokens.end(), token) != itemTokens.end();
+            }
+            if (!any) return false;
+        }
+        if (!color.empty() && lower(color) != lower(item.color)) return false;
+        if (!location.empty() && lower(location) != lower(item.location)) return false;
+        if (!category.empty() && lower(category) != categoryToString(item.category)) return false;
+        return true;
+    }
+    
     void clear() {
         nameIndex.clear();
         colorIndex.clear();
         locationIndex.clear();
         categoryIndex.clear();
     }
+    
+    // Each field's postings as term, id count, ids
+    void save(ImageWriter& out) const {
+        savePostings(nameIndex, out);
+        savePostings(colorIndex, out);
+        savePostings(locationIndex, out);
+        savePostings(categoryIndex, out);
+    }
+    
+    // Replace the contents with a saved image; empty and false if damaged
+    bool load(ImageReader& in) {
+        clear();
+        if (loadPostings(nameIndex, in) && loadPostings(colorIndex, in) &&
+            loadPostings(locationIndex, in) && loadPostings(categoryIndex, in)) {
+            return true;
+        }
+        clear();
+        return false;
+    }
 };
 
 // ============================================================================
@@ -827,6 +1235,43 @@ public:
     bool inSameCluster(const std::string& loc1, const std::string& loc2) {
         return find(loc1) == find(loc2);
     }
+    
+    // The union-find forest as it stands: radius, then location, parent, rank
+    void save(ImageWriter& out) const {
+        out.u32(static_cast<uint32_t>(clusterRadius));
+        out.u64(parent.size());
+        for (const auto& entry : parent) {
+            auto entryRank = rank.find(entry.first);
+            out.str(entry.first);
+            out.str(entry.second);
+            out.u32(static_cast<uint32_t>(entryRank != rank.end() ? entryRank->second : 0));
+        }
+    }
+    
+    // Replace the clusters with a saved forest built with the same radius;
+    // empty and false if it was not, or the image is damaged
+    bool load(ImageReader& in) {
+        parent.clear();
+        rank.clear();
+        bool ok = static_cast<int>(in.u32()) == clusterRadius;
+        uint64_t count = in.u64();
+        ok = ok && in.has(count, 12);
+        for (uint64_t i = 0; ok && i < count; i++) {
+            std::string location = in.str();
+            std::string root = in.str();
+            rank[location] = static_cast<int>(in.u32());
+            parent[std::move(location)] = std::move(root);
+            ok = in.ok();
+        }
+        for (const auto& entry : parent) {
+            ok = ok && parent.count(entry.second) > 0;
+        }
+        if (!ok) {
+            parent.clear();
+            rank.clear();
+        }
+        return ok;
+    }
 };
 
 // ============================================================================
@@ -853,10 +1298,25 @@ public:
         }
     }
     
-    void insert(const std::string& word, Category category) {
-        globalTrie->insert(word);
+    void insert(const std::string& word, Category category, long long reportedAt) {
+        globalTrie->insert(word, reportedAt);
         if (categoryTries.find(category) != categoryTries.end()) {
-            categoryTries[category]->insert(word);
+            categoryTries[category]->insert(word, reportedAt);
+        }
+    }
+    
+    // Bulk form of insert() for many reports at once
+    void insertAll(const std::vector<NameReport>& reports) {
+        std::unordered_map<Category, std::vector<NameReport>> byCategory;
+        for (const NameReport& report : reports) {
+            byCategory[report.category].push_back(report);
+        }
+        globalTrie->insertAll(reports);
+        for (auto& group : byCategory) {
+            auto trie = categoryTries.find(group.first);
+            if (trie != categoryTries.end()) {
+                trie->second->insertAll(group.second);
+            }
         }
     }
     
@@ -867,8 +1327,18 @@ public:
     std::vector<std::string> autocompleteByCategory(const std::string& prefix, 
                                                       Category category, 
                                                       int limit = 10) {
-        if (categoryTries.find(category) != categoryTries.end()) {
-            return categoryTries[category]->autocomplete(prefix, limit);
+        auto trie = categoryTries.find(category);
+        if (trie != categoryTries.end()) {
+            return trie->second->autocomplete(prefix, limit);
+        }
+        return {};
+    }
+    
+    std::vector<std::string> fuzzyAutocompleteByCategory(const std::string& prefix, Category category,
+                                                         int maxEdits, int limit = 10) {
+        auto trie = categoryTries.find(category);
+        if (trie != categoryTries.end()) {
+            return trie->second->fuzzyAutocomplete(prefix, maxEdits, limit);
         }
         return {};
     }
@@ -879,6 +1349,23 @@ public:
             pair.second->clear();
         }
     }
+    
+    // The global trie, then one per category in enum order
+    void save(ImageWriter& out) const {
+        globalTrie->save(out);
+        for (int i = 0; i <= static_cast<int>(Category::OTHER); i++) {
+            categoryTries.at(static_cast<Category>(i))->save(out);
+        }
+    }
+    
+    bool load(ImageReader& in) {
+        bool ok = globalTrie->load(in);
+        for (int i = 0; ok && i <= static_cast<int>(Category::OTHER); i++) {
+            ok = categoryTries[static_cast<Category>(i)]->load(in);
+        }
+        if (!ok) clear();
+        return ok;
+    }
 };
 
 #endif // DATA_STRUCTURES_H
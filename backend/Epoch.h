@@ -0,0 +1,168 @@
+//
+// Epoch.h - Epoch-based reclamation for versioned, read-mostly data
+// Writers publish a new immutable version with an atomic pointer swap and
+// retire the old one; readers pin the current epoch while they use whatever
+// version they loaded. A retired version is freed once no reader pinned
+// before its retirement is still running. Readers never wait for writers,
+// and writers never wait for readers.
+//
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+// Threads that may pin at the same time, across the whole process
+static const size_t EPOCH_MAX_THREADS = 256;
+
+// Small per-thread index shared by every EpochDomain. Claimed on a thread's
+// first pin and released when it exits.
+inline size_t epochThreadIndex() {
+    static std::atomic<bool> claimed[EPOCH_MAX_THREADS];
+
+    struct Registration {
+        size_t index;
+
+        Registration() : index(0) {
+            while (true) {
+                for (size_t i = 0; i < EPOCH_MAX_THREADS; i++) {
+                    bool expected = false;
+                    if (!claimed[i].load(std::memory_order_relaxed) &&
+                        claimed[i].compare_exchange_strong(expected, true)) {
+                        index = i;
+                        return;
+                    }
+                }
+                std::this_thread::yield();  // Every index taken; wait for a thread to exit
+            }
+        }
+
+        ~Registration() {
+            claimed[index].store(false);
+        }
+    };
+
+    thread_local Registration registration;
+    return registration.index;
+}
+
+struct EpochStats {
+    uint64_t epoch;
+    size_t pendingRetired;      // Retired but still visible to a pinned reader
+    uint64_t reclaimed;
+};
+
+// ============================================================================
+// EPOCH DOMAIN - One per family of versioned structures
+// Version pointers must be loaded with the default (sequentially consistent)
+// ordering while pinned, and published the same way before retire().
+// ============================================================================
+class EpochDomain {
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch;    // 0 when the thread is not pinned
+        unsigned depth;                 // Nested guards; owning thread only
+
+        Slot() : epoch(0), depth(0) {}
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> release;
+    };
+
+    Slot slots[EPOCH_MAX_THREADS];
+    std::atomic<uint64_t> globalEpoch;
+    std::mutex retiredMutex;
+    std::vector<Retired> retired;
+    uint64_t reclaimed;
+
+    // Oldest epoch any reader is pinned at, or UINT64_MAX
+    uint64_t oldestPinned() const {
+        uint64_t oldest = UINT64_MAX;
+        for (const Slot& slot : slots) {
+            uint64_t epoch = slot.epoch.load();
+            if (epoch != 0) oldest = std::min(oldest, epoch);
+        }
+        return oldest;
+    }
+
+public:
+    // ------------------------------------------------------------------------
+    // Guard - Keeps versions loaded during its lifetime alive
+    // ------------------------------------------------------------------------
+    class Guard {
+    private:
+        Slot* slot;
+
+    public:
+        explicit Guard(EpochDomain& domain) : slot(&domain.slots[epochThreadIndex()]) {
+            if (slot->depth++ == 0) {
+                slot->epoch.store(domain.globalEpoch.load());
+            }
+        }
+
+        ~Guard() {
+            if (slot && --slot->depth == 0) {
+                slot->epoch.store(0);
+            }
+        }
+
+        Guard(Guard&& other) : slot(other.slot) { other.slot = nullptr; }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+    };
+
+    EpochDomain() : globalEpoch(1), reclaimed(0) {}
+
+    // Everything still retired is released; no reader may be pinned
+    ~EpochDomain() {
+        for (Retired& entry : retired) {
+            entry.release();
+        }
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    Guard pin() { return Guard(*this); }
+
+    // Call after the old version has been unpublished. release runs once no
+    // reader can still hold it, on whichever writer thread notices first.
+    void retire(std::function<void()> release) {
+        std::vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex);
+            retired.push_back({globalEpoch.fetch_add(1), std::move(release)});
+
+            // Readers pinned after an entry's epoch loaded the new version
+            uint64_t oldest = oldestPinned();
+            auto keep = std::partition(retired.begin(), retired.end(),
+                [oldest](const Retired& entry) { return entry.epoch >= oldest; });
+            ready.assign(std::make_move_iterator(keep), std::make_move_iterator(retired.end()));
+            retired.erase(keep, retired.end());
+            reclaimed += ready.size();
+        }
+        for (Retired& entry : ready) {
+            entry.release();
+        }
+    }
+
+    EpochStats getStats() {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        EpochStats stats;
+        stats.epoch = globalEpoch.load();
+        stats.pendingRetired = retired.size();
+        stats.reclaimed = reclaimed;
+        return stats;
+    }
+};
+
+#endif // EPOCH_H
@@ -0,0 +1,288 @@
+//
+// HttpParser.h - Incremental HTTP/1.x request parsing
+// Contains: HttpRequest, RecvBuffer, HttpRequestParser (state machine)
+//
+
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+// ============================================================================
+// HTTP REQUEST - Parsed request line, headers and body
+// ============================================================================
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::string query;
+    std::string version;
+    std::string body;
+    std::unordered_map<std::string, std::string> headers;
+
+    // Header names are case-insensitive
+    std::string getHeader(const std::string& name) const {
+        for (const auto& pair : headers) {
+            if (pair.first.size() == name.size() &&
+                std::equal(pair.first.begin(), pair.first.end(), name.begin(),
+                           [](char a, char b) { return ::tolower(a) == ::tolower(b); })) {
+                return pair.second;
+            }
+        }
+        return "";
+    }
+
+    // HTTP/1.1 is persistent unless the client asks to close; HTTP/1.0 only on request
+    bool wantsKeepAlive() const {
+        std::string connection = getHeader("Connection");
+        std::transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
+        if (version == "HTTP/1.1") {
+            return connection.find("close") == std::string::npos;
+        }
+        return connection.find("keep-alive") != std::string::npos;
+    }
+
+    void clear() {
+        method.clear();
+        path.clear();
+        query.clear();
+        version.clear();
+        body.clear();
+        headers.clear();
+    }
+};
+
+// ============================================================================
+// RECV BUFFER - Reusable per-connection receive buffer
+// Bytes are received straight into free space at the tail and consumed from
+// the head; consumed space is reclaimed by sliding the remainder down.
+// ============================================================================
+class RecvBuffer {
+private:
+    std::vector<char> data;
+    size_t head;
+    size_t tail;
+
+public:
+    RecvBuffer(size_t initialCapacity = 16384) : data(initialCapacity), head(0), tail(0) {}
+
+    // Free space of at least minSpace bytes to receive into
+    char* writePtr(size_t minSpace) {
+        if (head == tail) {
+            head = tail = 0;
+        }
+        if (data.size() - tail < minSpace && head > 0) {
+            std::memmove(data.data(), data.data() + head, tail - head);
+            tail -= head;
+            head = 0;
+        }
+        if (data.size() - tail < minSpace) {
+            data.resize(std::max(data.size() * 2, tail + minSpace));
+        }
+        return data.data() + tail;
+    }
+
+    size_t writable() const { return data.size() - tail; }
+    void commit(size_t n) { tail += n; }
+
+    const char* readPtr() const { return data.data() + head; }
+    size_t readable() const { return tail - head; }
+    void consume(size_t n) { head += std::min(n, tail - head); }
+};
+
+// ============================================================================
+// HTTP REQUEST PARSER - Resumable state machine
+// feed() can be called with any split of the byte stream; it consumes what it
+// can and stops at the end of a request so pipelined requests stay buffered.
+// ============================================================================
+struct HttpParserLimits {
+    size_t maxHeaderBytes;   // Request line + headers
+    size_t maxBodyBytes;     // Content-Length ceiling
+
+    HttpParserLimits() : maxHeaderBytes(16 * 1024), maxBodyBytes(1024 * 1024) {}
+};
+
+class HttpRequestParser {
+public:
+    enum class State {
+        REQUEST_LINE,
+        HEADERS,
+        BODY,
+        COMPLETE,
+        ERROR
+    };
+
+private:
+    HttpParserLimits limits;
+    State state;
+    HttpRequest req;
+    size_t headerBytes;
+    size_t contentLength;
+    int errorStatus;
+    std::string errorText;
+
+    State fail(int status, const std::string& text) {
+        errorStatus = status;
+        errorText = text;
+        state = State::ERROR;
+        return state;
+    }
+
+    static void trim(const char*& begin, const char*& end) {
+        while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    }
+
+    // METHOD /path?query HTTP/1.1
+    void parseRequestLine(const char* begin, const char* end) {
+        trim(begin, end);
+        const char* methodEnd = std::find(begin, end, ' ');
+        const char* targetBegin = methodEnd;
+        while (targetBegin < end && *targetBegin == ' ') targetBegin++;
+        const char* targetEnd = std::find(targetBegin, end, ' ');
+        const char* versionBegin = targetEnd;
+        while (versionBegin < end && *versionBegin == ' ') versionBegin++;
+
+        if (methodEnd == begin || targetBegin == targetEnd ||
+            versionBegin == end || std::strncmp(versionBegin, "HTTP/", 5) != 0) {
+            fail(400, "Bad Request");
+            return;
+        }
+
+        req.method.assign(begin, methodEnd);
+        const char* queryPos = std::find(targetBegin, targetEnd, '?');
+        req.path.assign(targetBegin, queryPos);
+        if (queryPos != targetEnd) {
+            req.query.assign(queryPos + 1, targetEnd);
+        }
+        req.version.assign(versionBegin, end);
+        state = State::HEADERS;
+    }
+
+    // Blank line ends the header block
+    void parseHeaderLine(const char* begin, const char* end) {
+        const char* valueEnd = end;
+        if (valueEnd > begin && valueEnd[-1] == '\r') valueEnd--;
+        if (valueEnd == begin) {
+            finishHeaders();
+            return;
+        }
+
+        const char* colon = std::find(begin, valueEnd, ':');
+        if (colon == valueEnd || colon == begin) {
+            fail(400, "Bad Request");
+            return;
+        }
+        const char* valueBegin = colon + 1;
+        trim(valueBegin, valueEnd);
+        req.headers[std::string(begin, colon)] = std::string(valueBegin, valueEnd);
+    }
+
+    void finishHeaders() {
+        if (!req.getHeader("Transfer-Encoding").empty()) {
+            fail(501, "Not Implemented");
+            return;
+        }
+
+        std::string lengthStr = req.getHeader("Content-Length");
+        contentLength = 0;
+        if (!lengthStr.empty()) {
+            char* parseEnd = nullptr;
+            unsigned long long length = std::strtoull(lengthStr.c_str(), &parseEnd, 10);
+            if (*parseEnd != '\0' || lengthStr[0] == '-') {
+                fail(400, "Bad Request");
+                return;
+            }
+            if (length > limits.maxBodyBytes) {
+                fail(413, "Payload Too Large");
+                return;
+            }
+            contentLength = static_cast<size_t>(length);
+        }
+
+        if (contentLength == 0) {
+            state = State::COMPLETE;
+        } else {
+            req.body.reserve(contentLength);
+            state = State::BODY;
+        }
+    }
+
+public:
+    HttpRequestParser(const HttpParserLimits& limits = HttpParserLimits()) : limits(limits) {
+        reset();
+    }
+
+    // Start over for the next request on the same connection
+    void reset() {
+        req.clear();
+        state = State::REQUEST_LINE;
+        headerBytes = 0;
+        contentLength = 0;
+        errorStatus = 0;
+        errorText.clear();
+    }
+
+    // Consume as much of [data, data + size) as belongs to the current
+    // request; returns the number of bytes used
+    size_t feed(const char* data, size_t size) {
+        size_t used = 0;
+
+        while (used < size && (state == State::REQUEST_LINE || state == State::HEADERS)) {
+            const char* lineBegin = data + used;
+            const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', size - used));
+            if (lineEnd == nullptr) {
+                // Partial line stays in the caller's buffer until more arrives
+                if (headerBytes + (size - used) > limits.maxHeaderBytes) {
+                    fail(431, "Request Header Fields Too Large");
+                }
+                return used;
+            }
+
+            size_t lineLength = lineEnd - lineBegin + 1;
+            headerBytes += lineLength;
+            if (headerBytes > limits.maxHeaderBytes) {
+                fail(431, "Request Header Fields Too Large");
+                return used;
+            }
+            used += lineLength;
+
+            if (state == State::REQUEST_LINE) {
+                // Tolerate stray CRLFs between pipelined requests
+                if (lineLength <= 2 && (lineLength == 1 || lineBegin[0] == '\r')) continue;
+                parseRequestLine(lineBegin, lineEnd);
+            } else {
+                parseHeaderLine(lineBegin, lineEnd);
+            }
+        }
+
+        if (state == State::BODY && used < size) {
+            size_t take = std::min(contentLength - req.body.size(), size - used);
+            req.body.append(data + used, take);
+            used += take;
+            if (req.body.size() == contentLength) {
+                state = State::COMPLETE;
+            }
+        }
+
+        return used;
+    }
+
+    // Move the completed request out and start over for the next one
+    HttpRequest takeRequest() {
+        HttpRequest completed = std::move(req);
+        reset();
+        return completed;
+    }
+
+    State getState() const { return state; }
+    const HttpRequest& request() const { return req; }
+    int getErrorStatus() const { return errorStatus; }
+    const std::string& getErrorText() const { return errorText; }
+};
+
+#endif // HTTP_PARSER_H
@@ -0,0 +1,123 @@
+//
+// ImageCodec.h - Field encoding for persisted index images
+// Numbers are little-endian and strings are a u32 length followed by the
+// bytes, as in the write-ahead log. The reader never reads past its end:
+// once a field runs short ok() turns false and every later read yields
+// zero or an empty string, so a caller checks once after a batch of reads.
+//
+
+#ifndef IMAGE_CODEC_H
+#define IMAGE_CODEC_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+class ImageWriter {
+private:
+    std::string& out;
+
+public:
+    explicit ImageWriter(std::string& target) : out(target) {}
+
+    void u8(uint8_t value) {
+        out += static_cast<char>(value);
+    }
+
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; i++) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; i++) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    void str(const std::string& value) {
+        u32(static_cast<uint32_t>(value.size()));
+        out += value;
+    }
+
+    // Reserve a u64 length now and fill it in with endSection(), so a reader
+    // that doesn't want a section can skip it whole
+    size_t beginSection() {
+        size_t at = out.size();
+        u64(0);
+        return at;
+    }
+
+    void endSection(size_t at) {
+        uint64_t length = out.size() - at - 8;
+        for (int i = 0; i < 8; i++) out[at + i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+    }
+};
+
+class ImageReader {
+private:
+    const char* pos;
+    const char* end;
+    bool good;
+
+    bool take(size_t count) {
+        if (!good || static_cast<size_t>(end - pos) < count) {
+            good = false;
+            return false;
+        }
+        return true;
+    }
+
+public:
+    ImageReader(const char* data, size_t length) : pos(data), end(data + length), good(true) {}
+
+    uint8_t u8() {
+        if (!take(1)) return 0;
+        return static_cast<uint8_t>(*pos++);
+    }
+
+    uint32_t u32() {
+        if (!take(4)) return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(static_cast<uint8_t>(pos[i])) << (8 * i);
+        pos += 4;
+        return value;
+    }
+
+    uint64_t u64() {
+        if (!take(8)) return 0;
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(static_cast<uint8_t>(pos[i])) << (8 * i);
+        pos += 8;
+        return value;
+    }
+
+    std::string str() {
+        uint32_t length = u32();
+        if (!take(length)) return "";
+        std::string value(pos, length);
+        pos += length;
+        return value;
+    }
+
+    // Reader over the next section written by beginSection()/endSection()
+    ImageReader section() {
+        uint64_t length = u64();
+        ImageReader inner(pos, 0);
+        if (!take(length)) {
+            inner.good = false;
+            return inner;
+        }
+        inner.end = pos + length;
+        pos += length;
+        return inner;
+    }
+
+    // Room for count more elements of at least each bytes; a cheap bound on
+    // counts read from the image before reserving space for them
+    bool has(uint64_t count, size_t each = 1) const {
+        return good && count <= static_cast<uint64_t>(end - pos) / each;
+    }
+
+    bool ok() const { return good; }
+    bool atEnd() const { return good && pos == end; }
+};
+
+#endif // IMAGE_CODEC_H
@@ -0,0 +1,307 @@
+//
+// IoUring.h - Minimal io_uring wrapper over the raw kernel interface
+// Contains: IoUring (submission/completion rings), ProvidedBuffers
+// (kernel-selected receive buffers). Linux only; no liburing dependency.
+//
+
+#ifndef IO_URING_H
+#define IO_URING_H
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+// ============================================================================
+// IO URING - Submission queue, completion queue and the enter syscall
+// Single-threaded: one ring belongs to one event loop.
+// ============================================================================
+class IoUring {
+private:
+    int ringFd;
+    unsigned features;
+
+    // Submission queue
+    void* sqRing;
+    size_t sqRingSize;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned* sqArray;
+    io_uring_sqe* sqes;
+    size_t sqesSize;
+    unsigned sqLocalTail;       // SQEs prepared but not yet published to the kernel
+
+    // Completion queue
+    void* cqRing;
+    size_t cqRingSize;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    io_uring_cqe* cqes;
+
+    uint64_t enterCalls;
+
+    static unsigned loadAcquire(const unsigned* p) {
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+    }
+    static void storeRelease(unsigned* p, unsigned v) {
+        __atomic_store_n(p, v, __ATOMIC_RELEASE);
+    }
+
+    // Make prepared SQEs visible to the kernel; returns how many are pending
+    unsigned publish() {
+        unsigned tail = *sqTail;
+        unsigned pending = sqLocalTail - tail;
+        if (pending > 0) storeRelease(sqTail, sqLocalTail);
+        return sqLocalTail - loadAcquire(sqHead);
+    }
+
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, void* arg, size_t argSize) {
+        enterCalls++;
+        int result = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, arg, argSize));
+        return result < 0 ? -errno : result;
+    }
+
+    void release() {
+        if (sqes) munmap(sqes, sqesSize);
+        if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing) munmap(sqRing, sqRingSize);
+        if (ringFd >= 0) close(ringFd);
+        sqes = nullptr;
+        sqRing = cqRing = nullptr;
+        ringFd = -1;
+    }
+
+public:
+    IoUring()
+        : ringFd(-1), features(0), sqRing(nullptr), sqRingSize(0), sqHead(nullptr), sqTail(nullptr),
+          sqMask(0), sqEntries(0), sqArray(nullptr), sqes(nullptr), sqesSize(0), sqLocalTail(0),
+          cqRing(nullptr), cqRingSize(0), cqHead(nullptr), cqTail(nullptr), cqMask(0), cqes(nullptr),
+          enterCalls(0) {}
+
+    ~IoUring() { release(); }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // Returns 0 or a negative errno
+    int init(unsigned entries, unsigned flags = 0) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        params.flags = flags | IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return -errno;
+        ringFd = fd;
+        features = params.features;
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (features & IORING_FEAT_SINGLE_MMAP) {
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        }
+
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            sqRing = nullptr;
+            int error = -errno;
+            release();
+            return error;
+        }
+        if (features & IORING_FEAT_SINGLE_MMAP) {
+            cqRing = sqRing;
+        } else {
+            cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                cqRing = nullptr;
+                int error = -errno;
+                release();
+                return error;
+            }
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMemory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqeMemory == MAP_FAILED) {
+            int error = -errno;
+            release();
+            return error;
+        }
+        sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+        char* sq = static_cast<char*>(sqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqEntries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqLocalTail = *sqTail;
+        // SQ array maps slots 1:1 onto SQEs
+        for (unsigned i = 0; i < sqEntries; i++) {
+            sqArray[i] = i;
+        }
+
+        char* cq = static_cast<char*>(cqRing);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return 0;
+    }
+
+    int fd() const { return ringFd; }
+    bool hasFeature(unsigned feature) const { return (features & feature) != 0; }
+    uint64_t getEnterCalls() const { return enterCalls; }
+
+    // Next free SQE, zeroed; submits what is queued first if the ring is full
+    io_uring_sqe* getSqe() {
+        if (sqLocalTail - loadAcquire(sqHead) >= sqEntries) {
+            submit();
+            if (sqLocalTail - loadAcquire(sqHead) >= sqEntries) return nullptr;
+        }
+        io_uring_sqe* sqe = &sqes[sqLocalTail & sqMask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqLocalTail++;
+        return sqe;
+    }
+
+    int submit() {
+        unsigned pending = publish();
+        if (pending == 0) return 0;
+        return enter(pending, 0, 0, nullptr, 0);
+    }
+
+    // Submit everything queued and wait for at least one completion, or
+    // until timeoutMs passes. Returns a negative errno on failure
+    // (-ETIME on timeout).
+    int submitAndWait(int timeoutMs) {
+        unsigned pending = publish();
+        if (loadAcquire(cqTail) != *cqHead) {
+            return pending ? enter(pending, 0, 0, nullptr, 0) : 0;
+        }
+
+        __kernel_timespec ts;
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+        io_uring_getevents_arg arg;
+        std::memset(&arg, 0, sizeof(arg));
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        return enter(pending, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    }
+
+    // Visit ready completions in order; each is retired after the visit
+    template <typename Visitor>
+    unsigned forEachCompletion(Visitor visit) {
+        unsigned head = *cqHead;
+        unsigned tail = loadAcquire(cqTail);
+        unsigned seen = 0;
+        while (head != tail) {
+            // Copy out first so the visitor may queue new work freely
+            io_uring_cqe cqe = cqes[head & cqMask];
+            head++;
+            storeRelease(cqHead, head);
+            visit(cqe);
+            seen++;
+            tail = loadAcquire(cqTail);
+        }
+        return seen;
+    }
+
+    int registerRaw(unsigned opcode, void* arg, unsigned count) {
+        int result = static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+        return result < 0 ? -errno : result;
+    }
+
+    // True when the kernel implements every listed opcode
+    bool supportsOps(const uint8_t* ops, size_t count) {
+        const size_t probeOps = 256;
+        size_t size = sizeof(io_uring_probe) + probeOps * sizeof(io_uring_probe_op);
+        io_uring_probe* probe = static_cast<io_uring_probe*>(std::calloc(1, size));
+        if (!probe) return false;
+        bool supported = registerRaw(IORING_REGISTER_PROBE, probe, probeOps) >= 0;
+        for (size_t i = 0; supported && i < count; i++) {
+            supported = ops[i] <= probe->last_op && (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED);
+        }
+        std::free(probe);
+        return supported;
+    }
+};
+
+// ============================================================================
+// PROVIDED BUFFERS - Receive buffers handed to the kernel up front
+// Multishot receives pick a free buffer from the group themselves and report
+// its id in the completion; the loop gives the buffer back once it has copied
+// the bytes. Buffers go in with IORING_OP_PROVIDE_BUFFERS, so returning one
+// is just another entry in the next submission, not a syscall of its own.
+// ============================================================================
+class ProvidedBuffers {
+private:
+    IoUring* ring;
+    uint16_t groupId;
+    size_t bufferSize;
+    char* buffers;
+
+    void fill(io_uring_sqe* sqe, uint16_t firstId, unsigned count) {
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = static_cast<int>(count);
+        sqe->addr = reinterpret_cast<uint64_t>(buffers + static_cast<size_t>(firstId) * bufferSize);
+        sqe->len = static_cast<uint32_t>(bufferSize);
+        sqe->off = firstId;
+        sqe->buf_group = groupId;
+    }
+
+public:
+    ProvidedBuffers() : ring(nullptr), groupId(0), bufferSize(0), buffers(nullptr) {}
+
+    // Buffers still provided when the ring goes away are released with it
+    ~ProvidedBuffers() {
+        std::free(buffers);
+    }
+
+    ProvidedBuffers(const ProvidedBuffers&) = delete;
+    ProvidedBuffers& operator=(const ProvidedBuffers&) = delete;
+
+    // Provides count buffers of size bytes as group. Must run before anything
+    // else is queued on the ring: it waits for its own completion, tagged
+    // with user_data 0. Returns 0 or a negative errno.
+    int init(IoUring& owner, uint16_t group, unsigned count, size_t size) {
+        buffers = static_cast<char*>(std::malloc(count * size));
+        if (!buffers) return -ENOMEM;
+        ring = &owner;
+        groupId = group;
+        bufferSize = size;
+
+        io_uring_sqe* sqe = owner.getSqe();
+        if (!sqe) return -EBUSY;
+        fill(sqe, 0, count);
+        int result = owner.submitAndWait(1000);
+        if (result < 0) return result;
+        owner.forEachCompletion([&result](const io_uring_cqe& cqe) {
+            if (cqe.user_data == 0 && cqe.res < 0) result = cqe.res;
+        });
+        return result < 0 ? result : 0;
+    }
+
+    uint16_t group() const { return groupId; }
+    const char* data(uint16_t bufferId) const { return buffers + static_cast<size_t>(bufferId) * bufferSize; }
+
+    // Queue a consumed buffer to go back to the kernel. Only failures post a
+    // completion (user_data 0); false when the submission queue is full.
+    bool recycle(uint16_t bufferId) {
+        io_uring_sqe* sqe = ring->getSqe();
+        if (!sqe) return false;
+        fill(sqe, bufferId, 1);
+        if (ring->hasFeature(IORING_FEAT_CQE_SKIP)) sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        return true;
+    }
+};
+
+#endif // IO_URING_H
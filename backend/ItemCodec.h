@@ -0,0 +1,317 @@
+//
+// ItemCodec.h - JSON encoding and decoding of records from one field table
+// Each record type lists its fields once in a JsonSchema specialization:
+// the JSON name, the member, and the outputs it appears in (the API leaves
+// out owner emails and claim details, data.json keeps everything). The
+// encoder and decoder are generated from that table at compile time, so a
+// new field is one line here and every caller picks it up. Values go
+// through JsonWriter, the single place where strings are escaped and
+// numbers formatted.
+//
+
+#ifndef ITEM_CODEC_H
+#define ITEM_CODEC_H
+
+#include "DataStructures.h"
+#include "JsonStream.h"
+#include <string>
+#include <vector>
+#include <tuple>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+
+// Outputs a field appears in
+enum JsonFieldFlags : unsigned {
+    FIELD_API = 1,          // Responses and webhook payloads
+    FIELD_STORED = 2,       // data.json
+    FIELD_ALL = FIELD_API | FIELD_STORED
+};
+
+template <class Record, class Value>
+struct JsonField {
+    const char* name;
+    size_t nameLength;
+    Value Record::*member;
+    unsigned flags;
+};
+
+template <class Record, class Value, size_t N>
+constexpr JsonField<Record, Value> jsonField(const char (&name)[N], Value Record::*member, unsigned flags = FIELD_ALL) {
+    return JsonField<Record, Value>{name, N - 1, member, flags};
+}
+
+// Specialized per record type with a constexpr tuple of fields, in output order
+template <class Record>
+struct JsonSchema;
+
+template <>
+struct JsonSchema<Item> {
+    static constexpr auto fields = std::make_tuple(
+        jsonField("id", &Item::id),
+        jsonField("name", &Item::name),
+        jsonField("color", &Item::color),
+        jsonField("location", &Item::location),
+        jsonField("owner", &Item::owner),
+        jsonField("email", &Item::email, FIELD_STORED),
+        jsonField("type", &Item::type),
+        jsonField("timestamp", &Item::timestamp),
+        jsonField("description", &Item::description),
+        jsonField("category", &Item::category),
+        jsonField("archived", &Item::archived),
+        jsonField("expiresAt", &Item::expiresAt),
+        jsonField("claimed", &Item::claimed, FIELD_STORED),
+        jsonField("claimedBy", &Item::claimedBy, FIELD_STORED),
+        jsonField("claimedAt", &Item::claimedAt, FIELD_STORED));
+};
+
+template <>
+struct JsonSchema<MatchCandidate> {
+    static constexpr auto fields = std::make_tuple(
+        jsonField("itemId", &MatchCandidate::itemId),
+        jsonField("itemName", &MatchCandidate::itemName),
+        jsonField("owner", &MatchCandidate::owner),
+        jsonField("location", &MatchCandidate::location),
+        jsonField("color", &MatchCandidate::color),
+        jsonField("score", &MatchCandidate::score),
+        jsonField("nameScore", &MatchCandidate::nameScore),
+        jsonField("colorScore", &MatchCandidate::colorScore),
+        jsonField("proximityScore", &MatchCandidate::proximityScore));
+};
+
+// ============================================================================
+// JSON WRITER - Appends a document to a caller-owned buffer
+// Commas are placed automatically. With an indent step every member and
+// element goes on its own line; without one the output is compact. A
+// writer can start at a depth, to append one element of an array that is
+// being written piecemeal.
+// ============================================================================
+class JsonWriter {
+private:
+    static const size_t MAX_PREFIX = 128;   // Separator, indentation and key, built before one append
+
+    std::string& out;
+    int step;
+    std::vector<char> started;      // Per open container: something written in it yet
+    int baseDepth;
+    bool afterKey;
+
+    void newline(int depth) {
+        out += '\n';
+        out.append(static_cast<size_t>(depth * step), ' ');
+    }
+
+    // Separator and indentation before a member name or array element,
+    // written to prefix; returns the length
+    size_t itemPrefix(char* prefix) {
+        if (started.empty()) return 0;
+        size_t length = 0;
+        if (started.back()) prefix[length++] = ',';
+        started.back() = true;
+        if (step > 0) {
+            size_t indent = static_cast<size_t>((baseDepth + static_cast<int>(started.size())) * step);
+            prefix[length++] = '\n';
+            indent = std::min(indent, MAX_PREFIX / 2);
+            std::memset(prefix + length, ' ', indent);
+            length += indent;
+        }
+        return length;
+    }
+
+    void beginItem() {
+        char prefix[MAX_PREFIX];
+        out.append(prefix, itemPrefix(prefix));
+    }
+
+    void beginValue() {
+        if (afterKey) {
+            afterKey = false;
+        } else {
+            beginItem();
+        }
+    }
+
+    template <class Integer>
+    void appendInteger(Integer number) {
+        char digits[24];
+        auto end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+        out.append(digits, static_cast<size_t>(end - digits));
+    }
+
+    void close(char bracket) {
+        bool any = started.back();
+        started.pop_back();
+        if (any && step > 0) newline(baseDepth + static_cast<int>(started.size()));
+        out += bracket;
+    }
+
+public:
+    explicit JsonWriter(std::string& target, int indentStep = 0, int depth = 0)
+        : out(target), step(indentStep), baseDepth(depth), afterKey(false) {}
+
+    void beginObject() {
+        beginValue();
+        out += '{';
+        started.push_back(false);
+    }
+
+    void endObject() { close('}'); }
+
+    void beginArray() {
+        beginValue();
+        out += '[';
+        started.push_back(false);
+    }
+
+    void endArray() { close(']'); }
+
+    // Separator, indentation and member name in one append; with
+    // openQuote also the opening quote of a string value
+    void writeKey(const char* name, size_t length, bool openQuote) {
+        char prefix[MAX_PREFIX];
+        size_t at = itemPrefix(prefix);
+        if (at + length + 5 > MAX_PREFIX) {
+            out.append(prefix, at);
+            out += '"';
+            out.append(name, length);
+            out += step > 0 ? "\": " : "\":";
+            if (openQuote) out += '"';
+            return;
+        }
+        prefix[at++] = '"';
+        std::memcpy(prefix + at, name, length);
+        at += length;
+        prefix[at++] = '"';
+        prefix[at++] = ':';
+        if (step > 0) prefix[at++] = ' ';
+        if (openQuote) prefix[at++] = '"';
+        out.append(prefix, at);
+    }
+
+    void key(const char* name, size_t length) {
+        writeKey(name, length, false);
+        afterKey = true;
+    }
+
+    void key(const char* name) { key(name, std::strlen(name)); }
+
+    void value(const std::string& text) {
+        beginValue();
+        out += '"';
+        appendJsonEscaped(out, text);
+        out += '"';
+    }
+
+    void value(const char* text) { value(std::string(text)); }
+    void value(long long number) { beginValue(); appendInteger(number); }
+    void value(int number) { beginValue(); appendInteger(number); }
+    void value(size_t number) { beginValue(); appendInteger(number); }
+
+    void value(bool flag) {
+        beginValue();
+        out += flag ? "true" : "false";
+    }
+
+    void value(Category category) {
+        beginValue();
+        out += '"';
+        out += categoryToString(category);
+        out += '"';
+    }
+
+    template <class Value>
+    void member(const char* name, const Value& content) {
+        key(name);
+        value(content);
+    }
+
+    template <class Record, class Value>
+    void member(const JsonField<Record, Value>& field, const Record& record) {
+        key(field.name, field.nameLength);
+        value(record.*field.member);
+    }
+
+    // Most members of most records: the hot path
+    template <class Record>
+    void member(const JsonField<Record, std::string>& field, const Record& record) {
+        writeKey(field.name, field.nameLength, true);
+        appendJsonEscaped(out, record.*field.member);
+        out += '"';
+    }
+};
+
+// The fields of record in the given outputs, as one object
+template <class Record>
+void writeJsonObject(JsonWriter& writer, const Record& record, unsigned outputs) {
+    writer.beginObject();
+    std::apply([&](const auto&... field) {
+        ((field.flags & outputs ? writer.member(field, record) : void()), ...);
+    }, JsonSchema<Record>::fields);
+    writer.endObject();
+}
+
+// writeJsonObject() for every record, as an array
+template <class Record>
+void writeJsonArray(JsonWriter& writer, const std::vector<Record>& records, unsigned outputs) {
+    writer.beginArray();
+    for (const Record& record : records) {
+        writeJsonObject(writer, record, outputs);
+    }
+    writer.endArray();
+}
+
+// ============================================================================
+// DECODER - Fills a record from the members of an object being read
+// ============================================================================
+
+// Each returns false, consuming nothing more, if the token is the wrong kind
+inline bool readJsonValue(JsonStreamReader& json, JsonToken token, std::string& target) {
+    if (token != JsonToken::STRING) return false;
+    target = json.text();
+    return true;
+}
+
+inline bool readJsonValue(JsonStreamReader& json, JsonToken token, long long& target) {
+    if (token != JsonToken::NUMBER) return false;
+    target = json.number();
+    return true;
+}
+
+inline bool readJsonValue(JsonStreamReader& json, JsonToken token, int& target) {
+    if (token != JsonToken::NUMBER) return false;
+    target = static_cast<int>(json.number());
+    return true;
+}
+
+inline bool readJsonValue(JsonStreamReader&, JsonToken token, bool& target) {
+    if (token != JsonToken::TRUE_VALUE && token != JsonToken::FALSE_VALUE) return false;
+    target = token == JsonToken::TRUE_VALUE;
+    return true;
+}
+
+inline bool readJsonValue(JsonStreamReader& json, JsonToken token, Category& target) {
+    if (token != JsonToken::STRING) return false;
+    target = json.text().empty() ? Category::OTHER : stringToCategory(json.text());
+    return true;
+}
+
+// Reads members up to and including the END_OBJECT, BEGIN_OBJECT already
+// read. Unknown members and values of the wrong kind are skipped; false on
+// a syntax error.
+template <class Record>
+bool readJsonObject(JsonStreamReader& json, Record& record, unsigned outputs = FIELD_ALL) {
+    JsonToken token;
+    while ((token = json.next()) == JsonToken::KEY) {
+        std::string key = json.text();
+        JsonToken value = json.next();
+        bool used = false;
+        std::apply([&](const auto&... field) {
+            ((!used && (field.flags & outputs) && key == field.name &&
+              (used = readJsonValue(json, value, record.*field.member))), ...);
+        }, JsonSchema<Record>::fields);
+        if (!used && json.skip(value) == JsonToken::ERROR) return false;
+    }
+    return token == JsonToken::END_OBJECT;
+}
+
+#endif // ITEM_CODEC_H
@@ -0,0 +1,325 @@
+//
+// JsonStream.h - Single-pass JSON tokenizer over a stream
+// Reads its input in fixed-size chunks and hands out one token at a time,
+// so memory use is one chunk plus the longest string, however large the
+// file. Strings are unescaped as they are scanned. Files written before
+// escaping was added are still accepted: raw control characters inside
+// strings are kept, and an unknown escape keeps its backslash.
+//
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+
+enum class JsonToken {
+    BEGIN_OBJECT,
+    END_OBJECT,
+    BEGIN_ARRAY,
+    END_ARRAY,
+    KEY,            // Object member name; text() holds it
+    STRING,         // text() holds the unescaped value
+    NUMBER,         // text() holds the literal; number() converts it
+    TRUE_VALUE,
+    FALSE_VALUE,
+    NULL_VALUE,
+    END,            // Input exhausted after a complete value
+    ERROR           // error() says what and where
+};
+
+inline bool jsonNeedsEscape(char c) {
+    return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\';
+}
+
+// Appends value to out as the body of a JSON string (without quotes). Runs
+// that need no escaping, nearly all of a typical value, are copied whole.
+inline void appendJsonEscaped(std::string& out, const std::string& value) {
+    static const char hex[] = "0123456789abcdef";
+    const char* data = value.data();
+    size_t size = value.size();
+    size_t run = 0;
+    for (size_t i = 0; i < size; i++) {
+        char c = data[i];
+        if (!jsonNeedsEscape(c)) continue;
+        out.append(data + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                out += "\\u00";
+                out += hex[(c >> 4) & 0xF];
+                out += hex[c & 0xF];
+        }
+    }
+    out.append(data + run, size - run);
+}
+
+inline std::string jsonEscape(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    appendJsonEscaped(out, value);
+    return out;
+}
+
+// ============================================================================
+// JSON STREAM READER - Pull tokenizer
+// Structure is tracked with a small stack so that KEY can be told apart
+// from STRING and misplaced commas or colons are reported.
+// ============================================================================
+class JsonStreamReader {
+private:
+    static const size_t MAX_TOKEN = 1024 * 1024;    // Longest string or number accepted
+
+    enum Context : uint8_t {
+        IN_OBJECT,
+        IN_ARRAY
+    };
+
+    std::istream& in;
+    std::vector<char> buffer;
+    size_t pos;
+    size_t filled;
+    uint64_t consumed;          // Bytes before buffer[0]
+
+    std::vector<Context> stack;
+    bool expectKey;             // Inside an object, before a member name
+    bool afterValue;            // A value just ended: comma or close expected
+    bool finished;              // Top-level value complete
+
+    std::string token;
+    std::string message;
+
+    bool fill() {
+        consumed += filled;
+        pos = 0;
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        filled = static_cast<size_t>(in.gcount());
+        return filled > 0;
+    }
+
+    // Next byte without consuming it; -1 at end of input
+    int peek() {
+        if (pos == filled && !fill()) return -1;
+        return static_cast<unsigned char>(buffer[pos]);
+    }
+
+    int get() {
+        int c = peek();
+        if (c >= 0) pos++;
+        return c;
+    }
+
+    void skipWhitespace() {
+        while (true) {
+            int c = peek();
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') return;
+            pos++;
+        }
+    }
+
+    JsonToken fail(const std::string& what) {
+        message = what + " at byte " + std::to_string(consumed + pos);
+        return JsonToken::ERROR;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    // Four hex digits after \u; false if they aren't
+    bool readHex4(uint32_t& value) {
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            int c = get();
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    // Opening quote already consumed
+    bool readString() {
+        token.clear();
+        while (true) {
+            // Copy the plain run up to the next quote or backslash in one go
+            if (pos == filled && !fill()) return false;
+            size_t start = pos;
+            while (pos < filled && buffer[pos] != '"' && buffer[pos] != '\\') pos++;
+            token.append(buffer.data() + start, pos - start);
+            if (token.size() > MAX_TOKEN) return false;
+            if (pos == filled) continue;
+
+            char c = buffer[pos++];
+            if (c == '"') return true;
+
+            int escaped = get();
+            switch (escaped) {
+                case '"':  token += '"'; break;
+                case '\\': token += '\\'; break;
+                case '/':  token += '/'; break;
+                case 'n':  token += '\n'; break;
+                case 'r':  token += '\r'; break;
+                case 't':  token += '\t'; break;
+                case 'b':  token += '\b'; break;
+                case 'f':  token += '\f'; break;
+                case 'u': {
+                    uint32_t codepoint;
+                    if (!readHex4(codepoint)) return false;
+                    if (codepoint >= 0xD800 && codepoint < 0xDC00 && peek() == '\\') {
+                        pos++;
+                        uint32_t low;
+                        if (get() != 'u' || !readHex4(low) || low < 0xDC00 || low > 0xDFFF) return false;
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(token, codepoint);
+                    break;
+                }
+                case -1:
+                    return false;
+                default:
+                    // Written unescaped by an older version; keep it as it was
+                    token += '\\';
+                    token += static_cast<char>(escaped);
+            }
+        }
+    }
+
+    void readLiteral() {
+        token.clear();
+        while (token.size() <= MAX_TOKEN) {
+            int c = peek();
+            if (c < 0 || !(std::isalnum(c) || c == '-' || c == '+' || c == '.')) return;
+            token += static_cast<char>(c);
+            pos++;
+        }
+    }
+
+    // A scalar or container just ended at the current depth
+    void valueEnded() {
+        afterValue = true;
+        if (stack.empty()) finished = true;
+    }
+
+public:
+    explicit JsonStreamReader(std::istream& input, size_t chunkSize = 64 * 1024)
+        : in(input), buffer(chunkSize), pos(0), filled(0), consumed(0),
+          expectKey(false), afterValue(false), finished(false) {}
+
+    JsonToken next() {
+        skipWhitespace();
+        int c = peek();
+        if (finished) {
+            return c < 0 ? JsonToken::END : fail("unexpected data after the document");
+        }
+        if (c < 0) return fail("unexpected end of input");
+
+        if (afterValue) {
+            if (c == ',') {
+                if (stack.empty()) return fail("unexpected ','");
+                pos++;
+                afterValue = false;
+                expectKey = stack.back() == IN_OBJECT;
+                skipWhitespace();
+                c = peek();
+                if (c == '}' || c == ']') return fail("trailing ','");
+            } else if (c != '}' && c != ']') {
+                return fail("expected ',' or a closing bracket");
+            }
+        }
+
+        if (c == '}' || c == ']') {
+            Context closing = c == '}' ? IN_OBJECT : IN_ARRAY;
+            if (stack.empty() || stack.back() != closing) return fail(std::string("unexpected '") + static_cast<char>(c) + "'");
+            if (!afterValue && !expectKey && closing == IN_OBJECT) return fail("missing value");
+            pos++;
+            stack.pop_back();
+            expectKey = false;
+            valueEnded();
+            return closing == IN_OBJECT ? JsonToken::END_OBJECT : JsonToken::END_ARRAY;
+        }
+
+        if (expectKey) {
+            if (c != '"') return fail("expected a member name");
+            pos++;
+            if (!readString()) return fail("unterminated or oversized member name");
+            skipWhitespace();
+            if (get() != ':') return fail("expected ':'");
+            expectKey = false;
+            return JsonToken::KEY;
+        }
+
+        afterValue = false;
+        switch (c) {
+            case '{':
+                pos++;
+                stack.push_back(IN_OBJECT);
+                expectKey = true;
+                return JsonToken::BEGIN_OBJECT;
+            case '[':
+                pos++;
+                stack.push_back(IN_ARRAY);
+                return JsonToken::BEGIN_ARRAY;
+            case '"':
+                pos++;
+                if (!readString()) return fail("unterminated or oversized string");
+                valueEnded();
+                return JsonToken::STRING;
+        }
+
+        readLiteral();
+        if (token.empty()) return fail(std::string("unexpected '") + static_cast<char>(c) + "'");
+        valueEnded();
+        if (token == "true") return JsonToken::TRUE_VALUE;
+        if (token == "false") return JsonToken::FALSE_VALUE;
+        if (token == "null") return JsonToken::NULL_VALUE;
+        if (token[0] == '-' || std::isdigit(static_cast<unsigned char>(token[0]))) return JsonToken::NUMBER;
+        return fail("invalid literal '" + token + "'");
+    }
+
+    // Skip the value whose first token was just returned (containers whole)
+    JsonToken skip(JsonToken first) {
+        if (first != JsonToken::BEGIN_OBJECT && first != JsonToken::BEGIN_ARRAY) return first;
+        size_t depth = 1;
+        while (depth > 0) {
+            JsonToken token = next();
+            if (token == JsonToken::ERROR) return token;
+            if (token == JsonToken::BEGIN_OBJECT || token == JsonToken::BEGIN_ARRAY) depth++;
+            if (token == JsonToken::END_OBJECT || token == JsonToken::END_ARRAY) depth--;
+        }
+        return first;
+    }
+
+    const std::string& text() const { return token; }
+    long long number() const { return std::strtoll(token.c_str(), nullptr, 10); }
+    const std::string& error() const { return message; }
+};
+
+#endif // JSON_STREAM_H
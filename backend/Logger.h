@@ -0,0 +1,307 @@
+//
+// Logger.h - Asynchronous request logging
+// Handler threads append fixed-size records to a lock-free ring buffer; one
+// background thread formats them and writes to stdout or a file. Logging
+// never blocks a request: when the ring is full the record is dropped and
+// counted instead.
+//
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+
+enum class LogLevel : uint8_t {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    OFF
+};
+
+inline const char* logLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO:  return "INFO";
+        case LogLevel::WARN:  return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default:              return "OFF";
+    }
+}
+
+inline bool parseLogLevel(const std::string& name, LogLevel& level) {
+    static const LogLevel levels[] = {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARN, LogLevel::ERROR, LogLevel::OFF};
+    for (LogLevel candidate : levels) {
+        std::string candidateName = logLevelName(candidate);
+        if (name.size() == candidateName.size() &&
+            std::equal(name.begin(), name.end(), candidateName.begin(),
+                       [](char a, char b) { return ::toupper(a) == b; })) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// LOG RECORD - Fixed-size entry, copied into the ring without allocation
+// Request records carry method/route/status/latency with the path in text;
+// message records (status 0) carry only text. Long text is truncated.
+// ============================================================================
+struct LogRecord {
+    int64_t timestampUs;        // Wall clock, microseconds since the epoch
+    uint32_t latencyUs;
+    int16_t routeId;            // -1 when no route matched
+    uint16_t status;            // 0 for message records
+    LogLevel level;
+    char method[8];
+    char text[96];
+};
+
+struct LoggerStats {
+    size_t capacity;
+    uint64_t written;
+    uint64_t dropped;           // Ring was full
+};
+
+// ============================================================================
+// ASYNC LOGGER - Bounded multi-producer ring (per-slot sequence numbers)
+// drained by a single writer thread
+// ============================================================================
+class AsyncLogger {
+public:
+    typedef std::function<std::string(int)> RouteNamer;
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;          // Writer thread only
+
+    std::atomic<uint8_t> minLevel;
+    std::atomic<bool> running;
+    std::thread writer;
+    FILE* out;
+    bool ownsFile;
+    RouteNamer routeNamer;
+
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> dropped;
+
+    static int64_t nowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static void copyText(char* dest, size_t size, const char* src, size_t length) {
+        length = std::min(length, size - 1);
+        std::memcpy(dest, src, length);
+        dest[length] = '\0';
+    }
+
+    bool tryPush(const LogRecord& record) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.record = record;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // Full: the writer has not freed this slot yet
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(LogRecord& record) {
+        Slot& slot = slots[dequeuePos & mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePos + 1) < 0) {
+            return false;
+        }
+        record = slot.record;
+        slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+
+    void format(const LogRecord& record, std::string& line) {
+        time_t seconds = static_cast<time_t>(record.timestampUs / 1000000);
+        struct tm local;
+#ifdef _WIN32
+        localtime_s(&local, &seconds);
+#else
+        localtime_r(&seconds, &local);
+#endif
+        char prefix[48];
+        size_t length = std::strftime(prefix, sizeof(prefix), "[%Y-%m-%d %H:%M:%S", &local);
+        length += std::snprintf(prefix + length, sizeof(prefix) - length, ".%03d] %-5s ",
+                                static_cast<int>((record.timestampUs / 1000) % 1000),
+                                logLevelName(record.level));
+        line.append(prefix, length);
+
+        if (record.status == 0) {
+            line += record.text;
+        } else {
+            char detail[64];
+            std::snprintf(detail, sizeof(detail), " %u %.3fms", record.status, record.latencyUs / 1000.0);
+            line += record.method;
+            line += ' ';
+            line += record.text;
+            line += detail;
+            if (record.routeId >= 0 && routeNamer) {
+                line += " route=";
+                line += routeNamer(record.routeId);
+            }
+        }
+        line += '\n';
+    }
+
+    void writerLoop() {
+        std::string batch;
+        LogRecord record;
+        while (true) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            batch.clear();
+            while (batch.size() < 64 * 1024 && tryPop(record)) {
+                format(record, batch);
+                written++;
+            }
+            if (!batch.empty()) {
+                std::fwrite(batch.data(), 1, batch.size(), out);
+                std::fflush(out);
+                continue;
+            }
+            if (stopping) return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+public:
+    explicit AsyncLogger(size_t capacity = 8192)
+        : dequeuePos(0), minLevel(static_cast<uint8_t>(LogLevel::INFO)), running(false),
+          out(stdout), ownsFile(false), written(0), dropped(0) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos.store(0, std::memory_order_relaxed);
+    }
+
+    ~AsyncLogger() {
+        shutdown();
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Used by the writer thread to print route names; set before start()
+    void setRouteNamer(RouteNamer namer) { routeNamer = std::move(namer); }
+
+    // Empty path logs to stdout. Returns false if the file can't be opened.
+    bool start(LogLevel level, const std::string& path = "") {
+        minLevel = static_cast<uint8_t>(level);
+        if (!path.empty()) {
+            FILE* file = std::fopen(path.c_str(), "a");
+            if (file == nullptr) return false;
+            out = file;
+            ownsFile = true;
+        }
+        running = true;
+        writer = std::thread(&AsyncLogger::writerLoop, this);
+        return true;
+    }
+
+    // Drain what is queued and stop the writer; later records are dropped
+    void shutdown() {
+        if (!writer.joinable()) return;
+        running = false;
+        writer.join();
+        if (ownsFile) {
+            std::fclose(out);
+            ownsFile = false;
+        }
+        out = stdout;
+    }
+
+    bool enabled(LogLevel level) const {
+        return static_cast<uint8_t>(level) >= minLevel.load(std::memory_order_relaxed) &&
+               level != LogLevel::OFF;
+    }
+
+    void logRequest(LogLevel level, const std::string& method, const std::string& path,
+                    int routeId, int status, uint32_t latencyUs) {
+        if (!enabled(level)) return;
+        if (!running.load(std::memory_order_relaxed)) {
+            dropped++;
+            return;
+        }
+        LogRecord record;
+        record.timestampUs = nowMicros();
+        record.latencyUs = latencyUs;
+        record.routeId = static_cast<int16_t>(routeId);
+        record.status = static_cast<uint16_t>(status);
+        record.level = level;
+        copyText(record.method, sizeof(record.method), method.data(), method.size());
+        copyText(record.text, sizeof(record.text), path.data(), path.size());
+        if (!tryPush(record)) dropped++;
+    }
+
+    void log(LogLevel level, const std::string& message) {
+        if (!enabled(level)) return;
+        if (!running.load(std::memory_order_relaxed)) {
+            dropped++;
+            return;
+        }
+        LogRecord record;
+        record.timestampUs = nowMicros();
+        record.latencyUs = 0;
+        record.routeId = -1;
+        record.status = 0;
+        record.level = level;
+        record.method[0] = '\0';
+        copyText(record.text, sizeof(record.text), message.data(), message.size());
+        if (!tryPush(record)) dropped++;
+    }
+
+    LoggerStats getStats() const {
+        LoggerStats stats;
+        stats.capacity = mask + 1;
+        stats.written = written;
+        stats.dropped = dropped;
+        return stats;
+    }
+};
+
+// Process-wide logger. Never destroyed, so threads still logging while the
+// process exits don't touch a dead object; call shutdown() to flush first.
+inline AsyncLogger& appLogger() {
+    static AsyncLogger* logger = new AsyncLogger();
+    return *logger;
+}
+
+#endif // LOGGER_H
@@ -0,0 +1,240 @@
+//
+// Router.h - Table-driven HTTP routing
+// Routes are compiled once into a trie keyed by path segment; resolving a
+// request costs one step per segment, independent of how many routes exist.
+//
+
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+// Methods a route can be registered for ("*" registers all of them)
+static const int ROUTE_METHOD_COUNT = 7;
+static const char* const ROUTE_METHODS[ROUTE_METHOD_COUNT] = {
+    "GET", "POST", "PUT", "DELETE", "PATCH", "HEAD", "OPTIONS"
+};
+
+inline int routeMethodIndex(std::string_view method) {
+    for (int i = 0; i < ROUTE_METHOD_COUNT; i++) {
+        if (method == ROUTE_METHODS[i]) return i;
+    }
+    return -1;
+}
+
+// ============================================================================
+// ROUTE PARAMS - Values captured from {placeholders} in the matched path
+// ============================================================================
+class RouteParams {
+private:
+    std::vector<std::pair<std::string, std::string>> values;
+
+public:
+    void add(const std::string& name, std::string_view value) {
+        values.emplace_back(name, std::string(value));
+    }
+
+    std::string get(const std::string& name) const {
+        for (const auto& pair : values) {
+            if (pair.first == name) return pair.second;
+        }
+        return "";
+    }
+
+    size_t size() const { return values.size(); }
+    void truncate(size_t count) { values.resize(count); }
+};
+
+// ============================================================================
+// ROUTER - Method + path-segment trie
+// Patterns are literal segments or typed placeholders:
+//   /api/item/{id}/claim      {id} matches any non-empty segment
+//   /api/page/{n:int}         {n:int} matches digits only
+// Literal segments take precedence over placeholders at the same depth.
+// ============================================================================
+template <typename Handler>
+class Router {
+public:
+    struct Match {
+        const Handler* handler;     // nullptr when nothing matched
+        int routeId;                // Stable id assigned at registration, -1 if none
+        std::string allow;          // Methods the path supports when only the method was wrong
+    };
+
+private:
+    enum class ParamType { STRING, INTEGER };
+
+    struct Endpoint {
+        bool registered;
+        Handler handler;
+        int routeId;
+
+        Endpoint() : registered(false), handler(), routeId(-1) {}
+    };
+
+    struct Node {
+        std::vector<std::pair<std::string, std::unique_ptr<Node>>> literals;  // Sorted by segment
+        std::unique_ptr<Node> param;
+        std::string paramName;
+        ParamType paramType;
+        Endpoint endpoints[ROUTE_METHOD_COUNT];
+
+        Node() : paramType(ParamType::STRING) {}
+
+        Node* findLiteral(std::string_view segment) const {
+            auto it = std::lower_bound(literals.begin(), literals.end(), segment,
+                [](const std::pair<std::string, std::unique_ptr<Node>>& entry, std::string_view key) {
+                    return std::string_view(entry.first) < key;
+                });
+            if (it != literals.end() && it->first == segment) return it->second.get();
+            return nullptr;
+        }
+
+        bool hasEndpoints() const {
+            for (const auto& endpoint : endpoints) {
+                if (endpoint.registered) return true;
+            }
+            return false;
+        }
+    };
+
+    Node root;
+    std::vector<std::string> routeNames;
+
+    // Next non-empty segment starting at pos; pos is advanced past it
+    static bool nextSegment(std::string_view path, size_t& pos, std::string_view& segment) {
+        while (pos < path.size() && path[pos] == '/') pos++;
+        if (pos >= path.size()) return false;
+        size_t end = path.find('/', pos);
+        if (end == std::string_view::npos) end = path.size();
+        segment = path.substr(pos, end - pos);
+        pos = end;
+        return true;
+    }
+
+    static bool accepts(ParamType type, std::string_view segment) {
+        if (type == ParamType::INTEGER) {
+            return std::all_of(segment.begin(), segment.end(), [](char c) { return c >= '0' && c <= '9'; });
+        }
+        return true;
+    }
+
+    const Node* resolve(const Node* node, std::string_view path, size_t pos, RouteParams& params) const {
+        std::string_view segment;
+        if (!nextSegment(path, pos, segment)) {
+            return node->hasEndpoints() ? node : nullptr;
+        }
+
+        if (const Node* literal = node->findLiteral(segment)) {
+            if (const Node* found = resolve(literal, path, pos, params)) return found;
+        }
+
+        if (node->param && accepts(node->paramType, segment)) {
+            size_t mark = params.size();
+            params.add(node->paramName, segment);
+            if (const Node* found = resolve(node->param.get(), path, pos, params)) return found;
+            params.truncate(mark);
+        }
+        return nullptr;
+    }
+
+    Node* insertSegment(Node* node, std::string_view segment, const std::string& pattern) {
+        if (segment.size() >= 2 && segment.front() == '{' && segment.back() == '}') {
+            std::string_view spec = segment.substr(1, segment.size() - 2);
+            std::string_view name = spec;
+            ParamType type = ParamType::STRING;
+            size_t colon = spec.find(':');
+            if (colon != std::string_view::npos) {
+                name = spec.substr(0, colon);
+                std::string_view typeName = spec.substr(colon + 1);
+                if (typeName == "int") {
+                    type = ParamType::INTEGER;
+                } else if (typeName != "string") {
+                    throw std::invalid_argument("Unknown parameter type in route " + pattern);
+                }
+            }
+
+            if (!node->param) {
+                node->param = std::make_unique<Node>();
+                node->paramName = std::string(name);
+                node->paramType = type;
+            } else if (node->paramName != name || node->paramType != type) {
+                throw std::invalid_argument("Conflicting parameter in route " + pattern);
+            }
+            return node->param.get();
+        }
+
+        if (Node* existing = node->findLiteral(segment)) return existing;
+        auto it = std::lower_bound(node->literals.begin(), node->literals.end(), segment,
+            [](const std::pair<std::string, std::unique_ptr<Node>>& entry, std::string_view key) {
+                return std::string_view(entry.first) < key;
+            });
+        it = node->literals.emplace(it, std::string(segment), std::make_unique<Node>());
+        return it->second.get();
+    }
+
+public:
+    // Register a handler; returns the route id. Throws on duplicate or malformed routes.
+    int add(const std::string& method, const std::string& pattern, Handler handler) {
+        Node* node = &root;
+        size_t pos = 0;
+        std::string_view segment;
+        while (nextSegment(pattern, pos, segment)) {
+            node = insertSegment(node, segment, pattern);
+        }
+
+        int routeId = static_cast<int>(routeNames.size());
+        routeNames.push_back(method + " " + pattern);
+
+        for (int i = 0; i < ROUTE_METHOD_COUNT; i++) {
+            if (method != "*" && method != ROUTE_METHODS[i]) continue;
+            Endpoint& endpoint = node->endpoints[i];
+            if (endpoint.registered) {
+                throw std::invalid_argument("Duplicate route " + std::string(ROUTE_METHODS[i]) + " " + pattern);
+            }
+            endpoint.registered = true;
+            endpoint.handler = handler;
+            endpoint.routeId = routeId;
+        }
+        return routeId;
+    }
+
+    Match match(std::string_view method, std::string_view path, RouteParams& params) const {
+        Match result;
+        result.handler = nullptr;
+        result.routeId = -1;
+
+        const Node* node = resolve(&root, path, 0, params);
+        if (!node) return result;
+
+        int index = routeMethodIndex(method);
+        if (index >= 0 && node->endpoints[index].registered) {
+            result.handler = &node->endpoints[index].handler;
+            result.routeId = node->endpoints[index].routeId;
+            return result;
+        }
+
+        for (int i = 0; i < ROUTE_METHOD_COUNT; i++) {
+            if (!node->endpoints[i].registered) continue;
+            if (!result.allow.empty()) result.allow += ", ";
+            result.allow += ROUTE_METHODS[i];
+        }
+        return result;
+    }
+
+    // "METHOD /pattern" as registered, for logs and metrics
+    const std::string& routeName(int routeId) const {
+        static const std::string unmatched = "(unmatched)";
+        if (routeId < 0 || routeId >= static_cast<int>(routeNames.size())) return unmatched;
+        return routeNames[routeId];
+    }
+
+    size_t routeCount() const { return routeNames.size(); }
+};
+
+#endif // ROUTER_H
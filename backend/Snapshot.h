@@ -0,0 +1,500 @@
+//
+// Snapshot.h - Binary snapshot format, loaded through a read-only mapping
+// Layout (little-endian):
+//   [header][item records, fixed width][string table]
+// Strings live once in the table and records refer to them by offset and
+// length, so loading is a bounds check and a copy per field rather than a
+// parse. The header carries a checksum of itself and one of the records
+// and strings after it, checked before anything is loaded. data.json stays readable as an import and export format.
+// Each snapshot carries a random generation; the index image written next
+// to it (<snapshot>.idx) names the generation it was built for, and is
+// only loaded in place of rebuilding the indexes when the two match.
+// Archived items are not in the snapshot but in the cold segments it names,
+// less the ids it lists as deleted from each (see ColdArchive.h).
+//
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "DataStructures.h"
+#include "ImageCodec.h"
+#include "Wal.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char SNAPSHOT_MAGIC[8] = {'L', 'F', 'S', 'N', 'A', 'P', '\r', '\n'};
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+// Position of a string in the string table, which is therefore at most
+// UINT32_MAX bytes
+struct SnapshotString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t recordSize;
+    uint32_t headerChecksum;    // crc32 of the header with this field zeroed
+    uint64_t itemCount;
+    uint64_t recordsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    int64_t itemCounter;
+    uint64_t logSegment;        // First log segment not included
+    SnapshotString webhookUrl;
+    SnapshotString claimWebhookUrl;
+    uint64_t generation;        // Ties index images to this snapshot
+    SnapshotString cold;        // Cold segments: count, then per segment its number and deleted ids
+    uint32_t bodyChecksum;      // crc32 of the records and string table
+    uint32_t reserved;
+};
+
+struct SnapshotItemRecord {
+    SnapshotString id;
+    SnapshotString name;
+    SnapshotString color;
+    SnapshotString location;
+    SnapshotString owner;
+    SnapshotString email;
+    SnapshotString type;
+    SnapshotString description;
+    SnapshotString claimedBy;
+    int64_t timestamp;
+    int64_t expiresAt;
+    int64_t claimedAt;
+    uint8_t category;
+    uint8_t archived;
+    uint8_t claimed;
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(SnapshotHeader) == 112, "snapshot header layout changed");
+static_assert(sizeof(SnapshotItemRecord) == 104, "snapshot record layout changed");
+
+// A cold segment and the ids deleted from it since it was written
+struct SnapshotColdTier {
+    uint64_t segment;
+    std::vector<std::string> deleted;
+};
+
+// State stored next to the items
+struct SnapshotMeta {
+    int itemCounter;
+    uint64_t logSegment;
+    std::string webhookUrl;
+    std::string claimWebhookUrl;
+    uint64_t generation;
+    std::vector<SnapshotColdTier> coldTiers;    // Oldest first
+
+    SnapshotMeta() : itemCounter(0), logSegment(0), generation(0) {}
+};
+
+inline bool hostIsLittleEndian() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+}
+
+// Never 0, which stands for "no generation"
+inline uint64_t newSnapshotGeneration() {
+    std::random_device random;
+    uint64_t value = (static_cast<uint64_t>(random()) << 32) ^ random() ^
+                     static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return value != 0 ? value : 1;
+}
+
+// ============================================================================
+// SNAPSHOT WRITER - Builds a snapshot file image in memory
+// Repeated strings (locations, colors, types, emails) are stored once.
+// ============================================================================
+class SnapshotWriter {
+private:
+    std::vector<SnapshotItemRecord> records;
+    std::string strings;
+    std::unordered_map<std::string, SnapshotString> interned;
+    bool overflowed;            // The string table outgrew its 32-bit offsets
+
+    SnapshotString intern(const std::string& value) {
+        auto existing = interned.find(value);
+        if (existing != interned.end()) return existing->second;
+        if (value.size() > UINT32_MAX - strings.size()) {
+            overflowed = true;
+            return SnapshotString{0, 0};
+        }
+        SnapshotString ref = {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+        strings += value;
+        interned.emplace(value, ref);
+        return ref;
+    }
+
+public:
+    SnapshotWriter() : overflowed(false) {}
+
+    void add(const Item& item) {
+        SnapshotItemRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.id = intern(item.id);
+        record.name = intern(item.name);
+        record.color = intern(item.color);
+        record.location = intern(item.location);
+        record.owner = intern(item.owner);
+        record.email = intern(item.email);
+        record.type = intern(item.type);
+        record.description = intern(item.description);
+        record.claimedBy = intern(item.claimedBy);
+        record.timestamp = item.timestamp;
+        record.expiresAt = item.expiresAt;
+        record.claimedAt = item.claimedAt;
+        record.category = static_cast<uint8_t>(item.category);
+        record.archived = item.archived ? 1 : 0;
+        record.claimed = item.claimed ? 1 : 0;
+        records.push_back(record);
+    }
+
+    // The complete file; the writer is spent afterwards. False if the
+    // distinct strings add up to more than the table can address.
+    bool finish(const SnapshotMeta& meta, std::string& file) {
+        SnapshotHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.headerSize = sizeof(SnapshotHeader);
+        header.recordSize = sizeof(SnapshotItemRecord);
+        header.itemCount = records.size();
+        header.recordsOffset = sizeof(SnapshotHeader);
+        header.webhookUrl = intern(meta.webhookUrl);
+        header.claimWebhookUrl = intern(meta.claimWebhookUrl);
+        std::string cold;
+        ImageWriter out(cold);
+        out.u32(static_cast<uint32_t>(meta.coldTiers.size()));
+        for (const SnapshotColdTier& tier : meta.coldTiers) {
+            out.u64(tier.segment);
+            out.u32(static_cast<uint32_t>(tier.deleted.size()));
+            for (const std::string& id : tier.deleted) {
+                out.str(id);
+            }
+        }
+        header.cold = intern(cold);
+        header.stringsOffset = header.recordsOffset + records.size() * sizeof(SnapshotItemRecord);
+        header.stringsSize = strings.size();
+        header.itemCounter = meta.itemCounter;
+        header.logSegment = meta.logSegment;
+        header.generation = meta.generation;
+        if (overflowed) return false;
+
+        file.clear();
+        file.reserve(header.stringsOffset + strings.size());
+        file.append(sizeof(header), '\0');
+        file.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(SnapshotItemRecord));
+        file += strings;
+        header.bodyChecksum = crc32(file.data() + sizeof(header), file.size() - sizeof(header));
+        header.headerChecksum = crc32(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::memcpy(&file[0], &header, sizeof(header));
+        return true;
+    }
+};
+
+// ============================================================================
+// MAPPED FILE - Read-only view of a whole file
+// ============================================================================
+class MappedFile {
+private:
+    const char* base;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+public:
+    MappedFile() : base(nullptr), length(0) {
+#ifdef _WIN32
+        file = INVALID_HANDLE_VALUE;
+        mapping = nullptr;
+#endif
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view == nullptr) {
+            close();
+            return false;
+        }
+        base = static_cast<const char*>(view);
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);    // The mapping keeps the file open
+        if (view == MAP_FAILED) return false;
+        // Loading reads the records front to back
+        madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        base = static_cast<const char*>(view);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(const_cast<char*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+// ============================================================================
+// SNAPSHOT READER - Validates a mapped snapshot and hands out its items
+// ============================================================================
+class SnapshotReader {
+private:
+    MappedFile file;
+    SnapshotHeader header;
+    const char* strings;
+
+    bool validString(const SnapshotString& ref) const {
+        return static_cast<uint64_t>(ref.offset) + ref.length <= header.stringsSize;
+    }
+
+    std::string text(const SnapshotString& ref) const {
+        return std::string(strings + ref.offset, ref.length);
+    }
+
+    bool coldTiers(std::vector<SnapshotColdTier>& tiers) const {
+        tiers.clear();
+        ImageReader in(strings + header.cold.offset, header.cold.length);
+        uint32_t count = in.u32();
+        if (!in.has(count, 12)) return false;
+        tiers.resize(count);
+        for (SnapshotColdTier& tier : tiers) {
+            tier.segment = in.u64();
+            uint32_t deleted = in.u32();
+            if (!in.has(deleted, 4)) return false;
+            for (uint32_t i = 0; i < deleted; i++) {
+                tier.deleted.push_back(in.str());
+            }
+        }
+        return in.atEnd();
+    }
+
+public:
+    SnapshotReader() : strings(nullptr) {
+        std::memset(&header, 0, sizeof(header));
+    }
+
+    // False with error set if path is missing, damaged or in another format
+    bool open(const std::string& path, std::string& error) {
+        if (!file.open(path)) {
+            error = "cannot read " + path;
+            return false;
+        }
+        if (!hostIsLittleEndian()) {
+            error = "snapshots are only readable on little-endian hosts";
+            return false;
+        }
+        if (file.size() < sizeof(SnapshotHeader)) {
+            error = path + " is too short";
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        uint32_t checksum = header.headerChecksum;
+        header.headerChecksum = 0;
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+            crc32(reinterpret_cast<const char*>(&header), sizeof(header)) != checksum) {
+            error = path + " is not a snapshot or its header is damaged";
+            return false;
+        }
+        if (header.version != SNAPSHOT_VERSION || header.headerSize != sizeof(SnapshotHeader) ||
+            header.recordSize != sizeof(SnapshotItemRecord)) {
+            error = path + " has unsupported snapshot version " + std::to_string(header.version);
+            return false;
+        }
+        if (header.recordsOffset != sizeof(SnapshotHeader) ||
+            header.itemCount > (file.size() - header.recordsOffset) / sizeof(SnapshotItemRecord) ||
+            header.stringsOffset != header.recordsOffset + header.itemCount * sizeof(SnapshotItemRecord) ||
+            header.stringsOffset + header.stringsSize != file.size() ||
+            !validString(header.webhookUrl) || !validString(header.claimWebhookUrl) ||
+            !validString(header.cold)) {
+            error = path + " is truncated";
+            return false;
+        }
+        if (crc32(file.data() + sizeof(header), file.size() - sizeof(header)) != header.bodyChecksum) {
+            error = path + " is damaged (checksum mismatch)";
+            return false;
+        }
+        strings = file.data() + header.stringsOffset;
+        std::vector<SnapshotColdTier> tiers;
+        if (!coldTiers(tiers)) {
+            error = path + " has a damaged cold segment list";
+            return false;
+        }
+        return true;
+    }
+
+    size_t itemCount() const { return static_cast<size_t>(header.itemCount); }
+
+    SnapshotMeta meta() const {
+        SnapshotMeta meta;
+        meta.itemCounter = static_cast<int>(header.itemCounter);
+        meta.logSegment = header.logSegment;
+        meta.webhookUrl = text(header.webhookUrl);
+        meta.claimWebhookUrl = text(header.claimWebhookUrl);
+        meta.generation = header.generation;
+        coldTiers(meta.coldTiers);
+        return meta;
+    }
+
+    // Item index, or false if its record points outside the string table
+    bool item(size_t index, Item& item) const {
+        SnapshotItemRecord record;
+        std::memcpy(&record, file.data() + header.recordsOffset + index * sizeof(SnapshotItemRecord), sizeof(record));
+        const SnapshotString* refs[] = {&record.id, &record.name, &record.color, &record.location, &record.owner,
+                                        &record.email, &record.type, &record.description, &record.claimedBy};
+        for (const SnapshotString* ref : refs) {
+            if (!validString(*ref)) return false;
+        }
+        item.id = text(record.id);
+        item.name = text(record.name);
+        item.color = text(record.color);
+        item.location = text(record.location);
+        item.owner = text(record.owner);
+        item.email = text(record.email);
+        item.type = text(record.type);
+        item.description = text(record.description);
+        item.claimedBy = text(record.claimedBy);
+        item.timestamp = record.timestamp;
+        item.expiresAt = record.expiresAt;
+        item.claimedAt = record.claimedAt;
+        item.category = record.category <= static_cast<uint8_t>(Category::OTHER) ?
+                        static_cast<Category>(record.category) : Category::OTHER;
+        item.archived = record.archived != 0;
+        item.claimed = record.claimed != 0;
+        return true;
+    }
+};
+
+// ============================================================================
+// INDEX IMAGE - Saved indexes, so a restart can skip rebuilding them
+// Layout: [header][payload]. The payload is sections written by the
+// indexes themselves; the header says which snapshot generation the item
+// indexes match and which campus graph the location clusters came from,
+// so each part is used only while its source is unchanged.
+// ============================================================================
+static const char INDEX_IMAGE_MAGIC[8] = {'L', 'F', 'I', 'D', 'X', '\0', '\r', '\n'};
+static const uint32_t INDEX_IMAGE_VERSION = 1;
+
+struct IndexImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerChecksum;    // crc32 of the header with this field zeroed
+    uint64_t snapshotGeneration;
+    uint64_t graphFingerprint;
+    uint64_t payloadSize;
+    uint32_t payloadChecksum;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(IndexImageHeader) == 48, "index image header layout changed");
+
+inline std::string frameIndexImage(uint64_t snapshotGeneration, uint64_t graphFingerprint,
+                                   const std::string& payload) {
+    IndexImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, INDEX_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = INDEX_IMAGE_VERSION;
+    header.snapshotGeneration = snapshotGeneration;
+    header.graphFingerprint = graphFingerprint;
+    header.payloadSize = payload.size();
+    header.payloadChecksum = crc32(payload.data(), payload.size());
+    header.headerChecksum = crc32(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::string file;
+    file.reserve(sizeof(header) + payload.size());
+    file.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    file += payload;
+    return file;
+}
+
+class IndexImageReader {
+private:
+    MappedFile file;
+    IndexImageHeader header;
+
+public:
+    IndexImageReader() {
+        std::memset(&header, 0, sizeof(header));
+    }
+
+    // False if path is missing, damaged or in another format; the caller
+    // rebuilds then, so there is no error to report
+    bool open(const std::string& path) {
+        if (!file.open(path) || !hostIsLittleEndian() || file.size() < sizeof(IndexImageHeader)) return false;
+        std::memcpy(&header, file.data(), sizeof(header));
+        uint32_t checksum = header.headerChecksum;
+        header.headerChecksum = 0;
+        return std::memcmp(header.magic, INDEX_IMAGE_MAGIC, sizeof(header.magic)) == 0 &&
+               crc32(reinterpret_cast<const char*>(&header), sizeof(header)) == checksum &&
+               header.version == INDEX_IMAGE_VERSION &&
+               header.payloadSize == file.size() - sizeof(header) &&
+               crc32(file.data() + sizeof(header), static_cast<size_t>(header.payloadSize)) == header.payloadChecksum;
+    }
+
+    uint64_t snapshotGeneration() const { return header.snapshotGeneration; }
+    uint64_t graphFingerprint() const { return header.graphFingerprint; }
+
+    ImageReader payload() const {
+        return ImageReader(file.data() + sizeof(header), static_cast<size_t>(header.payloadSize));
+    }
+};
+
+#endif // SNAPSHOT_H
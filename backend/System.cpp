@@ -3,174 +3,824 @@
 //
 
 #include "System.h"
+#include "JsonStream.h"
+#include "ItemCodec.h"
 #include <fstream>
 #include <sstream>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <csignal>
 
-// Simple JSON-like save format (manual parsing to avoid external dependencies)
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Same JSON that loadFromFile() reads, written a buffer at a time
 bool LostFoundSystem::saveToFile(const std::string& filename) {
-    std::ofstream file(filename);
+    std::lock_guard<std::mutex> saveLock(saveMutex);
+    std::ofstream file(filename, std::ios::binary);
     if (!file.is_open()) return false;
     
     std::vector<Item> items = getAllItems();
     
-    file << "{\n";
-    file << "  \"itemCounter\": " << itemCounter << ",\n";
-    file << "  \"webhookUrl\": \"" << webhookUrl << "\",\n";
-    file << "  \"claimWebhookUrl\": \"" << claimWebhookUrl << "\",\n";
-    file << "  \"items\": [\n";
-    
-    for (size_t i = 0; i < items.size(); i++) {
-        const auto& item = items[i];
-        file << "    {\n";
-        file << "      \"id\": \"" << item.id << "\",\n";
-        file << "      \"name\": \"" << item.name << "\",\n";
-        file << "      \"color\": \"" << item.color << "\",\n";
-        file << "      \"location\": \"" << item.location << "\",\n";
-        file << "      \"owner\": \"" << item.owner << "\",\n";
-        file << "      \"email\": \"" << item.email << "\",\n";
-        file << "      \"type\": \"" << item.type << "\",\n";
-        file << "      \"timestamp\": " << item.timestamp << ",\n";
-        file << "      \"description\": \"" << item.description << "\",\n";
-        file << "      \"category\": \"" << categoryToString(item.category) << "\",\n";
-        file << "      \"archived\": " << (item.archived ? "true" : "false") << ",\n";
-        file << "      \"expiresAt\": " << item.expiresAt << ",\n";
-        file << "      \"claimed\": " << (item.claimed ? "true" : "false") << ",\n";
-        file << "      \"claimedBy\": \"" << item.claimedBy << "\",\n";
-        file << "      \"claimedAt\": " << item.claimedAt << "\n";
-        file << "    }";
-        if (i < items.size() - 1) file << ",";
-        file << "\n";
-    }
-    
-    file << "  ]\n";
-    file << "}\n";
+    std::string buffer;
+    JsonWriter json(buffer, 2);
+    json.beginObject();
+    json.member("itemCounter", static_cast<int>(itemCounter));
+    json.member("webhookUrl", getWebhookUrl());
+    json.member("claimWebhookUrl", getClaimWebhookUrl());
+    json.key("items");
+    json.beginArray();
+    for (const Item& item : items) {
+        writeJsonObject(json, item, FIELD_STORED);
+        if (buffer.size() >= 64 * 1024) {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    json.endArray();
+    json.endObject();
+    buffer += '\n';
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
     
     file.close();
     return true;
 }
 
-// Helper function to extract string value from JSON-like format
-std::string extractJsonString(const std::string& line, const std::string& key) {
-    size_t keyPos = line.find("\"" + key + "\"");
-    if (keyPos == std::string::npos) return "";
-    
-    size_t colonPos = line.find(":", keyPos);
-    if (colonPos == std::string::npos) return "";
-    
-    size_t startQuote = line.find("\"", colonPos);
-    if (startQuote == std::string::npos) return "";
+// Streams the file once, so the text is never held in memory whole. A
+// syntax error keeps what was read before it and returns false.
+bool LostFoundSystem::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
     
-    size_t endQuote = line.find("\"", startQuote + 1);
-    if (endQuote == std::string::npos) return "";
+    JsonStreamReader json(file);
+    std::vector<Item> items;
+    bool ok = json.next() == JsonToken::BEGIN_OBJECT;
+    JsonToken token = JsonToken::ERROR;
+    while (ok && (token = json.next()) == JsonToken::KEY) {
+        std::string key = json.text();
+        JsonToken value = json.next();
+        if (key == "itemCounter" && value == JsonToken::NUMBER) {
+            itemCounter = static_cast<int>(json.number());
+        } else if (key == "webhookUrl" && value == JsonToken::STRING) {
+            setWebhookUrl(json.text());
+        } else if (key == "claimWebhookUrl" && value == JsonToken::STRING) {
+            setClaimWebhookUrl(json.text());
+        } else if (key == "items" && value == JsonToken::BEGIN_ARRAY) {
+            JsonToken element;
+            while (ok && (element = json.next()) == JsonToken::BEGIN_OBJECT) {
+                Item item;
+                ok = readJsonObject(json, item, FIELD_STORED);
+                
+                // If expiresAt not set (old data), calculate it
+                if (item.expiresAt == 0 && item.timestamp > 0) {
+                    item.expiresAt = item.timestamp + (EXPIRATION_DAYS * 24 * 60 * 60);
+                }
+                if (ok && !item.id.empty()) {
+                    items.push_back(std::move(item));
+                }
+            }
+            ok = ok && element == JsonToken::END_ARRAY;
+        } else {
+            ok = json.skip(value) != JsonToken::ERROR;
+        }
+    }
+    ok = ok && token == JsonToken::END_OBJECT && json.next() == JsonToken::END;
     
-    return line.substr(startQuote + 1, endQuote - startQuote - 1);
+    bulkLoad(items, {});
+    bumpGeneration();
+    if (!ok) {
+        std::cerr << filename << ": " << (json.error().empty() ? "unexpected structure" : json.error())
+                  << "; loaded " << getTotalItems() << " items before it" << std::endl;
+    }
+    return ok;
 }
 
-long long extractJsonLong(const std::string& line, const std::string& key) {
-    size_t keyPos = line.find("\"" + key + "\"");
-    if (keyPos == std::string::npos) return 0;
+// The order items were reported in: by time, then by id, which counts up
+static bool reportedBefore(const Item* a, const Item* b) {
+    if (a->timestamp != b->timestamp) return a->timestamp < b->timestamp;
+    if (a->id.size() != b->id.size()) return a->id.size() < b->id.size();
+    return a->id < b->id;
+}
+
+void LostFoundSystem::bulkLoad(std::vector<Item>& items, const std::vector<Item>& coldItems, bool buildIndexes) {
+    if (countItems([](const Item&) { return true; }) > 0 || !history.load()->empty()) {
+        storeItems(items);
+        appendHistory(coldItems);
+        std::unique_lock<std::shared_mutex> trieLock(trieMutex);
+        std::unique_lock<std::shared_mutex> triesLock(categoryTrieMutex);
+        for (const Item& item : coldItems) {
+            searchTrie.insert(item.name, item.timestamp);
+            categoryTries.insert(item.name, item.category, item.timestamp);
+        }
+        return;
+    }
+    
+    std::vector<const Item*> loaded;
+    loaded.reserve(items.size());
+    for (Item& item : items) {
+        loaded.push_back(new Item(std::move(item)));
+    }
+    items.clear();
     
-    size_t colonPos = line.find(":", keyPos);
-    if (colonPos == std::string::npos) return 0;
+    // The builders only read the loaded items; ones replaced by a later copy
+    // with the same id are freed after they have all finished
+    std::vector<const Item*> replaced;
+    std::vector<std::thread> builders;
     
-    std::string numStr;
-    for (size_t i = colonPos + 1; i < line.length(); i++) {
-        char c = line[i];
-        if (isdigit(c) || c == '-') {
-            numStr += c;
-        } else if (!numStr.empty()) {
-            break;
+    builders.emplace_back([this, &loaded, &coldItems] {
+        std::vector<const Item*> entries;
+        entries.reserve(loaded.size() + coldItems.size());
+        for (const Item* item : loaded) {
+            entries.push_back(new Item(*item));
         }
+        for (const Item& item : coldItems) {
+            entries.push_back(new Item(item));
+        }
+        // Equal timestamps in report order, as upper_bound inserts leave them
+        std::sort(entries.begin(), entries.end(), reportedBefore);
+        ItemList* timeline = new ItemList();
+        for (const Item* entry : entries) {
+            timeline->push_back(entry);
+        }
+        std::lock_guard<std::mutex> lock(historyWriteMutex);
+        replaceVersion(history, history.load(), timeline, {});
+    });
+    if (buildIndexes) {
+        // Each trie builder lists the reports itself, so neither waits on the
+        // other. In report order, as insert() saw them: a name keeps its
+        // latest spelling and its rank sums up the same way, so the tries
+        // match ones built report by report or loaded from an image.
+        auto nameReports = [&loaded, &coldItems] {
+            std::vector<const Item*> reported(loaded.begin(), loaded.end());
+            for (const Item& item : coldItems) {
+                reported.push_back(&item);
+            }
+            std::sort(reported.begin(), reported.end(), reportedBefore);
+            std::vector<NameReport> reports;
+            reports.reserve(reported.size());
+            for (const Item* item : reported) {
+                reports.push_back(NameReport{&item->name, item->timestamp, item->category});
+            }
+            return reports;
+        };
+        builders.emplace_back([this, nameReports] {
+            std::vector<NameReport> reports = nameReports();
+            std::unique_lock<std::shared_mutex> lock(trieMutex);
+            searchTrie.insertAll(reports);
+        });
+        builders.emplace_back([this, nameReports] {
+            std::vector<NameReport> reports = nameReports();
+            std::unique_lock<std::shared_mutex> lock(categoryTrieMutex);
+            categoryTries.insertAll(reports);
+        });
+        builders.emplace_back([this, &loaded] {
+            std::unique_lock<std::shared_mutex> lock(indexMutex);
+            invertedIndex.indexItems(loaded);
+        });
     }
     
-    return numStr.empty() ? 0 : std::stoll(numStr);
+    // The store itself on this thread: sort each shard by id, last copy of an id wins
+    std::vector<std::vector<const Item*>> byShard(ITEM_SHARD_COUNT);
+    for (const Item* item : loaded) {
+        byShard[&shardFor(item->id) - itemShards].push_back(item);
+    }
+    for (size_t i = 0; i < ITEM_SHARD_COUNT; i++) {
+        std::vector<const Item*>& list = byShard[i];
+        std::stable_sort(list.begin(), list.end(),
+            [](const Item* a, const Item* b) { return a->id < b->id; });
+        ItemList* next = new ItemList();
+        for (size_t j = 0; j < list.size(); j++) {
+            if (j + 1 < list.size() && list[j + 1]->id == list[j]->id) {
+                replaced.push_back(list[j]);
+            } else {
+                next->push_back(list[j]);
+            }
+        }
+        std::lock_guard<std::mutex> lock(itemShards[i].writeMutex);
+        replaceVersion(itemShards[i].items, itemShards[i].items.load(), next, {});
+    }
+    
+    for (std::thread& builder : builders) {
+        builder.join();
+    }
+    for (const Item* item : replaced) {
+        delete item;
+    }
+}
+
+SnapshotMeta LostFoundSystem::snapshotMeta(uint64_t logSegment) {
+    SnapshotMeta meta;
+    meta.itemCounter = itemCounter;
+    meta.logSegment = logSegment;
+    meta.webhookUrl = getWebhookUrl();
+    meta.claimWebhookUrl = getClaimWebhookUrl();
+    meta.generation = newSnapshotGeneration();
+    return meta;
 }
 
-int extractJsonInt(const std::string& line, const std::string& key) {
-    return static_cast<int>(extractJsonLong(line, key));
+bool LostFoundSystem::encodeSnapshot(SnapshotMeta meta, const ColdArchive& archive, const StoreView& view,
+                                     std::string& file) {
+    meta.coldTiers.clear();
+    for (const ColdArchive::Tier& tier : archive.getTiers()) {
+        meta.coldTiers.push_back({tier.segment->getNumber(),
+                                  std::vector<std::string>(tier.deleted.begin(), tier.deleted.end())});
+    }
+    SnapshotWriter writer;
+    for (const ItemList* shard : view.shards) {
+        for (const Item* item : *shard) {
+            writer.add(*item);
+        }
+    }
+    return writer.finish(meta, file);
 }
 
-bool extractJsonBool(const std::string& line, const std::string& key) {
-    size_t keyPos = line.find("\"" + key + "\"");
-    if (keyPos == std::string::npos) return false;
+static std::string coldSegmentPath(const std::string& snapshotPath, uint64_t number) {
+    return snapshotPath + ".cold." + std::to_string(number);
+}
+
+static std::string indexImagePath(const std::string& snapshotPath) {
+    return snapshotPath + ".idx";
+}
+
+// Sections: location clusters, then the search trie, category tries and
+// inverted index, each readable on its own
+std::string LostFoundSystem::encodeIndexImage(uint64_t snapshotGeneration, bool takeLocks) {
+    std::string payload;
+    ImageWriter out(payload);
+    size_t section = out.beginSection();
+    {
+        std::unique_lock<std::mutex> lock(clusterMutex, std::defer_lock);
+        if (takeLocks) lock.lock();
+        ensureClusters();
+        locationCluster.save(out);
+    }
+    out.endSection(section);
+    section = out.beginSection();
+    {
+        std::shared_lock<std::shared_mutex> lock(trieMutex, std::defer_lock);
+        if (takeLocks) lock.lock();
+        searchTrie.save(out);
+    }
+    out.endSection(section);
+    section = out.beginSection();
+    {
+        std::shared_lock<std::shared_mutex> lock(categoryTrieMutex, std::defer_lock);
+        if (takeLocks) lock.lock();
+        categoryTries.save(out);
+    }
+    out.endSection(section);
+    section = out.beginSection();
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMutex, std::defer_lock);
+        if (takeLocks) lock.lock();
+        invertedIndex.save(out);
+    }
+    out.endSection(section);
+    return frameIndexImage(snapshotGeneration, campusGraph.fingerprint(), payload);
+}
+
+bool LostFoundSystem::loadIndexImage(const std::string& path, uint64_t snapshotGeneration) {
+    IndexImageReader image;
+    if (!image.open(path)) return false;
+    ImageReader payload = image.payload();
+    ImageReader clusters = payload.section();
+    ImageReader trie = payload.section();
+    ImageReader tries = payload.section();
+    ImageReader index = payload.section();
+    if (!payload.atEnd()) return false;
     
-    size_t colonPos = line.find(":", keyPos);
-    if (colonPos == std::string::npos) return false;
+    if (image.graphFingerprint() == campusGraph.fingerprint()) {
+        std::lock_guard<std::mutex> lock(clusterMutex);
+        clustersBuilt = locationCluster.load(clusters);
+    }
+    if (snapshotGeneration == 0 || image.snapshotGeneration() != snapshotGeneration) return false;
     
-    std::string rest = line.substr(colonPos + 1);
-    // Trim whitespace
-    size_t start = rest.find_first_not_of(" \t");
-    if (start != std::string::npos) {
-        rest = rest.substr(start);
+    // One thread per index, as bulkLoad() builds them
+    bool trieLoaded = false, triesLoaded = false, indexLoaded = false;
+    std::thread trieLoader([&] {
+        std::unique_lock<std::shared_mutex> lock(trieMutex);
+        trieLoaded = searchTrie.load(trie) && trie.atEnd();
+    });
+    std::thread triesLoader([&] {
+        std::unique_lock<std::shared_mutex> lock(categoryTrieMutex);
+        triesLoaded = categoryTries.load(tries) && tries.atEnd();
+    });
+    {
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        indexLoaded = invertedIndex.load(index) && index.atEnd();
     }
+    trieLoader.join();
+    triesLoader.join();
+    if (trieLoaded && triesLoaded && indexLoaded) return true;
     
-    return rest.find("true") == 0;
+    searchTrie.clear();
+    categoryTries.clear();
+    invertedIndex.clear();
+    return false;
 }
 
-bool LostFoundSystem::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) return false;
+bool LostFoundSystem::loadSnapshot(const std::string& filename, std::string& error) {
+    SnapshotReader reader;
+    if (!reader.open(filename, error)) return false;
     
-    std::string content((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
-    file.close();
+    std::vector<Item> items(reader.itemCount());
+    for (size_t i = 0; i < items.size(); i++) {
+        if (!reader.item(i, items[i])) {
+            error = filename + ": item " + std::to_string(i) + " is damaged";
+            return false;
+        }
+    }
+    
+    SnapshotMeta meta = reader.meta();
+    itemCounter = meta.itemCounter;
+    snapshotSegment = meta.logSegment;
+    setWebhookUrl(meta.webhookUrl);
+    setClaimWebhookUrl(meta.claimWebhookUrl);
+    
+    // The image replaces the item indexes wholesale, so only into an empty system
+    bool empty = countItems([](const Item&) { return true; }) == 0 && history.load()->empty();
     
-    // Parse itemCounter
-    itemCounter = extractJsonInt(content, "itemCounter");
+    // Cold items are in the history and tries as they were before tiering,
+    // though not in the store or inverted index
+    std::shared_ptr<ColdArchive> archive = std::make_shared<ColdArchive>(*coldArchive());
+    std::vector<Item> coldItems;
+    for (const SnapshotColdTier& tier : meta.coldTiers) {
+        std::shared_ptr<ColdSegment> segment = std::make_shared<ColdSegment>();
+        if (!segment->open(coldSegmentPath(filename, tier.segment), tier.segment, error)) return false;
+        ColdArchive::Tier opened{segment, std::unordered_set<std::string>(tier.deleted.begin(), tier.deleted.end())};
+        if (!segment->forEach([&](const Item& item) {
+                if (opened.deleted.count(item.id) == 0) coldItems.push_back(item);
+            })) {
+            std::cerr << "Cold segment " << tier.segment << " is damaged; its readable items are kept" << std::endl;
+        }
+        archive->add(std::move(opened));
+        nextColdSegment = std::max(nextColdSegment, tier.segment + 1);
+    }
+    indexesLoaded = loadIndexImage(indexImagePath(filename), empty ? meta.generation : 0);
+    bulkLoad(items, coldItems, !indexesLoaded);
+    {
+        std::unique_lock<std::shared_mutex> lock(coldMutex);
+        cold = archive;
+    }
+    bumpGeneration();
+    return true;
+}
+
+// ============================================================================
+// WRITE-AHEAD LOG RECORDS
+// One opcode byte, then fields: strings as u32 length + bytes, numbers as
+// little-endian i64. Records carry whole items, so replaying one that the
+// snapshot already includes leaves the same state.
+//   'I' item counter   - item reported (stored again: replaced)
+//   'U' item           - item changed in place (claim, archive)
+//   'D' id             - item deleted
+//   'W' url / 'C' url  - match / claim webhook set
+// ============================================================================
+
+static void putLogString(std::string& out, const std::string& value) {
+    uint32_t length = static_cast<uint32_t>(value.size());
+    for (int i = 0; i < 4; i++) out += static_cast<char>((length >> (8 * i)) & 0xFF);
+    out += value;
+}
+
+static void putLogNumber(std::string& out, long long value) {
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; i++) out += static_cast<char>((bits >> (8 * i)) & 0xFF);
+}
+
+// Reads fields in order; ok turns false once the record runs short
+struct LogRecordReader {
+    const std::string& record;
+    size_t pos;
+    bool ok;
     
-    // Parse webhookUrl
-    webhookUrl = extractJsonString(content, "webhookUrl");
+    explicit LogRecordReader(const std::string& data) : record(data), pos(1), ok(true) {}
     
-    // Parse claimWebhookUrl
-    claimWebhookUrl = extractJsonString(content, "claimWebhookUrl");
+    long long number() {
+        if (!ok || pos + 8 > record.size()) {
+            ok = false;
+            return 0;
+        }
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; i++) bits |= static_cast<uint64_t>(static_cast<uint8_t>(record[pos + i])) << (8 * i);
+        pos += 8;
+        return static_cast<long long>(bits);
+    }
     
-    // Parse items
-    size_t itemsStart = content.find("\"items\"");
-    if (itemsStart == std::string::npos) return true; // No items yet
+    std::string string() {
+        if (!ok || pos + 4 > record.size()) {
+            ok = false;
+            return "";
+        }
+        uint32_t length = 0;
+        for (int i = 0; i < 4; i++) length |= static_cast<uint32_t>(static_cast<uint8_t>(record[pos + i])) << (8 * i);
+        pos += 4;
+        if (length > record.size() - pos) {
+            ok = false;
+            return "";
+        }
+        std::string value = record.substr(pos, length);
+        pos += length;
+        return value;
+    }
     
-    size_t pos = content.find("{", itemsStart);
-    while (pos != std::string::npos && pos < content.length()) {
-        size_t itemEnd = content.find("}", pos);
-        if (itemEnd == std::string::npos) break;
-        
-        std::string itemBlock = content.substr(pos, itemEnd - pos + 1);
-        
+    Item item() {
         Item item;
-        item.id = extractJsonString(itemBlock, "id");
-        item.name = extractJsonString(itemBlock, "name");
-        item.color = extractJsonString(itemBlock, "color");
-        item.location = extractJsonString(itemBlock, "location");
-        item.owner = extractJsonString(itemBlock, "owner");
-        item.email = extractJsonString(itemBlock, "email");
-        item.type = extractJsonString(itemBlock, "type");
-        item.timestamp = extractJsonLong(itemBlock, "timestamp");
-        item.description = extractJsonString(itemBlock, "description");
-        
-        // New fields
-        std::string catStr = extractJsonString(itemBlock, "category");
-        item.category = catStr.empty() ? Category::OTHER : stringToCategory(catStr);
-        item.archived = extractJsonBool(itemBlock, "archived");
-        item.archived = extractJsonBool(itemBlock, "archived");
-        item.expiresAt = extractJsonLong(itemBlock, "expiresAt");
-        item.claimed = extractJsonBool(itemBlock, "claimed");
-        item.claimedBy = extractJsonString(itemBlock, "claimedBy");
-        item.claimedAt = extractJsonLong(itemBlock, "claimedAt");
-        
-        // If expiresAt not set (old data), calculate it
-        if (item.expiresAt == 0 && item.timestamp > 0) {
-            item.expiresAt = item.timestamp + (EXPIRATION_DAYS * 24 * 60 * 60);
+        item.id = string();
+        item.name = string();
+        item.color = string();
+        item.location = string();
+        item.owner = string();
+        item.email = string();
+        item.type = string();
+        item.timestamp = number();
+        item.description = string();
+        item.category = static_cast<Category>(number());
+        item.archived = number() != 0;
+        item.expiresAt = number();
+        item.claimed = number() != 0;
+        item.claimedBy = string();
+        item.claimedAt = number();
+        return item;
+    }
+};
+
+std::string LostFoundSystem::itemRecord(char op, const Item& item, int counter) {
+    std::string record(1, op);
+    putLogString(record, item.id);
+    putLogString(record, item.name);
+    putLogString(record, item.color);
+    putLogString(record, item.location);
+    putLogString(record, item.owner);
+    putLogString(record, item.email);
+    putLogString(record, item.type);
+    putLogNumber(record, item.timestamp);
+    putLogString(record, item.description);
+    putLogNumber(record, static_cast<long long>(item.category));
+    putLogNumber(record, item.archived ? 1 : 0);
+    putLogNumber(record, item.expiresAt);
+    putLogNumber(record, item.claimed ? 1 : 0);
+    putLogString(record, item.claimedBy);
+    putLogNumber(record, item.claimedAt);
+    if (op == 'I') putLogNumber(record, counter);
+    return record;
+}
+
+std::string LostFoundSystem::deleteRecord(const std::string& id) {
+    std::string record(1, 'D');
+    putLogString(record, id);
+    return record;
+}
+
+std::string LostFoundSystem::configRecord(char op, const std::string& value) {
+    std::string record(1, op);
+    putLogString(record, value);
+    return record;
+}
+
+// Runs before the log is opened, so nothing applied here is logged again
+void LostFoundSystem::applyLogRecord(const std::string& record) {
+    if (record.empty()) return;
+    LogRecordReader reader(record);
+    switch (record[0]) {
+        case 'I': {
+            Item item = reader.item();
+            int counter = static_cast<int>(reader.number());
+            if (!reader.ok || item.id.empty()) return;
+            Item existing;
+            if (getItemById(item.id, existing)) {
+                updateItem(item.id, [&item](Item& stored) { stored = item; });
+            } else {
+                storeItems({item});
+            }
+            if (counter > itemCounter) itemCounter = counter;
+            break;
         }
-        
-        if (!item.id.empty()) {
-            itemMap.insert(item.id, item);
-            searchTrie.insert(item.name);
-            historyBST.insert(item);
-            invertedIndex.indexItem(item);
-            categoryTries.insert(item.name, item.category);
+        case 'U': {
+            Item item = reader.item();
+            if (!reader.ok) return;
+            updateItem(item.id, [&item](Item& stored) { stored = item; });
+            break;
+        }
+        case 'D': {
+            std::string id = reader.string();
+            if (reader.ok) deleteItem(id);
+            break;
+        }
+        case 'W':
+        case 'C': {
+            std::string url = reader.string();
+            if (!reader.ok) return;
+            if (record[0] == 'W') setWebhookUrl(url);
+            else setClaimWebhookUrl(url);
+            break;
+        }
+    }
+}
+
+long long LostFoundSystem::openLog(const std::string& dataPath, const WalOptions& options, std::string& error) {
+    dataFile = dataPath;
+    std::string base = dataPath + ".wal";
+    uint64_t first = std::max<uint64_t>(snapshotSegment, 1);
+    uint64_t last = 0;
+    size_t records = 0;
+    
+    if (!WriteAheadLog::replay(base, first, [this](const std::string& record) { applyLogRecord(record); },
+                               last, records, error)) {
+        return -1;
+    }
+    uint64_t current = std::max(last, first);
+    if (!wal.open(base, current, options)) {
+        error = "cannot open " + WriteAheadLog::segmentPath(base, current);
+        return -1;
+    }
+    if (records > 0) bumpGeneration();
+    return static_cast<long long>(records);
+}
+
+uint64_t LostFoundSystem::rotateForCheckpoint() {
+    // Every record in the older segments is from a mutation that holds the
+    // gate until it is done, so the snapshot and image, taken under the gate
+    // after this, include it. Records landing in the new segment meanwhile
+    // may be in both too; replaying one finds its item stored and indexed.
+    return wal.rotate();
+}
+
+void LostFoundSystem::tierArchivedItems() {
+    StoreView view(*this);      // Keeps the items being moved alive
+    std::vector<std::vector<const Item*>> moving(ITEM_SHARD_COUNT);
+    size_t movingCount = 0, tooLong = 0;
+    for (size_t i = 0; i < ITEM_SHARD_COUNT; i++) {
+        for (const Item* item : *view.shards[i]) {
+            if (!item->archived) continue;
+            if (item->id.size() > COLD_MAX_ID_LENGTH) {
+                tooLong++;
+            } else {
+                moving[i].push_back(item);
+            }
+        }
+        movingCount += moving[i].size();
+    }
+    if (tooLong > 0) {
+        std::cerr << tooLong << " archived item(s) have ids over " << COLD_MAX_ID_LENGTH
+                  << " bytes; keeping them in memory" << std::endl;
+    }
+    
+    // Only checkpoints change the tiers, so these positions stay valid;
+    // deletes meanwhile only add tombstones
+    std::shared_ptr<const ColdArchive> before = coldArchive();
+    if (movingCount == 0 && before->tombstones() == 0) return;
+    std::vector<size_t> plan = before->compactionPlan(MAX_COLD_SEGMENTS);
+    
+    std::vector<Item> carried;
+    for (size_t position : plan) {
+        const ColdArchive::Tier& tier = before->getTiers()[position];
+        // A damaged block can't be carried over; its segment is kept instead
+        if (!tier.segment->forEach([&](const Item& item) {
+                if (tier.deleted.count(item.id) == 0) carried.push_back(item);
+            })) {
+            std::cerr << "Cold segment " << tier.segment->getNumber() << " is damaged; not compacting" << std::endl;
+            return;
+        }
+    }
+    std::vector<const Item*> items;
+    items.reserve(movingCount + carried.size());
+    for (const auto& shard : moving) {
+        items.insert(items.end(), shard.begin(), shard.end());
+    }
+    for (const Item& item : carried) {
+        items.push_back(&item);
+    }
+    std::sort(items.begin(), items.end(), [](const Item* a, const Item* b) { return a->id < b->id; });
+    
+    ColdArchive::Tier merged;
+    if (!items.empty()) {
+        uint64_t number = nextColdSegment++;
+        std::string path = coldSegmentPath(dataFile, number);
+        std::string error;
+        std::shared_ptr<ColdSegment> segment = std::make_shared<ColdSegment>();
+        if (!writeFileDurably(path, ColdSegment::encode(items)) || !segment->open(path, number, error)) {
+            std::cerr << "Cannot write cold segment " << path << (error.empty() ? "" : ": " + error) << std::endl;
+            std::remove(path.c_str());
+            return;
+        }
+        merged.segment = segment;
+    }
+    
+    // Swap the tiers over with no mutation in flight, so the indexes and
+    // both tiers change together
+    std::vector<Item> moved;
+    {
+        std::unique_lock<UpdateGate> gate(indexUpdateGate);
+        std::unique_lock<std::shared_mutex> lock(coldMutex);
+        for (size_t position : plan) {
+            const ColdArchive::Tier& was = before->getTiers()[position];
+            for (const std::string& id : cold->getTiers()[position].deleted) {
+                if (was.deleted.count(id) == 0) merged.deleted.insert(id);
+            }
         }
+        // An item changed since it was collected stays in its shard, and its
+        // copy in the segment is dead from the start
+        for (size_t i = 0; i < ITEM_SHARD_COUNT; i++) {
+            if (moving[i].empty()) continue;
+            editShard(itemShards[i], [&](ShardEdit& change) {
+                for (const Item* item : moving[i]) {
+                    auto at = change.items.lowerBound(item->id, idLess);
+                    if (at != change.items.end() && *at == item) {
+                        moved.push_back(*item);
+                        change.dropped.push_back(item);
+                        change.items.erase(at);
+                    } else {
+                        merged.deleted.insert(item->id);
+                    }
+                }
+                return !change.dropped.empty();
+            });
+        }
+        std::shared_ptr<ColdArchive> next = std::make_shared<ColdArchive>(*cold);
+        next->replace(plan, std::move(merged));
+        cold = next;
         
-        pos = content.find("{", itemEnd);
+        std::unique_lock<std::shared_mutex> indexLock(indexMutex);
+        for (const Item& item : moved) {
+            invertedIndex.removeItem(item);
+        }
+    }
+    for (size_t position : plan) {
+        retiredColdFiles.push_back(coldSegmentPath(dataFile, before->getTiers()[position].segment->getNumber()));
+    }
+}
+
+void LostFoundSystem::removeRetiredColdFiles() {
+    for (const std::string& path : retiredColdFiles) {
+        std::remove(path.c_str());
+    }
+    retiredColdFiles.clear();
+}
+
+bool LostFoundSystem::writeCheckpoint(const SnapshotMeta& meta, bool takeLocks) {
+    // The image must index exactly the items the snapshot holds: an item
+    // stored but not yet indexed would be loaded with the image and never
+    // indexed, since replaying its record finds it already stored. So the
+    // store, the cold tiers and the indexes are all read with the gate held,
+    // and only the snapshot, from its immutable view, is encoded after.
+    // Without takeLocks this is a child forked under the gate.
+    std::unique_lock<UpdateGate> gate(indexUpdateGate, std::defer_lock);
+    std::shared_lock<std::shared_mutex> coldLock(coldMutex, std::defer_lock);
+    if (takeLocks) {
+        gate.lock();
+        coldLock.lock();
     }
+    std::shared_ptr<const ColdArchive> archive = cold;
+    StoreView view(*this);
+    if (coldLock.owns_lock()) coldLock.unlock();
+    std::string image = encodeIndexImage(meta.generation, takeLocks);
+    if (gate.owns_lock()) gate.unlock();
     
+    std::string snapshot;
+    if (!encodeSnapshot(meta, *archive, view, snapshot)) {
+        std::cerr << "Cannot write snapshot: its strings exceed the 4 GiB string table" << std::endl;
+        return false;
+    }
+    if (!writeFileDurably(dataFile, snapshot)) return false;
+    // Only saves the next start a rebuild: if this write fails, the image
+    // left behind names an older generation and is ignored
+    writeFileDurably(indexImagePath(dataFile), image);
     return true;
 }
+
+void LostFoundSystem::recordCheckpoint(bool ok, std::chrono::steady_clock::time_point started,
+                                       bool forked, double forkMs, uint64_t cowBytes) {
+    std::lock_guard<std::mutex> lock(checkpointStatsMutex);
+    if (ok) {
+        checkpointStats.completed++;
+        checkpointStats.lastCompletedAt = static_cast<long long>(std::time(nullptr));
+    } else {
+        checkpointStats.failed++;
+    }
+    checkpointStats.lastForked = forked;
+    checkpointStats.lastDurationMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    checkpointStats.lastForkMs = forkMs;
+    checkpointStats.lastCowBytes = cowBytes;
+    checkpointRunning = false;
+}
+
+bool LostFoundSystem::checkpoint() {
+    std::lock_guard<std::mutex> saveLock(saveMutex);
+    if (!logging()) return false;
+    auto started = std::chrono::steady_clock::now();
+    checkpointRunning = true;
+    
+    uint64_t segment = rotateForCheckpoint();
+    tierArchivedItems();
+    bool ok = writeCheckpoint(snapshotMeta(segment), true);
+    if (ok) {
+        wal.removeBefore(segment);
+        removeRetiredColdFiles();
+    }
+    recordCheckpoint(ok, started, false, 0, 0);
+    return ok;
+}
+
+#ifdef _WIN32
+bool LostFoundSystem::backgroundCheckpoint() {
+    return checkpoint();
+}
+#else
+// Memory the calling process no longer shares with its parent: pages it
+// wrote itself and pages the parent has since copied away from it
+static uint64_t privateDirtyBytes() {
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(smaps, line)) {
+        if (line.rfind("Private_Dirty:", 0) == 0) {
+            return std::strtoull(line.c_str() + 14, nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+
+bool LostFoundSystem::backgroundCheckpoint() {
+    std::lock_guard<std::mutex> saveLock(saveMutex);
+    if (!logging()) return false;
+    auto started = std::chrono::steady_clock::now();
+    checkpointRunning = true;
+    
+    uint64_t segment = rotateForCheckpoint();
+    tierArchivedItems();
+    SnapshotMeta meta = snapshotMeta(segment);
+    int report[2];
+    if (pipe(report) != 0) {
+        recordCheckpoint(false, started, true, 0, 0);
+        return false;
+    }
+    
+    pid_t child;
+    double forkMs;
+    {
+        // The child reads the indexes and cold tiers without locking, so no
+        // writer may be partway through one, or between its store and index
+        // updates, when its copy of memory is taken; writers wait for the
+        // fork() itself and no longer
+        std::unique_lock<UpdateGate> gate(indexUpdateGate);
+        std::lock_guard<std::mutex> clusterLock(clusterMutex);
+        ensureClusters();
+        std::shared_lock<std::shared_mutex> trieLock(trieMutex);
+        std::shared_lock<std::shared_mutex> categoryLock(categoryTrieMutex);
+        std::shared_lock<std::shared_mutex> indexLock(indexMutex);
+        std::shared_lock<std::shared_mutex> coldLock(coldMutex);
+        auto forking = std::chrono::steady_clock::now();
+        child = fork();
+        forkMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - forking).count();
+    }
+    
+    if (child == 0) {
+        // Only this thread exists here, and the locks above stay held by the
+        // parent's copy of it: nothing below may take one. Signals meant
+        // for the server must not run its shutdown handler in the child.
+        close(report[0]);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        bool ok = writeCheckpoint(meta, false);
+        uint64_t cowBytes = privateDirtyBytes();
+        ssize_t written = write(report[1], &cowBytes, sizeof(cowBytes));
+        (void)written;
+        _exit(ok ? 0 : 1);
+    }
+    
+    close(report[1]);
+    if (child < 0) {
+        // Can't fork (likely out of memory for the page tables): write it here
+        close(report[0]);
+        bool ok = writeCheckpoint(meta, true);
+        if (ok) {
+            wal.removeBefore(segment);
+            removeRetiredColdFiles();
+        }
+        recordCheckpoint(ok, started, false, 0, 0);
+        return ok;
+    }
+    
+    uint64_t cowBytes = 0;
+    ssize_t got;
+    while ((got = read(report[0], &cowBytes, sizeof(cowBytes))) < 0 && errno == EINTR) {}
+    if (got != static_cast<ssize_t>(sizeof(cowBytes))) cowBytes = 0;
+    close(report[0]);
+    int status = 0;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+    
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (ok) {
+        wal.removeBefore(segment);
+        removeRetiredColdFiles();
+    } else {
+        std::remove((dataFile + ".tmp").c_str());    // Left by a child that died mid-write
+    }
+    recordCheckpoint(ok, started, true, forkMs, cowBytes);
+    return ok;
+}
+#endif
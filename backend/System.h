@@ -6,15 +6,25 @@
 #define SYSTEM_H
 
 #include "DataStructures.h"
+#include "Epoch.h"
+#include "Wal.h"
+#include "Snapshot.h"
+#include "ColdArchive.h"
+#include "BlockList.h"
 #include <string>
 #include <vector>
 #include <ctime>
 #include <sstream>
 #include <fstream>
 #include <iomanip>
-#include <iomanip>
 #include <random>
 #include <map>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <functional>
+#include <memory>
 
 // Analytics Data Structure
 struct AnalyticsData {
@@ -26,25 +36,427 @@ struct AnalyticsData {
     std::map<std::string, int> locationStats;
 };
 
+// How a change to the store went. LOG_FAILED means it was made in memory
+// but its log record never reached the disk, so it must not be acknowledged;
+// the next checkpoint's snapshot still includes it.
+enum class MutationStatus {
+    DONE,
+    NOT_FOUND,
+    LOG_FAILED
+};
+
+// Cold archive size, for metrics
+struct ColdArchiveStats {
+    size_t segments;
+    size_t items;
+    size_t bytes;
+    size_t tombstones;
+};
+
+// Checkpoint history, for metrics
+struct CheckpointStats {
+    uint64_t completed;
+    uint64_t failed;
+    bool inProgress;
+    bool lastForked;            // Last one was written by a forked child
+    double lastDurationMs;      // Log rotation to snapshot on disk
+    double lastForkMs;          // fork() itself, the only time writers waited
+    uint64_t lastCowBytes;      // Memory the child stopped sharing with the server, its own buffers included
+    long long lastCompletedAt;  // Unix time; 0 = none yet
+
+    CheckpointStats() : completed(0), failed(0), inProgress(false), lastForked(false),
+                        lastDurationMs(0), lastForkMs(0), lastCowBytes(0), lastCompletedAt(0) {}
+};
+
+// Reader/writer lock that lets an exclusive locker in while shared lockers
+// keep arriving: std::shared_mutex may favour readers, and mutations hold
+// this one shared nearly back to back under load. Not reentrant.
+class UpdateGate {
+private:
+    std::mutex turnstile;       // Held by an exclusive locker until it is in
+    std::shared_mutex gate;
+    
+public:
+    void lock() {
+        std::lock_guard<std::mutex> queue(turnstile);
+        gate.lock();
+    }
+    void unlock() { gate.unlock(); }
+    
+    void lock_shared() {
+        {
+            std::lock_guard<std::mutex> queue(turnstile);
+        }
+        gate.lock_shared();
+    }
+    void unlock_shared() { gate.unlock_shared(); }
+};
+
+// ============================================================================
+// CONCURRENCY - Safe to call from any number of request threads
+// Items are spread over ITEM_SHARD_COUNT shards by id hash. Each shard is an
+// immutable, id-sorted version that writers replace with an atomic pointer
+// swap under the shard's write lock, copying only the block list and the
+// blocks they change; the history is versioned the same way. Readers pin an epoch instead of locking, so a
+// long walk over every item never stalls a report, and replaced versions
+// are freed by epoch-based reclamation once no reader can still see them.
+// The tries, inverted index and location cluster answer short lookups and
+// keep a reader/writer lock each. A thread holds at most one lock at a time,
+// so there is no lock order to get wrong; the price is that a new item
+// reaches the store before the indexes, and index hits are re-checked
+// against the store. Two locks are taken before any other: saveMutex by a
+// checkpoint (a forking one then holds the gate and every index lock
+// across fork()), and indexUpdateGate, held shared by a mutation until its
+// indexes are updated so that a checkpoint can read the store and indexes
+// with none in flight.
+// Archived items move out of the shards into cold segments at checkpoints.
+// The cold archive is versioned like a shard and republished under
+// coldMutex, which a move holds across the shard edit (so before a shard's
+// write lock); a reader of both tiers takes a TieredView and sees an item
+// being moved in exactly one of them.
+// The campus graph is only written in the constructor and needs no lock.
+// ============================================================================
 class LostFoundSystem {
 private:
+    static const size_t ITEM_SHARD_COUNT = 16;
+    
+    typedef BlockList<const Item*> ItemList;
+    
+    struct ItemShard {
+        std::mutex writeMutex;                  // Writers only; readers pin instead
+        std::atomic<const ItemList*> items;     // Sorted by id, never modified once published
+        
+        ItemShard() : items(new ItemList()) {}
+    };
+    
+    // Items of one consistent moment per shard, valid while the guard lives
+    struct StoreView {
+        EpochDomain::Guard guard;
+        const ItemList* shards[ITEM_SHARD_COUNT];
+        
+        explicit StoreView(LostFoundSystem& system) : guard(system.epochs.pin()) {
+            for (size_t i = 0; i < ITEM_SHARD_COUNT; i++) {
+                shards[i] = system.itemShards[i].items.load();
+            }
+        }
+    };
+    
+    // The store and the cold archive as of one moment
+    struct TieredView {
+        std::shared_lock<std::shared_mutex> lock;
+        std::shared_ptr<const ColdArchive> cold;
+        StoreView store;
+        
+        explicit TieredView(LostFoundSystem& system)
+            : lock(system.coldMutex), cold(system.cold), store(system) {
+            lock.unlock();
+        }
+    };
+    
+    static const size_t MAX_COLD_SEGMENTS = 8;
+    
+    EpochDomain epochs;                  // Declared first so it is destroyed last
     Trie searchTrie;
-    ItemHashMap itemMap;
+    ItemShard itemShards[ITEM_SHARD_COUNT];
     LocationGraph campusGraph;
-    ItemBST historyBST;
+    std::atomic<const ItemList*> history;    // Report-time copies, oldest first
     InvertedIndex invertedIndex;        // NEW: For multi-field search
     LocationCluster locationCluster;     // NEW: For proximity grouping
     CategoryTrieManager categoryTries;   // NEW: For category-specific search
-    int itemCounter;
+    std::atomic<int> itemCounter;
+    std::atomic<uint64_t> generation;    // Bumped by every mutation; versions cached views
     std::string webhookUrl;              // For n8n integration (match notifications)
     std::string claimWebhookUrl;         // For n8n integration (claim notifications)
     
+    std::shared_mutex trieMutex;         // searchTrie
+    std::shared_mutex categoryTrieMutex; // categoryTries
+    std::mutex historyWriteMutex;        // Writers of history
+    std::shared_mutex indexMutex;        // invertedIndex
+    std::mutex clusterMutex;             // locationCluster (lookups compress paths) and clustersBuilt
+    UpdateGate indexUpdateGate;          // Held shared from a mutation's log append until its indexes are updated
+    mutable std::mutex configMutex;      // Webhook URLs
+    std::mutex saveMutex;                // One save at a time, so the newest state lands last
+    
+    WriteAheadLog wal;                   // Mutations since the last snapshot
+    std::string dataFile;                // Snapshot path; set by openLog
+    uint64_t snapshotSegment;            // First log segment the loaded snapshot doesn't cover
+    bool clustersBuilt;                  // locationCluster built or loaded; done on first use otherwise
+    bool indexesLoaded;                  // Item indexes came from an index image at startup
+    
+    std::shared_mutex coldMutex;         // Publishing cold; tier moves hold it exclusively
+    std::shared_ptr<const ColdArchive> cold;    // Archived items moved out of the shards
+    uint64_t nextColdSegment;            // Number of the next cold segment file
+    std::vector<std::string> retiredColdFiles;  // Compacted away; removed once a snapshot no longer lists them
+    
+    std::mutex checkpointStatsMutex;     // checkpointStats
+    CheckpointStats checkpointStats;
+    std::atomic<bool> checkpointRunning;
+    
+    // Header fields for a snapshot whose log continues at logSegment, with a
+    // fresh generation
+    SnapshotMeta snapshotMeta(uint64_t logSegment);
+    
+    // Binary snapshot of the items in view, with the cold tiers of archive;
+    // false if its strings don't fit a snapshot's string table
+    bool encodeSnapshot(SnapshotMeta meta, const ColdArchive& archive, const StoreView& view, std::string& file);
+    
+    // Index image of the current indexes, for the snapshot of that
+    // generation. Without takeLocks the caller guarantees no index changes.
+    std::string encodeIndexImage(uint64_t snapshotGeneration, bool takeLocks = true);
+    
+    // Checkpoint steps: start a new log segment, write the snapshot and
+    // index image as of one moment after it (writers wait while the image
+    // is encoded), and note how it went. Caller holds saveMutex.
+    uint64_t rotateForCheckpoint();
+    bool writeCheckpoint(const SnapshotMeta& meta, bool takeLocks);
+    void recordCheckpoint(bool ok, std::chrono::steady_clock::time_point started,
+                          bool forked, double forkMs, uint64_t cowBytes);
+    
+    // Load the location clusters from the image at path if the campus graph
+    // is unchanged, and the item indexes if it was written for the snapshot
+    // of that generation. True if the item indexes were loaded.
+    bool loadIndexImage(const std::string& path, uint64_t snapshotGeneration);
+    
+    // Move archived items from the shards into a new cold segment, merging
+    // in the segments worth compacting. Caller holds saveMutex, after
+    // rotateForCheckpoint(); a failed write leaves everything in place.
+    void tierArchivedItems();
+    
+    // After a snapshot that no longer lists them is on disk
+    void removeRetiredColdFiles();
+    
+    // Startup form of storeItems() for an empty system: takes the items over
+    // and builds the store and every index at once, each on its own thread.
+    // Cold items go into the history and tries only. With buildIndexes false
+    // the item indexes are left as they are.
+    void bulkLoad(std::vector<Item>& items, const std::vector<Item>& coldItems, bool buildIndexes = true);
+    
+    // Caller holds clusterMutex
+    void ensureClusters() {
+        if (clustersBuilt) return;
+        locationCluster.buildClusters();
+        clustersBuilt = true;
+    }
+    
     std::string generateId() {
         std::stringstream ss;
         ss << "ITEM-" << std::setfill('0') << std::setw(6) << (++itemCounter);
         return ss.str();
     }
     
+    ItemShard& shardFor(const std::string& id) {
+        return itemShards[std::hash<std::string>()(id) % ITEM_SHARD_COUNT];
+    }
+    
+    static bool idLess(const Item* item, const std::string& id) {
+        return item->id < id;
+    }
+    
+    static const Item* findItem(const ItemList& items, const std::string& id) {
+        auto it = items.lowerBound(id, idLess);
+        return (it != items.end() && (*it)->id == id) ? *it : nullptr;
+    }
+    
+    // Publish next in place of current (held under its write lock) and
+    // retire current together with the items that left the store
+    void replaceVersion(std::atomic<const ItemList*>& slot, const ItemList* current,
+                        ItemList* next, std::vector<const Item*> dropped) {
+        slot.store(next);
+        epochs.retire([current, dropped]() {
+            for (const Item* item : dropped) {
+                delete item;
+            }
+            delete current;
+        });
+    }
+    
+    struct ShardEdit {
+        ItemList& items;
+        std::vector<const Item*> dropped;   // Left the store; freed with the old version
+        std::vector<std::string> records;   // Logged once the new version is published
+    };
+    
+    // Copy-on-write edit of one shard; an edit returning false publishes
+    // nothing (NOT_FOUND). Records are appended after publishing and under
+    // the write lock, so each item's records are in log order and a
+    // checkpoint's snapshot has seen every record in the segments it
+    // replaces. Returns once they are as durable as the fsync policy
+    // promises, or LOG_FAILED if they never will be.
+    MutationStatus editShard(ItemShard& shard, const std::function<bool(ShardEdit&)>& edit) {
+        uint64_t logSeq = 0;
+        {
+            std::lock_guard<std::mutex> lock(shard.writeMutex);
+            const ItemList* current = shard.items.load();
+            ItemList* next = new ItemList(*current);
+            ShardEdit change{*next, {}, {}};
+            if (!edit(change)) {
+                delete next;
+                return MutationStatus::NOT_FOUND;
+            }
+            replaceVersion(shard.items, current, next, std::move(change.dropped));
+            if (!change.records.empty()) logSeq = wal.append(change.records);
+        }
+        return wal.commit(logSeq) ? MutationStatus::DONE : MutationStatus::LOG_FAILED;
+    }
+    
+    // Mutation log records (encoded in System.cpp)
+    static std::string itemRecord(char op, const Item& item, int counter);
+    static std::string deleteRecord(const std::string& id);
+    static std::string configRecord(char op, const std::string& value);
+    void applyLogRecord(const std::string& record);
+    
+    bool logging() const { return wal.isOpen(); }
+    
+    void appendHistory(const std::vector<Item>& items) {
+        std::lock_guard<std::mutex> lock(historyWriteMutex);
+        const ItemList* current = history.load();
+        ItemList* next = new ItemList(*current);
+        for (const Item& item : items) {
+            // After any equal timestamps, so those stay in report order
+            auto at = next->upperBound(item.timestamp,
+                [](long long timestamp, const Item* entry) { return timestamp < entry->timestamp; });
+            next->insert(at, new Item(item));
+        }
+        replaceVersion(history, current, next, {});
+    }
+    
+    // Add to the store, then to each index in turn. False if the change
+    // could not be logged; it is made either way.
+    bool storeItems(const std::vector<Item>& items) {
+        std::shared_lock<UpdateGate> gate(indexUpdateGate);
+        std::vector<std::vector<const Item*>> byShard(ITEM_SHARD_COUNT);
+        for (const Item& item : items) {
+            byShard[&shardFor(item.id) - itemShards].push_back(new Item(item));
+        }
+        bool logged = true;
+        for (size_t i = 0; i < ITEM_SHARD_COUNT; i++) {
+            if (byShard[i].empty()) continue;
+            MutationStatus status = editShard(itemShards[i], [&](ShardEdit& change) {
+                for (const Item* item : byShard[i]) {
+                    auto at = change.items.lowerBound(item->id, idLess);
+                    if (at != change.items.end() && (*at)->id == item->id) {
+                        change.dropped.push_back(*at);  // Same id stored again replaces it
+                        change.items.replace(at, item);
+                    } else {
+                        change.items.insert(at, item);
+                    }
+                    if (logging()) change.records.push_back(itemRecord('I', *item, itemCounter));
+                }
+                return true;
+            });
+            if (status == MutationStatus::LOG_FAILED) logged = false;
+        }
+        appendHistory(items);
+        {
+            std::unique_lock<std::shared_mutex> lock(trieMutex);
+            for (const Item& item : items) {
+                searchTrie.insert(item.name, item.timestamp);
+            }
+        }
+        {
+            std::unique_lock<std::shared_mutex> lock(indexMutex);
+            for (const Item& item : items) {
+                invertedIndex.indexItem(item);
+            }
+        }
+        {
+            std::unique_lock<std::shared_mutex> lock(categoryTrieMutex);
+            for (const Item& item : items) {
+                categoryTries.insert(item.name, item.category, item.timestamp);
+            }
+        }
+        return logged;
+    }
+    
+    // Publish a changed copy of the stored item
+    MutationStatus updateItem(const std::string& id, const std::function<void(Item&)>& update) {
+        std::shared_lock<UpdateGate> gate(indexUpdateGate);
+        MutationStatus status = editShard(shardFor(id), [&](ShardEdit& change) {
+            auto at = change.items.lowerBound(id, idLess);
+            if (at == change.items.end() || (*at)->id != id) return false;
+            Item* changed = new Item(**at);
+            update(*changed);
+            change.dropped.push_back(*at);
+            change.items.replace(at, changed);
+            if (logging()) change.records.push_back(itemRecord('U', *changed, 0));
+            return true;
+        });
+        return status != MutationStatus::NOT_FOUND ? status : updateColdItem(id, update);
+    }
+    
+    // Copies of the items keep accepts
+    std::vector<Item> collectItems(const std::function<bool(const Item&)>& keep) {
+        std::vector<Item> result;
+        visitItems(keep, [&result](const Item& item) { result.push_back(item); });
+        return result;
+    }
+    
+    // Visit the items keep accepts in place. No lock is held, so a slow
+    // visitor (a streaming client) only delays reclamation, never a writer.
+    void visitItems(const std::function<bool(const Item&)>& keep,
+                    const std::function<void(const Item&)>& visit) {
+        StoreView view(*this);
+        for (const ItemList* shard : view.shards) {
+            for (const Item* item : *shard) {
+                if (keep(*item)) visit(*item);
+            }
+        }
+    }
+    
+    size_t countItems(const std::function<bool(const Item&)>& keep) {
+        size_t count = 0;
+        visitItems(keep, [&count](const Item&) { count++; });
+        return count;
+    }
+    
+    std::shared_ptr<const ColdArchive> coldArchive() {
+        std::shared_lock<std::shared_mutex> lock(coldMutex);
+        return cold;
+    }
+    
+    // Publish a copy of the cold archive with id tombstoned; false if id
+    // isn't cold. Caller holds coldMutex exclusively.
+    bool tombstoneColdItem(const std::string& id) {
+        std::shared_ptr<ColdArchive> next = std::make_shared<ColdArchive>(*cold);
+        if (!next->remove(id)) return false;
+        cold = next;
+        return true;
+    }
+    
+    // updateItem() for an item in the cold archive: the changed copy moves
+    // back into its shard. Caller holds indexUpdateGate shared.
+    MutationStatus updateColdItem(const std::string& id, const std::function<void(Item&)>& update) {
+        Item changed;
+        MutationStatus status;
+        {
+            std::unique_lock<std::shared_mutex> lock(coldMutex);
+            if (!cold->find(id, changed) || !tombstoneColdItem(id)) return MutationStatus::NOT_FOUND;
+            update(changed);
+            status = editShard(shardFor(id), [&](ShardEdit& change) {
+                change.items.insert(change.items.lowerBound(id, idLess), new Item(changed));
+                if (logging()) change.records.push_back(itemRecord('U', changed, 0));
+                return true;
+            });
+        }
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        invertedIndex.indexItem(changed);
+        return status;
+    }
+    
+    // deleteItem() for an item in the cold archive. Caller holds
+    // indexUpdateGate shared.
+    MutationStatus deleteColdItem(const std::string& id) {
+        uint64_t logSeq = 0;
+        {
+            std::unique_lock<std::shared_mutex> lock(coldMutex);
+            if (!tombstoneColdItem(id)) return MutationStatus::NOT_FOUND;
+            if (logging()) logSeq = wal.append({deleteRecord(id)});
+        }
+        return wal.commit(logSeq) ? MutationStatus::DONE : MutationStatus::LOG_FAILED;
+    }
+    
+    void bumpGeneration() { generation++; }
+    
     long long getCurrentTimestamp() {
         return static_cast<long long>(std::time(nullptr));
     }
@@ -84,19 +496,63 @@ private:
     }
     
 public:
-    LostFoundSystem() : itemCounter(0) {
+    LostFoundSystem() : history(new ItemList()), itemCounter(0), generation(1), snapshotSegment(0),
+                        clustersBuilt(false), indexesLoaded(false), cold(std::make_shared<ColdArchive>()),
+                        nextColdSegment(1), checkpointRunning(false) {
         campusGraph.initializeDefaultCampus();
         locationCluster.setGraph(&campusGraph);
-        locationCluster.buildClusters();
     }
     
-    // Configure webhook URLs for n8n integration
-    void setWebhookUrl(const std::string& url) { webhookUrl = url; }
-    std::string getWebhookUrl() const { return webhookUrl; }
-    void setClaimWebhookUrl(const std::string& url) { claimWebhookUrl = url; }
-    std::string getClaimWebhookUrl() const { return claimWebhookUrl; }
+    // Frees the current versions; retired ones go with the epoch domain
+    ~LostFoundSystem() {
+        for (ItemShard& shard : itemShards) {
+            const ItemList* items = shard.items.load();
+            for (const Item* item : *items) {
+                delete item;
+            }
+            delete items;
+        }
+        const ItemList* entries = history.load();
+        for (const Item* entry : *entries) {
+            delete entry;
+        }
+        delete entries;
+    }
+    
+    LostFoundSystem(const LostFoundSystem&) = delete;
+    LostFoundSystem& operator=(const LostFoundSystem&) = delete;
+    
+    // Configure webhook URLs for n8n integration; false if the change
+    // could not be logged
+    bool setWebhookUrl(const std::string& url) {
+        uint64_t logSeq = 0;
+        {
+            std::lock_guard<std::mutex> lock(configMutex);
+            webhookUrl = url;
+            if (logging()) logSeq = wal.append({configRecord('W', url)});
+        }
+        return wal.commit(logSeq);
+    }
+    std::string getWebhookUrl() const {
+        std::lock_guard<std::mutex> lock(configMutex);
+        return webhookUrl;
+    }
+    bool setClaimWebhookUrl(const std::string& url) {
+        uint64_t logSeq = 0;
+        {
+            std::lock_guard<std::mutex> lock(configMutex);
+            claimWebhookUrl = url;
+            if (logging()) logSeq = wal.append({configRecord('C', url)});
+        }
+        return wal.commit(logSeq);
+    }
+    std::string getClaimWebhookUrl() const {
+        std::lock_guard<std::mutex> lock(configMutex);
+        return claimWebhookUrl;
+    }
     
-    // Report a lost item with category and email
+    // Report a lost item with category and email. Returns its id, or an
+    // empty string if the report could not be logged.
     std::string reportLostItem(const std::string& name, const std::string& color,
                                const std::string& location, const std::string& owner,
                                const std::string& description = "",
@@ -109,39 +565,35 @@ public:
         Item item(id, name, color, location, owner, "lost", timestamp, description, category, email);
         
         // Insert into all data structures
-        itemMap.insert(id, item);
-        searchTrie.insert(name);
-        historyBST.insert(item);
-        invertedIndex.indexItem(item);
-        categoryTries.insert(name, category);
+        bool logged = storeItems({item});
+        bumpGeneration();
         
-        return id;
+        return logged ? id : std::string();
     }
     
-    // Report a found item and get matches
-    std::vector<MatchCandidate> reportFoundItem(const std::string& name, const std::string& color,
-                                                 const std::string& location, const std::string& finder,
-                                                 const std::string& description = "",
-                                                 const std::string& categoryStr = "other",
-                                                 const std::string& email = "") {
+    // Report a found item and get matches. Returns its id, or an empty
+    // string (and no matches) if the report could not be logged.
+    std::string reportFoundItem(const std::string& name, const std::string& color,
+                                const std::string& location, const std::string& finder,
+                                const std::string& description, const std::string& categoryStr,
+                                const std::string& email, std::vector<MatchCandidate>& matches) {
         std::string id = generateId();
         long long timestamp = getCurrentTimestamp();
         Category category = stringToCategory(categoryStr);
         
         Item foundItem(id, name, color, location, finder, "found", timestamp, description, category, email);
-        itemMap.insert(id, foundItem);
-        searchTrie.insert(name);
-        historyBST.insert(foundItem);
-        invertedIndex.indexItem(foundItem);
-        categoryTries.insert(name, category);
+        bool logged = storeItems({foundItem});
+        bumpGeneration();
+        matches.clear();
+        if (!logged) return std::string();
         
         // Find matches using DSA - only from non-archived lost items
         MatchHeap matchHeap;
-        std::vector<Item> lostItems = itemMap.getItemsByType("lost");
+        auto isLost = [](const Item& item) { return item.type == "lost"; };
         
-        for (const auto& lostItem : lostItems) {
+        visitItems(isLost, [&](const Item& lostItem) {
             // Skip archived items
-            if (lostItem.archived) continue;
+            if (lostItem.archived) return;
             
             MatchCandidate candidate;
             candidate.itemId = lostItem.id;
@@ -163,20 +615,26 @@ public:
             if (candidate.nameScore > 0 && candidate.score > 0) {
                 matchHeap.insert(candidate);
             }
-        }
+        });
         
-        return matchHeap.getTopK(10);
+        matches = matchHeap.getTopK(10);
+        return id;
     }
     
-    // Autocomplete search (global)
-    std::vector<std::string> searchAutocomplete(const std::string& prefix) {
+    // Autocomplete search (global); maxEdits above 0 tolerates that many typos
+    std::vector<std::string> searchAutocomplete(const std::string& prefix, int maxEdits = 0) {
+        std::shared_lock<std::shared_mutex> lock(trieMutex);
+        if (maxEdits > 0) return searchTrie.fuzzyAutocomplete(prefix, maxEdits, 10);
         return searchTrie.autocomplete(prefix, 10);
     }
     
     // Autocomplete search by category
     std::vector<std::string> searchAutocompleteByCategory(const std::string& prefix, 
-                                                           const std::string& categoryStr) {
+                                                           const std::string& categoryStr,
+                                                           int maxEdits = 0) {
         Category cat = stringToCategory(categoryStr);
+        std::shared_lock<std::shared_mutex> lock(categoryTrieMutex);
+        if (maxEdits > 0) return categoryTries.fuzzyAutocompleteByCategory(prefix, cat, maxEdits, 10);
         return categoryTries.autocompleteByCategory(prefix, cat, 10);
     }
     
@@ -190,89 +648,142 @@ public:
                                       long long dateTo = 0,
                                       bool includeArchived = false) {
         std::vector<Item> results;
-        
-        // Use inverted index for initial filtering
-        std::set<std::string> matchingIds = invertedIndex.search(name, color, location, category);
-        
-        // If no filters provided to inverted index, get all items
-        if (name.empty() && color.empty() && location.empty() && category.empty()) {
-            auto allItems = itemMap.getAllItems();
-            for (const auto& item : allItems) {
-                matchingIds.insert(item.id);
-            }
-        }
-        
-        // Apply additional filters
-        for (const auto& id : matchingIds) {
-            Item* item = itemMap.get(id);
-            if (!item) continue;
-            
+        forEachSearchResult(name, color, location, category, type, dateFrom, dateTo, includeArchived,
+                            [&results](const Item& item) { results.push_back(item); });
+        return results;
+    }
+    
+    // Visit advanced search matches in id order without copying them out
+    void forEachSearchResult(const std::string& name,
+                             const std::string& color,
+                             const std::string& location,
+                             const std::string& category,
+                             const std::string& type,
+                             long long dateFrom,
+                             long long dateTo,
+                             bool includeArchived,
+                             const std::function<void(const Item&)>& visit) {
+        auto accepts = [&](const Item& item) {
             // Filter by archived status
-            if (!includeArchived && item->archived) continue;
+            if (!includeArchived && item.archived) return false;
             
             // Filter by type
-            if (!type.empty() && item->type != type) continue;
+            if (!type.empty() && item.type != type) return false;
             
             // Filter by date range
-            if (dateFrom > 0 && item->timestamp < dateFrom) continue;
-            if (dateTo > 0 && item->timestamp > dateTo) continue;
-            
-            results.push_back(*item);
+            if (dateFrom > 0 && item.timestamp < dateFrom) return false;
+            if (dateTo > 0 && item.timestamp > dateTo) return false;
+            return true;
+        };
+        
+        bool filtered = !name.empty() || !color.empty() || !location.empty() || !category.empty();
+        std::vector<const Item*> matches;
+        
+        // Use inverted index for initial filtering
+        std::set<std::string> matchingIds;
+        if (filtered) {
+            std::shared_lock<std::shared_mutex> lock(indexMutex);
+            matchingIds = invertedIndex.search(name, color, location, category);
+        }
+        TieredView view(*this);
+        if (filtered) {
+            for (const auto& id : matchingIds) {
+                const Item* item = findItem(*view.store.shards[&shardFor(id) - itemShards], id);
+                if (item && accepts(*item)) matches.push_back(item);
+            }
+        } else {
+            // No index filters: walk the store directly, ordered by id like the index path
+            for (const ItemList* shard : view.store.shards) {
+                for (const Item* item : *shard) {
+                    if (accepts(*item)) matches.push_back(item);
+                }
+            }
+            std::sort(matches.begin(), matches.end(),
+                      [](const Item* a, const Item* b) { return a->id < b->id; });
         }
         
-        return results;
+        // Cold items are all archived and not indexed: scan them, then merge by id
+        std::vector<Item> coldMatches;
+        if (includeArchived) {
+            view.cold->forEach([&](const Item& item) {
+                if (accepts(item) && InvertedIndex::matches(item, name, color, location, category)) {
+                    coldMatches.push_back(item);
+                }
+            });
+            std::sort(coldMatches.begin(), coldMatches.end(),
+                      [](const Item& a, const Item& b) { return a.id < b.id; });
+        }
+        auto coldNext = coldMatches.begin();
+        for (const Item* item : matches) {
+            for (; coldNext != coldMatches.end() && coldNext->id < item->id; ++coldNext) {
+                visit(*coldNext);
+            }
+            visit(*item);
+        }
+        for (; coldNext != coldMatches.end(); ++coldNext) {
+            visit(*coldNext);
+        }
     }
     
-    // Archive expired items
-    int archiveExpiredItems() {
-        int archivedCount = 0;
-        auto allItems = itemMap.getAllItems();
+    // Archive expired items, counting them in archivedCount
+    MutationStatus archiveExpiredItems(int& archivedCount) {
+        archivedCount = 0;
+        bool logged = true;
         
-        for (auto& item : allItems) {
-            if (!item.archived && item.isExpired()) {
-                Item* storedItem = itemMap.get(item.id);
-                if (storedItem) {
-                    storedItem->archived = true;
-                    archivedCount++;
+        for (ItemShard& shard : itemShards) {
+            MutationStatus status = editShard(shard, [&](ShardEdit& change) {
+                for (auto at = change.items.begin(); at != change.items.end(); ++at) {
+                    const Item* item = *at;
+                    if (item->archived || !item->isExpired()) continue;
+                    Item* archived = new Item(*item);
+                    archived->archived = true;
+                    change.dropped.push_back(item);
+                    change.items.replace(at, archived);
+                    if (logging()) change.records.push_back(itemRecord('U', *archived, 0));
                 }
-            }
+                archivedCount += static_cast<int>(change.dropped.size());
+                return !change.dropped.empty();
+            });
+            if (status == MutationStatus::LOG_FAILED) logged = false;
         }
         
-        return archivedCount;
+        if (archivedCount > 0) bumpGeneration();
+        return logged ? MutationStatus::DONE : MutationStatus::LOG_FAILED;
     }
     
     // Get only active (non-archived) items
     std::vector<Item> getActiveItems() {
-        std::vector<Item> result;
-        for (auto& item : itemMap.getAllItems()) {
-            if (!item.archived) {
-                result.push_back(item);
-            }
-        }
-        return result;
+        return collectItems([](const Item& item) { return !item.archived; });
+    }
+    
+    // Visit active items in place
+    void forEachActiveItem(const std::function<void(const Item&)>& visit) {
+        visitItems([](const Item& item) { return !item.archived; }, visit);
     }
     
     // Get archived items
     std::vector<Item> getArchivedItems() {
         std::vector<Item> result;
-        for (auto& item : itemMap.getAllItems()) {
-            if (item.archived) {
-                result.push_back(item);
+        forEachArchivedItem([&result](const Item& item) { result.push_back(item); });
+        return result;
+    }
+    
+    // Visit archived items, those still in the store in place and then the
+    // cold ones as they are decoded
+    void forEachArchivedItem(const std::function<void(const Item&)>& visit) {
+        TieredView view(*this);
+        for (const ItemList* shard : view.store.shards) {
+            for (const Item* item : *shard) {
+                if (item->archived) visit(*item);
             }
         }
-        return result;
+        view.cold->forEach(visit);
     }
     
     // Get items by category
     std::vector<Item> getItemsByCategory(const std::string& categoryStr) {
-        std::vector<Item> result;
         Category cat = stringToCategory(categoryStr);
-        for (auto& item : itemMap.getAllItems()) {
-            if (item.category == cat && !item.archived) {
-                result.push_back(item);
-            }
-        }
-        return result;
+        return collectItems([cat](const Item& item) { return item.category == cat && !item.archived; });
     }
     
     // Get all available categories
@@ -282,22 +793,49 @@ public:
     
     // Get cluster members for a location
     std::vector<std::string> getNearbyLocations(const std::string& location) {
+        std::lock_guard<std::mutex> lock(clusterMutex);
+        ensureClusters();
         return locationCluster.getClusterMembers(location);
     }
     
     // Get sorted history
     std::vector<Item> getHistory(bool ascending = false) {
-        return historyBST.getSortedHistory(ascending);
+        std::vector<Item> result;
+        forEachHistoryItem(ascending, [&result](const Item& item) { result.push_back(item); });
+        return result;
+    }
+    
+    // Walk the history in timestamp order without materializing it
+    void forEachHistoryItem(bool ascending, const std::function<void(const Item&)>& visit) {
+        EpochDomain::Guard guard = epochs.pin();
+        const ItemList& entries = *history.load();
+        if (ascending) {
+            for (auto it = entries.begin(); it != entries.end(); ++it) visit(**it);
+        } else {
+            for (auto it = entries.rbegin(); it != entries.rend(); ++it) visit(**it);
+        }
     }
     
     // Get all items
     std::vector<Item> getAllItems() {
-        return itemMap.getAllItems();
+        std::vector<Item> result;
+        TieredView view(*this);
+        for (const ItemList* shard : view.store.shards) {
+            for (const Item* item : *shard) {
+                result.push_back(*item);
+            }
+        }
+        view.cold->forEach([&result](const Item& item) { result.push_back(item); });
+        return result;
     }
     
-    // Get item by ID
-    Item* getItemById(const std::string& id) {
-        return itemMap.get(id);
+    // Copy an item out by ID; false if there is none
+    bool getItemById(const std::string& id, Item& out) {
+        TieredView view(*this);
+        const Item* item = findItem(*view.store.shards[&shardFor(id) - itemShards], id);
+        if (item == nullptr) return view.cold->find(id, out);
+        out = *item;
+        return true;
     }
     
     // Get available locations
@@ -307,32 +845,81 @@ public:
     
     // Get items by type
     std::vector<Item> getItemsByType(const std::string& type) {
-        return itemMap.getItemsByType(type);
+        std::vector<Item> result;
+        TieredView view(*this);
+        for (const ItemList* shard : view.store.shards) {
+            for (const Item* item : *shard) {
+                if (item->type == type) result.push_back(*item);
+            }
+        }
+        view.cold->forEach([&](const Item& item) {
+            if (item.type == type) result.push_back(item);
+        });
+        return result;
+    }
+    
+    // Active items of a type; none of them are cold
+    std::vector<Item> getActiveItemsByType(const std::string& type) {
+        return collectItems([&type](const Item& item) { return item.type == type && !item.archived; });
+    }
+    
+    // Items of a type, counting cold ones from the segment indexes
+    size_t countItemsByType(const std::string& type) {
+        TieredView view(*this);
+        size_t count = 0;
+        for (const ItemList* shard : view.store.shards) {
+            for (const Item* item : *shard) {
+                if (item->type == type) count++;
+            }
+        }
+        ColdItemKind kind = coldKind(type);
+        if (kind != COLD_OTHER) return count + view.cold->count(kind);
+        view.cold->forEach([&](const Item& item) {
+            if (item.type == type) count++;
+        });
+        return count;
     }
     
     // Delete an item by ID
-    bool deleteItem(const std::string& id) {
-        Item* item = itemMap.get(id);
-        if (item == nullptr) {
-            return false;
+    MutationStatus deleteItem(const std::string& id) {
+        std::shared_lock<UpdateGate> gate(indexUpdateGate);
+        Item removed;
+        MutationStatus status = editShard(shardFor(id), [&](ShardEdit& change) {
+            auto at = change.items.lowerBound(id, idLess);
+            if (at == change.items.end() || (*at)->id != id) return false;
+            removed = **at;
+            change.dropped.push_back(*at);
+            // Remove from the store
+            change.items.erase(at);
+            if (logging()) change.records.push_back(deleteRecord(id));
+            return true;
+        });
+        if (status == MutationStatus::NOT_FOUND) {
+            status = deleteColdItem(id);
+            if (status != MutationStatus::NOT_FOUND) bumpGeneration();
+            return status;
         }
         // Remove from inverted index
-        invertedIndex.removeItem(*item);
-        // Remove from hashmap
-        return itemMap.remove(id);
+        {
+            std::unique_lock<std::shared_mutex> lock(indexMutex);
+            invertedIndex.removeItem(removed);
+        }
+        bumpGeneration();
+        return status;
     }
     
     // Claim an item
-    bool claimItem(const std::string& id, const std::string& claimedBy) {
-        Item* item = itemMap.get(id);
-        if (item == nullptr) return false;
-        
-        item->claimed = true;
-        item->claimedBy = claimedBy;
-        item->claimedAt = getCurrentTimestamp();
-        item->archived = true; // Claimed items are automatically archived
+    MutationStatus claimItem(const std::string& id, const std::string& claimedBy) {
+        long long now = getCurrentTimestamp();
+        MutationStatus status = updateItem(id, [&](Item& item) {
+            item.claimed = true;
+            item.claimedBy = claimedBy;
+            item.claimedAt = now;
+            item.archived = true; // Claimed items are automatically archived
+        });
+        if (status != MutationStatus::NOT_FOUND) bumpGeneration();
         
-        return true;
+        return status;
     }
     
     // Get advanced analytics
@@ -343,12 +930,12 @@ public:
         data.successRate = 0.0;
         data.avgClaimTimeHours = 0.0;
         
-        std::vector<Item> allItems = itemMap.getAllItems();
-        data.totalItems = allItems.size();
-        
         long long totalClaimTime = 0;
         
-        for (const auto& item : allItems) {
+        TieredView view(*this);
+        auto tally = [&](const Item& item) {
+            data.totalItems++;
+            
             // Category stats
             std::string catStr = categoryToString(item.category);
             data.categoryStats[catStr]++;
@@ -364,7 +951,13 @@ public:
                     totalClaimTime += claimTime;
                 }
             }
+        };
+        for (const ItemList* shard : view.store.shards) {
+            for (const Item* item : *shard) {
+                tally(*item);
+            }
         }
+        view.cold->forEach(tally);
         
         if (data.totalItems > 0) {
             data.successRate = (static_cast<double>(data.claimedItems) / data.totalItems) * 100.0;
@@ -378,13 +971,10 @@ public:
     }
 
     // Manually archive an item (e.g., when claimed)
-    bool archiveItem(const std::string& id) {
-        Item* item = itemMap.get(id);
-        if (item == nullptr) {
-            return false;
-        }
-        item->archived = true;
-        return true;
+    MutationStatus archiveItem(const std::string& id) {
+        MutationStatus status = updateItem(id, [](Item& item) { item.archived = true; });
+        if (status != MutationStatus::NOT_FOUND) bumpGeneration();
+        return status;
     }
     
     // Save data to JSON file
@@ -393,11 +983,70 @@ public:
     // Load data from JSON file
     bool loadFromFile(const std::string& filename);
     
+    // Load a binary snapshot written by checkpoint(), and the indexes from
+    // the index image beside it when that image belongs to this snapshot
+    bool loadSnapshot(const std::string& filename, std::string& error);
+    
+    // Whether loadSnapshot() took the item indexes from the index image
+    bool indexesFromImage() const { return indexesLoaded; }
+    
+    // Replay the log written next to dataPath since the snapshot loadSnapshot
+    // read, then keep logging every mutation there. Returns the number of
+    // records replayed, or -1 with error set if the log can't be used.
+    long long openLog(const std::string& dataPath, const WalOptions& options, std::string& error);
+    
+    // Write a snapshot of the current state and an index image for it, and
+    // drop the log the snapshot covers
+    bool checkpoint();
+    
+    // checkpoint() done by a forked child from its copy-on-write view of
+    // memory, so serializing costs the server no CPU or allocation; this
+    // thread waits for the child. Where fork() is unavailable or fails the
+    // checkpoint is written in process instead.
+    bool backgroundCheckpoint();
+    
+    CheckpointStats getCheckpointStats() {
+        std::lock_guard<std::mutex> lock(checkpointStatsMutex);
+        CheckpointStats stats = checkpointStats;
+        stats.inProgress = checkpointRunning;
+        return stats;
+    }
+    
+    WalStats getLogStats() { return wal.getStats(); }
+    
+    ColdArchiveStats getColdStats() {
+        std::shared_ptr<const ColdArchive> archive = coldArchive();
+        ColdArchiveStats stats;
+        stats.segments = archive->getTiers().size();
+        stats.items = archive->count();
+        stats.bytes = archive->bytes();
+        stats.tombstones = archive->tombstones();
+        return stats;
+    }
+    
     // Get statistics
-    size_t getTotalItems() { return itemMap.size(); }
-    size_t getActiveItemCount() { return getActiveItems().size(); }
-    size_t getArchivedItemCount() { return getArchivedItems().size(); }
+    size_t getTotalItems() {
+        TieredView view(*this);
+        size_t count = view.cold->count();
+        for (const ItemList* shard : view.store.shards) {
+            count += shard->size();
+        }
+        return count;
+    }
+    size_t getActiveItemCount() { return countItems([](const Item& item) { return !item.archived; }); }
+    size_t getArchivedItemCount() {
+        TieredView view(*this);
+        size_t count = view.cold->count();
+        for (const ItemList* shard : view.store.shards) {
+            for (const Item* item : *shard) {
+                if (item->archived) count++;
+            }
+        }
+        return count;
+    }
     int getItemCounter() { return itemCounter; }
+    uint64_t getGeneration() const { return generation; }
+    EpochStats getEpochStats() { return epochs.getStats(); }
     void setItemCounter(int count) { itemCounter = count; }
 };
 
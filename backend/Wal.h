@@ -0,0 +1,542 @@
+//
+// Wal.h - Append-only write-ahead log
+// Records are opaque byte strings framed as [length][crc32][payload] and
+// appended to numbered segment files (<base>.1, <base>.2, ...). A checkpoint
+// rotates to a fresh segment, and once a snapshot covers the old ones they
+// are deleted. Replay stops at the first damaged record; a torn record at
+// the end of the newest segment (a crash mid-append) is cut off.
+//
+
+#ifndef WAL_H
+#define WAL_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#define WAL_OPEN(path) ::_open(path, _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE)
+#define WAL_WRITE _write
+#define WAL_SYNC _commit
+#define WAL_CLOSE ::_close
+#else
+#include <unistd.h>
+#define WAL_OPEN(path) ::open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644)
+#define WAL_WRITE write
+#ifdef __APPLE__
+#define WAL_SYNC fsync
+#else
+#define WAL_SYNC fdatasync
+#endif
+#define WAL_CLOSE ::close
+#endif
+
+// When appended records reach the disk
+enum class WalSyncPolicy {
+    ALWAYS,     // Before the writer returns
+    EVERYSEC,   // Once a second in the background; a power cut loses up to a second
+    NEVER       // Left to the OS; only a process crash is survived
+};
+
+inline const char* walSyncPolicyName(WalSyncPolicy policy) {
+    switch (policy) {
+        case WalSyncPolicy::ALWAYS:   return "always";
+        case WalSyncPolicy::EVERYSEC: return "everysec";
+        default:                      return "no";
+    }
+}
+
+inline bool parseWalSyncPolicy(const std::string& name, WalSyncPolicy& policy) {
+    if (name == "always") policy = WalSyncPolicy::ALWAYS;
+    else if (name == "everysec") policy = WalSyncPolicy::EVERYSEC;
+    else if (name == "no") policy = WalSyncPolicy::NEVER;
+    else return false;
+    return true;
+}
+
+inline uint32_t crc32(const char* data, size_t length) {
+    static const struct Table {
+        uint32_t entries[256];
+        Table() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                entries[i] = c;
+            }
+        }
+    } table;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table.entries[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// Make a rename or newly created file in path's directory durable
+inline void syncParentDirectory(const std::string& path) {
+#ifndef _WIN32
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    int fd = open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+// Replace path with content so that a crash leaves either the old file or
+// the new one: write a temp file, flush it to disk, rename it over path
+inline bool writeFileDurably(const std::string& path, const std::string& content) {
+    std::string temp = path + ".tmp";
+#ifdef _WIN32
+    int fd = ::_open(temp.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+    if (fd < 0) return false;
+    const char* data = content.data();
+    size_t remaining = content.size();
+    bool ok = true;
+    while (ok && remaining > 0) {
+        auto written = WAL_WRITE(fd, data, static_cast<unsigned>(remaining));
+        if (written < 0 && errno == EINTR) continue;
+        ok = written > 0;
+        if (ok) {
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+    }
+    ok = ok && WAL_SYNC(fd) == 0;
+    WAL_CLOSE(fd);
+#ifdef _WIN32
+    ok = ok && MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    ok = ok && std::rename(temp.c_str(), path.c_str()) == 0;
+#endif
+    if (!ok) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    syncParentDirectory(path);
+    return true;
+}
+
+// Group commit tuning. ALWAYS by default, so an acknowledged change is on
+// disk; group commit shares each fsync between the writers waiting for it.
+struct WalOptions {
+    WalSyncPolicy policy;
+    std::chrono::microseconds batchWindow;  // Committer waits this long for more records; 0 = none
+    size_t maxBatchRecords;                 // Records per write at most
+    
+    WalOptions() : policy(WalSyncPolicy::ALWAYS), batchWindow(0), maxBatchRecords(1024) {}
+};
+
+struct WalStats {
+    uint64_t segment;
+    uint64_t appended;              // Records since the log was opened
+    uint64_t sinceCheckpoint;       // Records in segments a snapshot doesn't cover yet
+    uint64_t batches;               // Writes by the committer; appended / batches = group size
+    uint64_t syncs;
+    uint64_t writeErrors;
+};
+
+// ============================================================================
+// WRITE-AHEAD LOG - Segmented record log with group commit
+// append() may be called from any thread: it queues the records and returns
+// their sequence number without touching the file. One committer thread
+// writes whatever has queued up (up to maxBatchRecords) in a single write,
+// followed by a single fsync under the ALWAYS policy, and then releases
+// everyone waiting in commit() for a record in the batch. Records arriving
+// during that fsync form the next batch, so concurrent writers share disk
+// flushes instead of queueing behind each other's.
+// A failed write or fsync breaks the segment: records after a torn one
+// could never be replayed, so nothing more is written to it and commit()
+// reports every record since as failed, until rotate() starts a new one.
+// ============================================================================
+class WriteAheadLog {
+private:
+    static const size_t HEADER_SIZE = 8;
+    static const uint32_t MAX_RECORD = 16 * 1024 * 1024;
+
+    std::string base;
+    WalOptions options;
+
+    std::mutex fileMutex;           // fd, segment; held across writes, fsyncs, rotation
+    int fd;
+    std::atomic<uint64_t> segment;  // Also read by getStats()
+
+    std::mutex queueMutex;          // Taken after fileMutex; guards everything below
+    std::condition_variable queued;     // Records arrived, or stopping
+    std::condition_variable released;   // A batch was written (and flushed under ALWAYS), or failed
+    std::condition_variable tick;       // Wakes the EVERYSEC flusher to stop
+    std::deque<std::string> pending;    // Framed records in sequence order
+    uint64_t queuedSeq;             // Last sequence number handed out
+    uint64_t takenSeq;              // Last record taken off the queue for writing
+    uint64_t writtenSeq;            // Last record written to the segment
+    uint64_t durableSeq;            // Last record flushed to disk
+    std::vector<std::pair<uint64_t, uint64_t>> failedRanges;   // Records that never reached the disk, oldest first
+    bool broken;                    // A write or flush failed; nothing more goes to this segment
+    uint64_t rotatedRecords;        // queuedSeq when the current segment started
+    uint64_t batches;
+    uint64_t syncs;
+    uint64_t writeErrors;
+    bool stopping;
+
+    std::atomic<bool> opened;       // Read without the lock by writers deciding whether to log
+    std::thread committer;
+    std::thread syncThread;         // EVERYSEC only
+
+    static void putU32(std::string& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    static uint32_t getU32(const char* in) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+        return value;
+    }
+
+    static bool fileExists(const std::string& path) {
+        struct stat info;
+        return stat(path.c_str(), &info) == 0;
+    }
+
+    static bool writeAll(int file, const char* data, size_t length) {
+        while (length > 0) {
+            auto written = WAL_WRITE(file, data, static_cast<unsigned>(length));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            length -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool openSegment(uint64_t number) {
+        std::string path = segmentPath(base, number);
+        bool created = !fileExists(path);
+        int file = WAL_OPEN(path.c_str());
+        if (file < 0) return false;
+        if (created) syncParentDirectory(path);
+        fd = file;
+        segment = number;
+        return true;
+    }
+
+    // Caller holds queueMutex
+    void markFailed(uint64_t first, uint64_t last) {
+        if (!failedRanges.empty() && first <= failedRanges.back().second + 1) {
+            failedRanges.back().second = std::max(failedRanges.back().second, last);
+        } else {
+            failedRanges.emplace_back(first, last);
+        }
+        broken = true;
+        writeErrors++;
+    }
+    
+    // Caller holds queueMutex
+    bool failed(uint64_t seq) const {
+        for (const auto& range : failedRanges) {
+            if (seq >= range.first && seq <= range.second) return true;
+        }
+        return false;
+    }
+
+    // Write the oldest queued records as one batch; caller holds fileMutex.
+    // On failure the sequence numbers stay put and the batch is marked
+    // failed, which releases its waiters with an error.
+    void writeBatch(bool flush) {
+        std::string data;
+        uint64_t first;
+        uint64_t last;
+        bool skip;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            size_t count = std::min(pending.size(), options.maxBatchRecords);
+            if (count == 0) return;     // rotate() got there first
+            for (size_t i = 0; i < count; i++) {
+                data += pending.front();
+                pending.pop_front();
+            }
+            first = takenSeq + 1;
+            takenSeq += count;
+            last = takenSeq;
+            skip = broken;
+        }
+        bool written = !skip && fd >= 0 && writeAll(fd, data.data(), data.size());
+        bool flushed = written && flush && WAL_SYNC(fd) == 0;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            batches++;
+            if (flushed) syncs++;
+            if (written && (flushed || !flush)) {
+                writtenSeq = last;
+                if (flush) durableSeq = last;
+            } else {
+                markFailed(first, last);
+            }
+        }
+        released.notify_all();
+    }
+
+    void commitLoop() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            queued.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) return;    // Stopping, and everything is written
+            if (options.batchWindow.count() > 0 && !stopping) {
+                queued.wait_for(lock, options.batchWindow,
+                                [this] { return stopping || pending.size() >= options.maxBatchRecords; });
+            }
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> file(fileMutex);
+                writeBatch(options.policy == WalSyncPolicy::ALWAYS);
+            }
+            lock.lock();
+        }
+    }
+
+    // Flush what has been written, once a second
+    void syncLoop() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (!stopping) {
+            tick.wait_for(lock, std::chrono::seconds(1));
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> file(fileMutex);
+                flushWritten();
+            }
+            lock.lock();
+        }
+    }
+
+    // Caller holds fileMutex. A failed fsync may have lost anything since
+    // the last good one, so all of that is marked failed.
+    void flushWritten() {
+        uint64_t covered;
+        uint64_t since;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (broken || durableSeq >= writtenSeq) return;
+            covered = writtenSeq;
+            since = durableSeq;
+        }
+        bool flushed = fd >= 0 && WAL_SYNC(fd) == 0;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (flushed) {
+                durableSeq = std::max(durableSeq, covered);
+                syncs++;
+            } else {
+                markFailed(since + 1, covered);
+            }
+        }
+        // Under ALWAYS a commit() may be waiting for exactly this flush:
+        // rotate() writes queued records itself and leaves the committer
+        // nothing to release them with
+        released.notify_all();
+    }
+
+public:
+    WriteAheadLog()
+        : fd(-1), segment(0), queuedSeq(0), takenSeq(0), writtenSeq(0), durableSeq(0), broken(false),
+          rotatedRecords(0), batches(0), syncs(0), writeErrors(0), stopping(false), opened(false) {}
+
+    ~WriteAheadLog() {
+        close();
+    }
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    static std::string segmentPath(const std::string& base, uint64_t number) {
+        return base + "." + std::to_string(number);
+    }
+
+    // Feed every intact record of segments first, first+1, ... to visit, in
+    // order. last is set to the newest segment present (first - 1 if none).
+    // False when an older segment is damaged; error says where.
+    static bool replay(const std::string& base, uint64_t first,
+                       const std::function<void(const std::string&)>& visit,
+                       uint64_t& last, size_t& records, std::string& error) {
+        records = 0;
+        last = first - 1;
+        for (uint64_t number = first; fileExists(segmentPath(base, number)); number++) {
+            last = number;
+            std::string path = segmentPath(base, number);
+            std::ifstream file(path, std::ios::binary);
+            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            size_t pos = 0;
+            while (pos + HEADER_SIZE <= content.size()) {
+                uint32_t length = getU32(content.data() + pos);
+                uint32_t checksum = getU32(content.data() + pos + 4);
+                if (length > MAX_RECORD || pos + HEADER_SIZE + length > content.size() ||
+                    crc32(content.data() + pos + HEADER_SIZE, length) != checksum) {
+                    break;
+                }
+                visit(content.substr(pos + HEADER_SIZE, length));
+                records++;
+                pos += HEADER_SIZE + length;
+            }
+
+            if (pos < content.size()) {
+                if (fileExists(segmentPath(base, number + 1))) {
+                    error = path + " is damaged at byte " + std::to_string(pos);
+                    return false;
+                }
+                // Torn final append: drop it so new records follow intact ones
+                std::ofstream truncated(path, std::ios::binary | std::ios::trunc);
+                truncated.write(content.data(), static_cast<std::streamsize>(pos));
+            }
+        }
+        return true;
+    }
+
+    // Append to segment number (created if missing)
+    bool open(const std::string& basePath, uint64_t number, const WalOptions& walOptions) {
+        base = basePath;
+        options = walOptions;
+        options.maxBatchRecords = std::max<size_t>(options.maxBatchRecords, 1);
+        if (!openSegment(number)) return false;
+        stopping = false;
+        opened = true;
+        committer = std::thread(&WriteAheadLog::commitLoop, this);
+        if (options.policy == WalSyncPolicy::EVERYSEC) {
+            syncThread = std::thread(&WriteAheadLog::syncLoop, this);
+        }
+        return true;
+    }
+
+    bool isOpen() const { return opened.load(); }
+    WalSyncPolicy getPolicy() const { return options.policy; }
+
+    // Queue records back to back for the committer; returns the sequence
+    // number of the last one, or 0 if the log is closed
+    uint64_t append(const std::vector<std::string>& payloads) {
+        std::vector<std::string> frames;
+        frames.reserve(payloads.size());
+        for (const std::string& payload : payloads) {
+            std::string frame;
+            frame.reserve(HEADER_SIZE + payload.size());
+            putU32(frame, static_cast<uint32_t>(payload.size()));
+            putU32(frame, crc32(payload.data(), payload.size()));
+            frame += payload;
+            frames.push_back(std::move(frame));
+        }
+        uint64_t seq;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (stopping || !opened) return 0;
+            for (std::string& frame : frames) {
+                pending.push_back(std::move(frame));
+            }
+            queuedSeq += frames.size();
+            seq = queuedSeq;
+        }
+        queued.notify_one();
+        return seq;
+    }
+
+    // Returns true once record seq is in the file, and on disk under
+    // ALWAYS; false if it never will be, and the change must not be
+    // acknowledged. Sequence number 0 (nothing logged) is always true.
+    bool commit(uint64_t seq) {
+        if (seq == 0) return true;
+        std::unique_lock<std::mutex> lock(queueMutex);
+        bool always = options.policy == WalSyncPolicy::ALWAYS;
+        released.wait(lock, [&] { return failed(seq) || (always ? durableSeq : writtenSeq) >= seq; });
+        return !failed(seq);
+    }
+
+    // Finish the current segment and start the next; returns its number.
+    // Everything appended before the call is in older segments.
+    uint64_t rotate() {
+        std::lock_guard<std::mutex> file(fileMutex);
+        if (fd < 0) return segment;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (pending.empty()) break;
+            }
+            writeBatch(false);
+        }
+        if (options.policy != WalSyncPolicy::NEVER) flushWritten();
+        WAL_CLOSE(fd);
+        fd = -1;
+        if (!openSegment(segment + 1)) {
+            // Keep logging to the old segment rather than not at all
+            fd = WAL_OPEN(segmentPath(base, segment).c_str());
+            return segment;
+        }
+        std::lock_guard<std::mutex> lock(queueMutex);
+        rotatedRecords = takenSeq;
+        broken = false;     // The snapshot about to be written covers what failed
+        return segment;
+    }
+
+    // Delete segments older than number, now that a snapshot covers them
+    void removeBefore(uint64_t number) {
+        for (uint64_t old = number - 1; old > 0 && fileExists(segmentPath(base, old)); old--) {
+            std::remove(segmentPath(base, old).c_str());
+        }
+    }
+
+    // Write out what is queued, then stop
+    void close() {
+        opened = false;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queued.notify_all();
+        tick.notify_all();
+        if (committer.joinable()) committer.join();
+        if (syncThread.joinable()) syncThread.join();
+        std::lock_guard<std::mutex> file(fileMutex);
+        if (fd >= 0) {
+            if (options.policy != WalSyncPolicy::NEVER) WAL_SYNC(fd);
+            WAL_CLOSE(fd);
+            fd = -1;
+        }
+    }
+
+    WalStats getStats() {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        WalStats stats;
+        stats.segment = segment;
+        stats.appended = queuedSeq;
+        stats.sinceCheckpoint = queuedSeq - rotatedRecords;
+        stats.batches = batches;
+        stats.syncs = syncs;
+        stats.writeErrors = writeErrors;
+        return stats;
+    }
+};
+
+#endif // WAL_H
@@ -0,0 +1,142 @@
+//
+// WorkerPool.h - Fixed-size thread pool with a bounded, deadline-aware queue
+//
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Snapshot of pool counters for the metrics endpoint
+struct WorkerPoolStats {
+    size_t threads;
+    size_t queueCapacity;
+    size_t queueDepth;
+    size_t peakQueueDepth;
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t rejected;      // Refused because the queue was full
+    uint64_t expired;       // Waited past the queueing deadline
+};
+
+// ============================================================================
+// WORKER POOL - Admission control for request handling
+// trySubmit() never blocks: when the queue is full the caller is told so and
+// can shed the load. Tasks that sat in the queue longer than the deadline run
+// their onExpired handler instead of the task itself.
+// ============================================================================
+class WorkerPool {
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct QueuedTask {
+        Task task;
+        Task onExpired;
+        std::chrono::steady_clock::time_point enqueuedAt;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<QueuedTask> queue;
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    size_t maxQueueDepth;
+    std::chrono::milliseconds deadline;
+    bool stopping;
+
+    size_t peakQueueDepth;
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> completed;
+    std::atomic<uint64_t> rejected;
+    std::atomic<uint64_t> expired;
+
+    void workerLoop() {
+        while (true) {
+            QueuedTask next;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return; // Stopping and drained
+                next = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            bool late = deadline.count() > 0 &&
+                        std::chrono::steady_clock::now() - next.enqueuedAt > deadline;
+            if (late) {
+                expired++;
+                if (next.onExpired) next.onExpired();
+            } else {
+                next.task();
+                completed++;
+            }
+        }
+    }
+
+public:
+    WorkerPool(size_t threadCount, size_t maxQueueDepth,
+               std::chrono::milliseconds deadline = std::chrono::milliseconds(0))
+        : maxQueueDepth(maxQueueDepth), deadline(deadline), stopping(false), peakQueueDepth(0),
+          submitted(0), completed(0), rejected(0), expired(0) {
+        if (threadCount == 0) threadCount = 1;
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Returns false without queueing when the pool is saturated
+    bool trySubmit(Task task, Task onExpired = nullptr) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping || queue.size() >= maxQueueDepth) {
+                rejected++;
+                return false;
+            }
+            queue.push_back({std::move(task), std::move(onExpired), std::chrono::steady_clock::now()});
+            peakQueueDepth = std::max(peakQueueDepth, queue.size());
+        }
+        submitted++;
+        available.notify_one();
+        return true;
+    }
+
+    WorkerPoolStats getStats() const {
+        WorkerPoolStats stats;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.queueDepth = queue.size();
+            stats.peakQueueDepth = peakQueueDepth;
+        }
+        stats.threads = workers.size();
+        stats.queueCapacity = maxQueueDepth;
+        stats.submitted = submitted;
+        stats.completed = completed;
+        stats.rejected = rejected;
+        stats.expired = expired;
+        return stats;
+    }
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,71 @@
+//
+// Bench.h - Timing helpers shared by the benchmark executables
+//
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Keeps a result alive so the optimizer can't drop the work behind it
+template <typename T>
+inline void keep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+class Stopwatch {
+private:
+    std::chrono::steady_clock::time_point started;
+
+public:
+    Stopwatch() : started(std::chrono::steady_clock::now()) {}
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    double millis() const { return seconds() * 1000.0; }
+};
+
+// Nanoseconds per call of work, over enough calls to run for about minSeconds
+template <typename Work>
+inline double nanosPerCall(Work work, double minSeconds = 0.2) {
+    size_t calls = 1;
+    while (true) {
+        Stopwatch watch;
+        for (size_t i = 0; i < calls; i++) work(i);
+        double elapsed = watch.seconds();
+        if (elapsed >= minSeconds) return elapsed * 1e9 / static_cast<double>(calls);
+        calls *= elapsed < minSeconds / 16 ? 16 : 2;
+    }
+}
+
+// Value at fraction (0..1) of the samples, which are sorted in place
+inline double percentile(std::vector<double>& samples, double fraction) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t at = static_cast<size_t>(fraction * static_cast<double>(samples.size() - 1) + 0.5);
+    return samples[std::min(at, samples.size() - 1)];
+}
+
+// --name=N from the command line, or fallback
+inline long long benchOption(int argc, char* argv[], const std::string& name, long long fallback) {
+    std::string prefix = "--" + name + "=";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind(prefix, 0) == 0) return std::atoll(arg.c_str() + prefix.size());
+    }
+    return fallback;
+}
+
+#endif // BENCH_H
@@ -0,0 +1,290 @@
+//
+// LoadClient.h - Runs the server as a child process and drives it with
+// HTTP load from client threads, for the server benchmarks (POSIX only)
+//
+
+#ifndef LOAD_CLIENT_H
+#define LOAD_CLIENT_H
+
+#include "Bench.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/ptrace.h>
+#endif
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// ============================================================================
+// SERVER PROCESS - The server binary started in a scratch directory holding
+// a copy of the sample data, stopped with SIGINT like from a terminal.
+// Started with traceSyscalls it runs under ptrace from a tracer thread that
+// counts every system call of every server thread; that slows the server
+// down, so measure throughput and latency on an untraced one.
+// ============================================================================
+class ServerProcess {
+private:
+    pid_t pid;
+    std::string directory;
+    std::thread tracer;
+    std::atomic<pid_t> tracedPid;
+    std::atomic<uint64_t> syscallStops;
+
+    // Forks and execs the server; with traced the child stops itself before
+    // exec so the caller can set ptrace options first
+    pid_t launch(std::vector<std::string> argv, bool traced) {
+        pid_t child = fork();
+        if (child != 0) return child;
+        std::vector<char*> raw;
+        for (std::string& arg : argv) raw.push_back(&arg[0]);
+        raw.push_back(nullptr);
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        if (chdir(directory.c_str()) != 0) _exit(127);
+#ifdef __linux__
+        if (traced) {
+            ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+            raise(SIGSTOP);
+        }
+#endif
+        execv(argv[0].c_str(), raw.data());
+        _exit(127);
+    }
+
+#ifdef __linux__
+    // Runs on the tracer thread, which must be the one that forked: resumes
+    // every tracee to its next syscall entry or exit until all have exited
+    void traceUntilExit(std::vector<std::string> argv) {
+        pid_t child = launch(argv, true);
+        tracedPid = child;
+        if (child < 0) return;
+        int status;
+        if (waitpid(child, &status, 0) != child || !WIFSTOPPED(status)) return;
+        ptrace(PTRACE_SETOPTIONS, child, nullptr,
+               PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_EXITKILL);
+        ptrace(PTRACE_SYSCALL, child, nullptr, nullptr);
+        pid_t tid;
+        while ((tid = waitpid(-1, &status, __WALL)) > 0) {
+            if (!WIFSTOPPED(status)) continue;      // A thread exited
+            int signal = WSTOPSIG(status);
+            if (signal == (SIGTRAP | 0x80)) {
+                syscallStops.fetch_add(1, std::memory_order_relaxed);
+                signal = 0;
+            } else if (signal == SIGTRAP || (signal == SIGSTOP && (status >> 16) == 0 && tid != child)) {
+                signal = 0;                         // Clone event, or a new thread's first stop
+            }
+            ptrace(PTRACE_SYSCALL, tid, nullptr, reinterpret_cast<void*>(static_cast<long>(signal)));
+        }
+    }
+#endif
+
+public:
+    ServerProcess() : pid(-1), tracedPid(0), syscallStops(0) {}
+
+    ~ServerProcess() {
+        stop();
+    }
+
+    ServerProcess(const ServerProcess&) = delete;
+    ServerProcess& operator=(const ServerProcess&) = delete;
+
+    // False if it didn't start listening on port within a few seconds
+    bool start(const std::string& binary, const std::string& sampleData, int port,
+               const std::vector<std::string>& arguments, bool traceSyscalls = false) {
+        char pattern[] = "/tmp/lostfound-bench-XXXXXX";
+        if (mkdtemp(pattern) == nullptr) return false;
+        directory = pattern;
+        {
+            std::ifstream in(sampleData, std::ios::binary);
+            std::ofstream out(directory + "/data.json", std::ios::binary);
+            out << in.rdbuf();
+        }
+
+        std::vector<std::string> argv = {binary, "--port=" + std::to_string(port), "--log-level=off"};
+        argv.insert(argv.end(), arguments.begin(), arguments.end());
+        if (traceSyscalls) {
+#ifdef __linux__
+            tracer = std::thread(&ServerProcess::traceUntilExit, this, argv);
+            while (tracedPid == 0) std::this_thread::yield();
+            pid = tracedPid;
+#else
+            return false;
+#endif
+        } else {
+            pid = launch(argv, false);
+        }
+        if (pid < 0) return false;
+
+        for (int attempt = 0; attempt < 100; attempt++) {
+            usleep(50 * 1000);
+            int fd = connectTo(port);
+            if (fd >= 0) {
+                close(fd);
+                return true;
+            }
+            if (!tracer.joinable() && waitpid(pid, nullptr, WNOHANG) == pid) {
+                pid = -1;
+                return false;
+            }
+        }
+        return false;
+    }
+
+    pid_t getPid() const { return pid; }
+
+    // Syscalls made so far by a server started with traceSyscalls; each one
+    // stops the tracee on entry and again on exit
+    uint64_t syscalls() const {
+        return syscallStops.load(std::memory_order_relaxed) / 2;
+    }
+
+    void stop() {
+        if (tracer.joinable()) {
+            if (pid > 0) kill(pid, SIGINT);
+            tracer.join();
+            pid = -1;
+        } else if (pid > 0) {
+            kill(pid, SIGINT);
+            waitpid(pid, nullptr, 0);
+            pid = -1;
+        }
+        if (!directory.empty()) {
+            std::string command = "rm -rf '" + directory + "'";
+            if (std::system(command.c_str()) != 0) std::fprintf(stderr, "cannot remove %s\n", directory.c_str());
+            directory.clear();
+        }
+    }
+
+    static int connectTo(int port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        return fd;
+    }
+};
+
+inline bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// One whole response off fd; buffer carries bytes read past it to the next
+// call. False on a closed connection or a response without Content-Length.
+// closing is set when the server will close the connection after it.
+inline bool readResponse(int fd, std::string& buffer, int& status, bool& closing) {
+    char chunk[16384];
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    status = buffer.size() > 12 ? std::atoi(buffer.c_str() + 9) : 0;
+    size_t lengthAt = buffer.find("Content-Length:");
+    if (lengthAt == std::string::npos || lengthAt > headerEnd) return false;
+    size_t closeAt = buffer.find("Connection: close");
+    closing = closeAt != std::string::npos && closeAt < headerEnd;
+    size_t total = headerEnd + 4 + static_cast<size_t>(std::atoll(buffer.c_str() + lengthAt + 15));
+    while (buffer.size() < total) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    buffer.erase(0, total);
+    return true;
+}
+
+struct LoadResult {
+    double seconds;
+    size_t requests;
+    size_t errors;
+    std::vector<double> latenciesMicros;
+
+    double rate() const { return seconds > 0 ? static_cast<double>(requests) / seconds : 0; }
+};
+
+// clients threads send request for seconds, each over one keep-alive
+// connection, or over a new connection per request when keepAlive is false
+inline LoadResult runLoad(int port, int clients, double seconds, bool keepAlive, const std::string& path) {
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n" +
+                          (keepAlive ? "" : "Connection: close\r\n") + "\r\n";
+    LoadResult result;
+    result.requests = 0;
+    result.errors = 0;
+    std::mutex resultMutex;
+    std::atomic<bool> running(true);
+    Stopwatch total;
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&] {
+            std::vector<double> latencies;
+            size_t errors = 0;
+            int fd = -1;
+            std::string buffer;
+            while (running) {
+                Stopwatch watch;
+                if (fd < 0) {
+                    fd = ServerProcess::connectTo(port);
+                    buffer.clear();
+                }
+                int status = 0;
+                bool closing = false;
+                bool ok = fd >= 0 && sendAll(fd, request) && readResponse(fd, buffer, status, closing) && status == 200;
+                if (ok) {
+                    latencies.push_back(watch.seconds() * 1e6);
+                } else {
+                    errors++;
+                }
+                if (fd >= 0 && (!ok || closing || !keepAlive)) {
+                    close(fd);
+                    fd = -1;
+                }
+            }
+            if (fd >= 0) close(fd);
+            std::lock_guard<std::mutex> lock(resultMutex);
+            result.requests += latencies.size();
+            result.errors += errors;
+            result.latenciesMicros.insert(result.latenciesMicros.end(), latencies.begin(), latencies.end());
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    running = false;
+    for (std::thread& thread : threads) thread.join();
+    result.seconds = total.seconds();
+    return result;
+}
+
+#endif // LOAD_CLIENT_H
@@ -0,0 +1,48 @@
+//
+// accept_bench.cpp - Connections accepted per second and request latency
+// with one acceptor per core (--loops=N --reuseport --pin-cpus), for N
+// from 1 up to the core count. Every request opens a new connection, so
+// the accept path is what is measured.
+//
+// Usage: accept_bench [--seconds=N] [--clients=N] [--port=N] [--max-loops=N]
+//
+
+#include "LoadClient.h"
+#include <thread>
+
+int main(int argc, char* argv[]) {
+    double seconds = static_cast<double>(benchOption(argc, argv, "seconds", 3));
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int clients = static_cast<int>(benchOption(argc, argv, "clients", 4 * cores));
+    int port = static_cast<int>(benchOption(argc, argv, "port", 18080));
+    int maxLoops = static_cast<int>(benchOption(argc, argv, "max-loops", cores));
+
+    std::printf("%d cores, %d clients, new connection per request (client and server share the host)\n",
+                cores, clients);
+    std::printf("%-8s %14s %10s %10s %10s %8s\n", "loops", "conns/s", "p50 us", "p99 us", "p99.9 us", "errors");
+    std::vector<int> loopCounts;
+    for (int loops = 1; loops < maxLoops; loops *= 2) loopCounts.push_back(loops);
+    loopCounts.push_back(std::max(1, maxLoops));
+
+    for (int loops : loopCounts) {
+        ServerProcess server;
+        std::vector<std::string> arguments = {"--io=epoll", "--loops=" + std::to_string(loops)};
+        if (loops > 1) {
+            arguments.push_back("--reuseport");
+            arguments.push_back("--pin-cpus");
+        }
+        if (!server.start(SERVER_PATH, SAMPLE_DATA, port, arguments)) {
+            std::fprintf(stderr, "server did not start with %d loops\n", loops);
+            return 1;
+        }
+        runLoad(port, clients, 0.5, false, "/api/stats");   // Warm up
+        LoadResult result = runLoad(port, clients, seconds, false, "/api/stats");
+        double p50 = percentile(result.latenciesMicros, 0.50);
+        double p99 = percentile(result.latenciesMicros, 0.99);
+        double p999 = percentile(result.latenciesMicros, 0.999);
+        std::printf("%-8d %14.0f %10.0f %10.0f %10.0f %8zu\n", loops, result.rate(), p50, p99, p999, result.errors);
+        std::fflush(stdout);
+        server.stop();
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+//
+// backend_bench.cpp - Requests per second, p50/p99 latency and syscalls
+// per request for each I/O backend (--io=epoll|uring|threads) under
+// keep-alive load. Syscalls are counted on a second, ptrace'd run of the
+// same load, across all server threads, so they include the event loop,
+// the worker pool and anything else the server does meanwhile.
+//
+// Usage: backend_bench [--seconds=N] [--clients=N] [--port=N]
+//
+
+#include "LoadClient.h"
+
+int main(int argc, char* argv[]) {
+    double seconds = static_cast<double>(benchOption(argc, argv, "seconds", 3));
+    int clients = static_cast<int>(benchOption(argc, argv, "clients", 16));
+    int port = static_cast<int>(benchOption(argc, argv, "port", 18080));
+    const char* backends[] = {"epoll", "uring", "threads"};
+
+    std::printf("%d keep-alive clients, GET /api/stats (client and server share the host)\n", clients);
+    std::printf("%-8s %12s %10s %10s %14s %8s\n", "backend", "req/s", "p50 us", "p99 us", "syscalls/req", "errors");
+    for (const char* backend : backends) {
+        std::vector<std::string> arguments = {std::string("--io=") + backend};
+
+        ServerProcess server;
+        if (!server.start(SERVER_PATH, SAMPLE_DATA, port, arguments)) {
+            std::fprintf(stderr, "server did not start with --io=%s\n", backend);
+            return 1;
+        }
+        runLoad(port, clients, 0.5, true, "/api/stats");    // Warm up
+        LoadResult result = runLoad(port, clients, seconds, true, "/api/stats");
+        server.stop();
+
+        ServerProcess traced;
+        double syscallsPerRequest = -1;
+        if (traced.start(SERVER_PATH, SAMPLE_DATA, port, arguments, true)) {
+            runLoad(port, clients, 0.5, true, "/api/stats");
+            uint64_t before = traced.syscalls();
+            LoadResult tracedResult = runLoad(port, clients, seconds, true, "/api/stats");
+            uint64_t after = traced.syscalls();
+            if (tracedResult.requests > 0) {
+                syscallsPerRequest = static_cast<double>(after - before) / static_cast<double>(tracedResult.requests);
+            }
+            traced.stop();
+        }
+
+        double p50 = percentile(result.latenciesMicros, 0.50);
+        double p99 = percentile(result.latenciesMicros, 0.99);
+        if (syscallsPerRequest < 0) {
+            std::printf("%-8s %12.0f %10.0f %10.0f %14s %8zu\n", backend, result.rate(), p50, p99, "n/a", result.errors);
+        } else {
+            std::printf("%-8s %12.0f %10.0f %10.0f %14.2f %8zu\n", backend, result.rate(), p50, p99,
+                        syscallsPerRequest, result.errors);
+        }
+        std::fflush(stdout);
+    }
+    return 0;
+}
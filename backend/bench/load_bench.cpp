@@ -0,0 +1,119 @@
+//
+// load_bench.cpp - Startup time for 10k, 100k and 1M items: the legacy
+// JSON file through loadFromFile() against the binary snapshot through
+// loadSnapshot(), with the index image and with the indexes rebuilt.
+// One item in five is archived, so the snapshot has cold segments too.
+//
+// Usage: load_bench [--max-items=N]
+//
+
+#include "Bench.h"
+#include "System.h"
+#include <fstream>
+#include <ctime>
+#include <sys/stat.h>
+
+static const char* NAMES[] = {"phone", "wallet", "keys", "laptop", "bag", "umbrella", "jacket", "bottle",
+                              "headphones", "charger", "notebook", "watch", "glasses", "id card", "calculator"};
+static const char* COLORS[] = {"black", "white", "red", "blue", "green", "grey", "brown", ""};
+static const char* LOCATIONS[] = {"library", "cafeteria", "c-block", "fmc-building", "ausom", "sports complex",
+                                  "parking", "auditorium"};
+static const char* CATEGORIES[] = {"electronics", "accessories", "clothing", "documents", "bags", "keys", "other"};
+
+template <size_t N>
+static const char* pick(const char* (&choices)[N], size_t i) {
+    return choices[i % N];
+}
+
+// An items file in the layout saveToFile() writes, newest item first
+static bool writeItemsFile(const std::string& path, size_t count) {
+    std::ofstream file(path, std::ios::binary);
+    long long now = static_cast<long long>(std::time(nullptr));
+    file << "{\n  \"itemCounter\": " << count << ",\n  \"webhookUrl\": \"\",\n  \"claimWebhookUrl\": \"\",\n"
+         << "  \"items\": [";
+    char buffer[1024];
+    for (size_t n = count; n > 0; n--) {
+        size_t i = n * 2654435761u;     // Scatter the choices across ids
+        long long timestamp = now - static_cast<long long>(count - n) * 7;
+        bool archived = n % 5 == 0;
+        bool claimed = archived && n % 10 == 0;
+        std::snprintf(buffer, sizeof(buffer),
+                      "%s\n    {\n      \"id\": \"ITEM-%06zu\",\n      \"name\": \"%s %zu\",\n"
+                      "      \"color\": \"%s\",\n      \"location\": \"%s\",\n      \"owner\": \"owner %zu\",\n"
+                      "      \"email\": \"owner%zu@example.com\",\n      \"type\": \"%s\",\n"
+                      "      \"timestamp\": %lld,\n      \"description\": \"a %s %s left near the %s\",\n"
+                      "      \"category\": \"%s\",\n      \"archived\": %s,\n      \"expiresAt\": %lld,\n"
+                      "      \"claimed\": %s,\n      \"claimedBy\": \"%s\",\n      \"claimedAt\": %lld\n    }",
+                      n == count ? "" : ",", n, pick(NAMES, i), i % 1000, pick(COLORS, i / 7), pick(LOCATIONS, i / 3),
+                      n % 5000, n % 5000, i % 3 == 0 ? "found" : "lost", timestamp, pick(COLORS, i / 7),
+                      pick(NAMES, i), pick(LOCATIONS, i / 3), pick(CATEGORIES, i / 11),
+                      archived ? "true" : "false", timestamp + 30LL * 24 * 60 * 60, claimed ? "true" : "false",
+                      claimed ? "claimer" : "", claimed ? timestamp + 3600 : 0LL);
+        file << buffer;
+    }
+    file << "\n  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+static double megabytes(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<double>(info.st_size) / (1024.0 * 1024.0) : 0;
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxItems = static_cast<size_t>(benchOption(argc, argv, "max-items", 1000000));
+    char pattern[] = "/tmp/lostfound-bench-XXXXXX";
+    if (mkdtemp(pattern) == nullptr) {
+        std::fprintf(stderr, "cannot create a scratch directory\n");
+        return 1;
+    }
+    std::string directory = pattern;
+    WalOptions options;
+    options.policy = WalSyncPolicy::NEVER;
+
+    std::printf("%-9s %10s %10s %10s %14s %14s\n", "items", "json MB", "snap MB", "json ms", "snap+image ms",
+                "snap+rebuild ms");
+    for (size_t count = 10000; count <= maxItems; count *= 10) {
+        std::string jsonPath = directory + "/items-" + std::to_string(count) + ".json";
+        std::string snapPath = directory + "/items-" + std::to_string(count) + ".snap";
+        if (!writeItemsFile(jsonPath, count)) {
+            std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+
+        double jsonMs;
+        {
+            LostFoundSystem system;
+            Stopwatch watch;
+            bool loaded = system.loadFromFile(jsonPath);
+            jsonMs = watch.millis();
+            std::string error;
+            if (!loaded || system.getAllItems().size() != count || system.openLog(snapPath, options, error) < 0 ||
+                !system.checkpoint()) {
+                std::fprintf(stderr, "cannot load %s or write its snapshot\n", jsonPath.c_str());
+                return 1;
+            }
+        }
+
+        double imageMs = 0, rebuildMs = 0;
+        for (double* elapsed : {&imageMs, &rebuildMs}) {
+            if (elapsed == &rebuildMs) std::remove((snapPath + ".idx").c_str());
+            LostFoundSystem system;
+            std::string error;
+            Stopwatch watch;
+            bool loaded = system.loadSnapshot(snapPath, error);
+            *elapsed = watch.millis();
+            if (!loaded || system.indexesFromImage() != (elapsed == &imageMs)) {
+                std::fprintf(stderr, "cannot load %s: %s\n", snapPath.c_str(), error.c_str());
+                return 1;
+            }
+        }
+
+        std::printf("%-9zu %10.1f %10.1f %10.1f %14.1f %14.1f\n", count, megabytes(jsonPath), megabytes(snapPath),
+                    jsonMs, imageMs, rebuildMs);
+        std::fflush(stdout);
+    }
+
+    std::string command = "rm -rf '" + directory + "'";
+    return std::system(command.c_str()) == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+//
+// router_bench.cpp - Route lookup through the Router trie against the
+// if/else chain of string compares it replaced, per path and over a mix.
+// The chain is kept here as it was, minus the handler bodies.
+//
+
+#include "Bench.h"
+#include "Router.h"
+#include <string>
+#include <vector>
+
+struct Request {
+    const char* method;
+    const char* path;
+};
+
+// Same table, in the same order, as HttpServer::registerRoutes()
+static const Request ROUTES[] = {
+    {"POST", "/api/lost"}, {"GET", "/api/lost"}, {"POST", "/api/found"}, {"GET", "/api/found"},
+    {"GET", "/api/search"}, {"GET", "/api/search/advanced"}, {"GET", "/api/history"},
+    {"GET", "/api/items"}, {"GET", "/api/items/active"}, {"GET", "/api/items/archived"},
+    {"GET", "/api/locations"}, {"GET", "/api/categories"}, {"GET", "/api/category/{name}"},
+    {"GET", "/api/stats"}, {"GET", "/api/metrics"}, {"GET", "/api/analytics"},
+    {"POST", "/api/archive/expired"}, {"POST", "/api/item/{id}/claim"}, {"POST", "/api/item/{id}/archive"},
+    {"DELETE", "/api/item/{id}"}, {"GET", "/api/webhook"}, {"POST", "/api/webhook"},
+    {"GET", "/api/webhook/config"}, {"POST", "/api/webhook/config"}, {"GET", "/api/webhook/claim"},
+    {"POST", "/api/webhook/claim"}, {"*", "/"}, {"*", "/api"},
+};
+
+// Early, middle and late in the old chain, with and without parameters
+static const Request REQUESTS[] = {
+    {"POST", "/api/lost"},
+    {"GET", "/api/stats"},
+    {"GET", "/api/analytics"},
+    {"GET", "/api/category/electronics"},
+    {"POST", "/api/item/ITEM-000042/claim"},
+    {"GET", "/api/webhook/claim"},
+    {"DELETE", "/api/item/ITEM-000042"},
+    {"GET", "/api/does/not/exist"},
+};
+
+// The chain in handleRequest before the router: returns a route number,
+// or -1 for 404, extracting the id or category the way it did
+static int legacyDispatch(const std::string& method, const std::string& path, std::string& param) {
+    if (method == "OPTIONS") return 0;
+    if (path == "/api/lost" && method == "POST") return 1;
+    else if (path == "/api/found" && method == "POST") return 2;
+    else if (path == "/api/search" && method == "GET") return 3;
+    else if (path == "/api/search/advanced" && method == "GET") return 4;
+    else if (path == "/api/history" && method == "GET") return 5;
+    else if (path == "/api/items" && method == "GET") return 6;
+    else if (path == "/api/items/active" && method == "GET") return 7;
+    else if (path == "/api/items/archived" && method == "GET") return 8;
+    else if (path == "/api/locations" && method == "GET") return 9;
+    else if (path == "/api/categories" && method == "GET") return 10;
+    else if (path.rfind("/api/category/", 0) == 0 && method == "GET") {
+        param = path.substr(14);
+        return 11;
+    }
+    else if (path == "/api/lost" && method == "GET") return 12;
+    else if (path == "/api/found" && method == "GET") return 13;
+    else if (path == "/api/stats" && method == "GET") return 14;
+    else if (path == "/api/webhook/config" && method == "POST") return 15;
+    else if (path == "/api/webhook/config" && method == "GET") return 16;
+    else if (path == "/api/archive/expired" && method == "POST") return 17;
+    else if (path == "/api/analytics" && method == "GET") return 18;
+    else if (path.rfind("/api/item/", 0) == 0 && path.find("/claim") != std::string::npos && method == "POST") {
+        size_t claimPos = path.find("/claim");
+        param = path.substr(10, claimPos - 10);
+        return 19;
+    }
+    else if (path.rfind("/api/item/", 0) == 0 && path.find("/archive") != std::string::npos && method == "POST") {
+        size_t archivePos = path.find("/archive");
+        param = path.substr(10, archivePos - 10);
+        return 20;
+    }
+    else if (path == "/api/webhook" && method == "GET") return 21;
+    else if (path == "/api/webhook" && method == "POST") return 22;
+    else if (path == "/api/webhook/claim" && method == "GET") return 23;
+    else if (path == "/api/webhook/claim" && method == "POST") return 24;
+    else if (path == "/" || path == "/api") return 25;
+    else if (path.rfind("/api/item/", 0) == 0 && method == "DELETE") {
+        param = path.substr(10);
+        return 26;
+    }
+    return -1;
+}
+
+int main() {
+    Router<int> router;
+    int number = 0;
+    for (const Request& route : ROUTES) {
+        router.add(route.method, route.path, number++);
+    }
+    size_t requestCount = sizeof(REQUESTS) / sizeof(REQUESTS[0]);
+    std::vector<std::string> methods, paths;
+    for (const Request& request : REQUESTS) {
+        methods.push_back(request.method);
+        paths.push_back(request.path);
+    }
+
+    auto routed = [&](size_t i) {
+        RouteParams params;
+        Router<int>::Match match = router.match(methods[i], paths[i], params);
+        keep(match);
+        keep(params);
+    };
+    auto chained = [&](size_t i) {
+        std::string param;
+        int route = legacyDispatch(methods[i], paths[i], param);
+        keep(route);
+        keep(param);
+    };
+
+    std::printf("%-40s %12s %12s\n", "request", "router ns", "if/else ns");
+    for (size_t r = 0; r < requestCount; r++) {
+        double routerNs = nanosPerCall([&](size_t) { routed(r); });
+        double chainNs = nanosPerCall([&](size_t) { chained(r); });
+        std::string label = methods[r] + " " + paths[r];
+        std::printf("%-40s %12.1f %12.1f\n", label.c_str(), routerNs, chainNs);
+    }
+    double routerMix = nanosPerCall([&](size_t i) { routed(i % requestCount); });
+    double chainMix = nanosPerCall([&](size_t i) { chained(i % requestCount); });
+    std::printf("%-40s %12.1f %12.1f\n", "mix of the above", routerMix, chainMix);
+    return 0;
+}
@@ -0,0 +1,307 @@
+//
+// trie_bench.cpp - Memory per key, build time and lookups per second of
+// the flat-array Trie against the node-per-character trie it replaced.
+// The old trie is kept here as it was, minus its index image code.
+// Memory is the bytes requested through operator new while the trie is
+// built, so allocator overhead per node comes on top for the old one.
+// Then fuzzyAutocomplete() on misspelled prefixes, against exact lookups of
+// the same prefixes and against scanning every word for one within reach.
+//
+// Usage: trie_bench [--names=N]
+//
+
+#include "Bench.h"
+#include "DataStructures.h"
+#include <atomic>
+#include <new>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+static std::atomic<size_t> liveBytes(0);
+
+// Each block carries its size in front, so delete can subtract it
+static const size_t HEADER = alignof(std::max_align_t);
+
+void* operator new(size_t size) {
+    void* block = std::malloc(size + HEADER);
+    if (block == nullptr) throw std::bad_alloc();
+    *static_cast<size_t*>(block) = size;
+    liveBytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<char*>(block) + HEADER;
+}
+
+void operator delete(void* pointer) noexcept {
+    if (pointer == nullptr) return;
+    void* block = static_cast<char*>(pointer) - HEADER;
+    liveBytes.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+class LegacyTrieNode {
+public:
+    std::unordered_map<char, LegacyTrieNode*> children;
+    bool isEndOfWord;
+    std::string fullWord;
+
+    LegacyTrieNode() : isEndOfWord(false) {}
+
+    ~LegacyTrieNode() {
+        for (auto& pair : children) {
+            delete pair.second;
+        }
+    }
+};
+
+class LegacyTrie {
+private:
+    LegacyTrieNode* root;
+
+    void collectWords(LegacyTrieNode* node, std::vector<std::string>& results, int limit) {
+        if (results.size() >= static_cast<size_t>(limit)) return;
+
+        if (node->isEndOfWord) {
+            results.push_back(node->fullWord);
+        }
+
+        for (auto& pair : node->children) {
+            collectWords(pair.second, results, limit);
+        }
+    }
+
+public:
+    LegacyTrie() {
+        root = new LegacyTrieNode();
+    }
+
+    ~LegacyTrie() {
+        delete root;
+    }
+
+    void insert(const std::string& word) {
+        LegacyTrieNode* current = root;
+        std::string lowerWord = word;
+        std::transform(lowerWord.begin(), lowerWord.end(), lowerWord.begin(), ::tolower);
+
+        for (char c : lowerWord) {
+            if (current->children.find(c) == current->children.end()) {
+                current->children[c] = new LegacyTrieNode();
+            }
+            current = current->children[c];
+        }
+        current->isEndOfWord = true;
+        current->fullWord = word;
+    }
+
+    bool search(const std::string& word) {
+        LegacyTrieNode* current = root;
+        std::string lowerWord = word;
+        std::transform(lowerWord.begin(), lowerWord.end(), lowerWord.begin(), ::tolower);
+
+        for (char c : lowerWord) {
+            auto child = current->children.find(c);
+            if (child == current->children.end()) {
+                return false;
+            }
+            current = child->second;
+        }
+        return current->isEndOfWord;
+    }
+
+    std::vector<std::string> autocomplete(const std::string& prefix, int limit = 10) {
+        std::vector<std::string> results;
+        LegacyTrieNode* current = root;
+        std::string lowerPrefix = prefix;
+        std::transform(lowerPrefix.begin(), lowerPrefix.end(), lowerPrefix.begin(), ::tolower);
+
+        for (char c : lowerPrefix) {
+            auto child = current->children.find(c);
+            if (child == current->children.end()) {
+                return results;
+            }
+            current = child->second;
+        }
+
+        collectWords(current, results, limit);
+        return results;
+    }
+};
+
+static const char* BRANDS[] = {"Apple", "Samsung", "Sony", "Dell", "HP", "Casio", "Nike", "Adidas", "Lenovo",
+                               "Xiaomi", "Anker", "JBL", "Bose", "Parker", "Milton", "Oxford"};
+static const char* COLORS[] = {"black", "white", "red", "blue", "green", "grey", "silver", "pink", "brown"};
+static const char* NOUNS[] = {"phone", "wallet", "keys", "laptop", "bag", "umbrella", "jacket", "bottle",
+                              "headphones", "charger", "notebook", "watch", "glasses", "id card", "calculator",
+                              "earbuds", "power bank", "hoodie", "water bottle", "textbook", "usb drive", "mouse"};
+
+// Names the way students type them: brand, colour, thing, sometimes a model
+// number, with the capitalization varying between reports
+static std::vector<std::string> makeNames(size_t count) {
+    std::vector<std::string> names;
+    names.reserve(count);
+    uint64_t state = 88172645463325252ull;
+    auto next = [&state] {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    for (size_t i = 0; i < count; i++) {
+        std::string name = BRANDS[next() % 16];
+        name += ' ';
+        name += COLORS[next() % 9];
+        name += ' ';
+        name += NOUNS[next() % 22];
+        if (next() % 2 == 0) name += ' ' + std::to_string(next() % 2000);
+        if (next() % 4 == 0) std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+// prefix with edits typos: a letter swapped with the next, dropped or changed
+static std::string misspell(std::string prefix, int edits, size_t seed) {
+    for (int e = 0; e < edits; e++) {
+        size_t at = 1 + (seed + static_cast<size_t>(e) * 3) % (prefix.size() - 2);
+        switch ((seed + static_cast<size_t>(e)) % 3) {
+        case 0: std::swap(prefix[at], prefix[at + 1]); break;
+        case 1: prefix.erase(at, 1); break;
+        default: prefix[at] = prefix[at] == 'x' ? 'q' : 'x'; break;
+        }
+    }
+    return prefix;
+}
+
+// What the trie walk saves: edit distance rows run down every word from its
+// first letter, without transpositions. True if some prefix of word is
+// within maxEdits.
+static bool withinReach(const std::string& query, const std::string& word, int maxEdits) {
+    std::vector<int> previous(query.size() + 1), row(query.size() + 1);
+    for (size_t j = 0; j <= query.size(); j++) row[j] = static_cast<int>(j);
+    for (size_t i = 0; i < word.size(); i++) {
+        previous.swap(row);
+        row[0] = static_cast<int>(i + 1);
+        int best = row[0];
+        for (size_t j = 1; j <= query.size(); j++) {
+            int cost = query[j - 1] == word[i] ? 0 : 1;
+            row[j] = std::min({previous[j] + 1, row[j - 1] + 1, previous[j - 1] + cost});
+            best = std::min(best, row[j]);
+        }
+        if (row[query.size()] <= maxEdits) return true;
+        if (best > maxEdits) return false;
+    }
+    return false;
+}
+
+struct Row {
+    double bytesPerKey;
+    double buildMs;
+    double searchPerSec;
+    double autocompletePerSec;
+};
+
+template <typename Build, typename Search, typename Complete>
+static Row measure(size_t distinct, const std::vector<std::string>& queries, const std::vector<std::string>& prefixes,
+                   Build build, Search search, Complete complete) {
+    Row row;
+    size_t before = liveBytes.load();
+    Stopwatch watch;
+    build();
+    row.buildMs = watch.millis();
+    row.bytesPerKey = static_cast<double>(liveBytes.load() - before) / static_cast<double>(distinct);
+    row.searchPerSec = 1e9 / nanosPerCall([&](size_t i) { keep(search(queries[i % queries.size()])); });
+    row.autocompletePerSec = 1e9 / nanosPerCall([&](size_t i) { keep(complete(prefixes[i % prefixes.size()])); });
+    return row;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = static_cast<size_t>(benchOption(argc, argv, "names", 200000));
+    std::vector<std::string> names = makeNames(count);
+    std::unordered_map<std::string, size_t> lowered;
+    for (const std::string& name : names) {
+        std::string lower = name;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        lowered.emplace(lower, lowered.size());
+    }
+    size_t distinct = lowered.size();
+    std::vector<std::string> vocabulary(distinct);
+    for (const auto& entry : lowered) vocabulary[entry.second] = entry.first;
+
+    // Every other search misses in its last character; prefixes are 1 to 6
+    // characters of the names
+    std::vector<std::string> queries, prefixes;
+    for (size_t i = 0; i < 4096; i++) {
+        std::string query = names[(i * 7919) % count];
+        if (i % 2 == 1) query.back() = '#';
+        queries.push_back(query);
+        prefixes.push_back(names[(i * 104729) % count].substr(0, 1 + i % 6));
+    }
+
+    std::printf("%zu names, %zu distinct ignoring case\n", count, distinct);
+    std::printf("%-10s %12s %10s %14s %18s\n", "trie", "bytes/key", "build ms", "searches/s", "autocompletes/s");
+    {
+        LegacyTrie* legacy = nullptr;
+        Row row = measure(distinct, queries, prefixes,
+                          [&] {
+                              legacy = new LegacyTrie();
+                              for (const std::string& name : names) legacy->insert(name);
+                          },
+                          [&](const std::string& word) { return legacy->search(word); },
+                          [&](const std::string& prefix) { return legacy->autocomplete(prefix); });
+        std::printf("%-10s %12.0f %10.1f %14.0f %18.0f\n", "old", row.bytesPerKey, row.buildMs, row.searchPerSec,
+                    row.autocompletePerSec);
+        delete legacy;
+    }
+    {
+        Trie* trie = nullptr;
+        Row row = measure(distinct, queries, prefixes,
+                          [&] {
+                              trie = new Trie();
+                              long long reportedAt = 1767000000;
+                              for (const std::string& name : names) trie->insert(name, reportedAt++);
+                          },
+                          [&](const std::string& word) { return trie->search(word); },
+                          [&](const std::string& prefix) { return trie->autocomplete(prefix); });
+        std::printf("%-10s %12.0f %10.1f %14.0f %18.0f\n", "flat", row.bytesPerKey, row.buildMs, row.searchPerSec,
+                    row.autocompletePerSec);
+        delete trie;
+    }
+
+    // Prefixes of 6 to 9 characters, which editsAllowed() grants two edits
+    Trie trie;
+    long long reportedAt = 1767000000;
+    for (const std::string& name : names) trie.insert(name, reportedAt++);
+    std::vector<std::string> typos[3];
+    for (size_t i = 0; i < 1024; i++) {
+        std::string prefix = vocabulary[(i * 7919) % distinct].substr(0, 6 + i % 4);
+        for (int edits = 0; edits <= 2; edits++) typos[edits].push_back(misspell(prefix, edits, i));
+    }
+
+    std::printf("\nautocomplete on prefixes with typos, limit 10\n");
+    std::printf("%-8s %-22s %14s %10s\n", "typos", "lookup", "lookups/s", "answered");
+    for (int edits = 0; edits <= 2; edits++) {
+        const std::vector<std::string>& queries = typos[edits];
+        for (int maxEdits = 0; maxEdits <= 2; maxEdits++) {
+            size_t answered = 0;
+            for (const std::string& query : queries) answered += trie.fuzzyAutocomplete(query, maxEdits).empty() ? 0 : 1;
+            double perSec = 1e9 / nanosPerCall([&](size_t i) {
+                keep(trie.fuzzyAutocomplete(queries[i % queries.size()], maxEdits));
+            });
+            std::string label = maxEdits == 0 ? "exact" : maxEdits == 1 ? "fuzzy, 1 edit" : "fuzzy, 2 edits";
+            std::printf("%-8d %-22s %14.0f %9.0f%%\n", edits, label.c_str(), perSec,
+                        100.0 * static_cast<double>(answered) / static_cast<double>(queries.size()));
+        }
+        double scanPerSec = 1e9 / nanosPerCall([&](size_t i) {
+            const std::string& query = queries[i % queries.size()];
+            size_t matches = 0;
+            for (const std::string& word : vocabulary) matches += withinReach(query, word, 2) ? 1 : 0;
+            keep(matches);
+        });
+        std::printf("%-8d %-22s %14.0f\n", edits, "scan, 2 edits", scanPerSec);
+    }
+    return 0;
+}
@@ -1,6 +1,6 @@
 //
 // main.cpp - Lost & Found REST API Server
-// Uses cpp-httplib for HTTP server functionality
+// Serves HTTP with its own parser, router and I/O loops (no external dependencies)
 //
 
 #ifdef _WIN32
@@ -18,8 +18,20 @@
 #include <thread>
 #include <atomic>
 #include <csignal>
+#include <memory>
+#include <cstring>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 #include "System.h"
+#include "ItemCodec.h"
+#include "HttpParser.h"
+#include "WorkerPool.h"
+#include "Router.h"
+#include "Logger.h"
 
 // ============================================================================
 // MINIMAL HTTP SERVER IMPLEMENTATION (No external dependencies)
@@ -28,17 +40,487 @@
 #ifdef _WIN32
 typedef SOCKET socket_t;
 #define CLOSE_SOCKET closesocket
+#define POLL_SOCKETS WSAPoll
 #else
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <sys/uio.h>
+#include <poll.h>
 typedef int socket_t;
 #define CLOSE_SOCKET close
+#define POLL_SOCKETS poll
 #define INVALID_SOCKET -1
 #define SOCKET_ERROR -1
 #endif
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sched.h>
+#include <pthread.h>
+#define HAVE_EPOLL 1
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include "IoUring.h"
+#define HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+// ============================================================================
+// SERVER CONFIGURATION - I/O model and tuning, selected on the command line
+// ============================================================================
+enum class IoMode {
+    THREAD_PER_CONNECTION,  // Blocking sockets, each connection served by a pooled worker
+    EPOLL,                  // Edge-triggered epoll reactor on fixed event-loop threads
+    IO_URING                // Completion-based loops: multishot accept/recv, batched submits
+};
+
+struct ServerConfig {
+    int port;
+    IoMode ioMode;
+    int eventLoopThreads;
+    bool reusePort;                 // Event loops each bind their own SO_REUSEPORT listener
+    bool pinThreads;                // Each event loop is pinned to its own CPU
+    int keepAliveTimeoutSec;        // Idle keep-alive connections are closed after this
+    int maxRequestsPerConnection;   // Connection is closed after serving this many requests
+    HttpParserLimits parserLimits;  // Header/body size ceilings for incoming requests
+    int workerThreads;              // Request handler pool size
+    int maxQueueDepth;              // Requests allowed to wait for a worker
+    int queueDeadlineMs;            // Queued longer than this -> 503 instead of handling
+    int retryAfterSec;              // Retry-After advertised on 503
+    LogLevel logLevel;              // Records below this level are discarded
+    std::string logFile;            // Empty = stdout
+    WalOptions walOptions;          // fsync policy and group commit batching
+    int snapshotIntervalSec;        // Background checkpoint period; 0 = only at shutdown
+    bool forkSnapshots;             // Periodic checkpoints are written by a forked child
+    std::string exportJsonPath;     // Set: write the recovered data as JSON there and exit
+
+    ServerConfig() : port(8080), eventLoopThreads(1), reusePort(false), pinThreads(false), keepAliveTimeoutSec(5), maxRequestsPerConnection(100),
+                     workerThreads(8), maxQueueDepth(256), queueDeadlineMs(2000), retryAfterSec(1),
+                     logLevel(LogLevel::INFO), snapshotIntervalSec(300), forkSnapshots(false) {
+#ifdef HAVE_EPOLL
+        ioMode = IoMode::EPOLL;
+#else
+        ioMode = IoMode::THREAD_PER_CONNECTION;
+#endif
+        unsigned int cores = std::thread::hardware_concurrency();
+        if (cores > 0) {
+            eventLoopThreads = static_cast<int>(cores);
+            workerThreads = std::max(8, static_cast<int>(cores) * 2);
+        }
+    }
+};
+
+// Parses --io=epoll|uring|threads, --loops=N, --reuseport, --pin-cpus, --port=N,
+// --keepalive-timeout=SECONDS, --max-requests=N,
+// --max-header-bytes=N, --max-body-bytes=N, --workers=N,
+// --queue-depth=N, --queue-deadline-ms=N, --retry-after=SECONDS,
+// --log-level=debug|info|warn|error|off, --log-file=PATH,
+// --fsync=always|everysec|no (default always; everysec can lose the last
+// second of acknowledged changes to a power cut), --group-commit-window-us=N,
+// --group-commit-max=N, --snapshot-interval=SECONDS, --snapshot-mode=fork|inline
+// and --export-json=PATH
+ServerConfig parseServerConfig(int argc, char* argv[]) {
+    ServerConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--io=threads") {
+            config.ioMode = IoMode::THREAD_PER_CONNECTION;
+        } else if (arg == "--io=epoll") {
+#ifdef HAVE_EPOLL
+            config.ioMode = IoMode::EPOLL;
+#else
+            std::cerr << "epoll is not available on this platform, using --io=threads" << std::endl;
+#endif
+        } else if (arg == "--io=uring") {
+#ifdef HAVE_IO_URING
+            config.ioMode = IoMode::IO_URING;
+#else
+            std::cerr << "io_uring is not available in this build, using the default I/O mode" << std::endl;
+#endif
+        } else if (arg == "--reuseport") {
+            // Thread-per-core accepting: each loop owns a listener and a CPU
+            config.reusePort = true;
+            config.pinThreads = true;
+        } else if (arg == "--pin-cpus") {
+            config.pinThreads = true;
+        } else if (arg.rfind("--loops=", 0) == 0) {
+            config.eventLoopThreads = std::max(1, std::atoi(arg.c_str() + 8));
+        } else if (arg.rfind("--port=", 0) == 0) {
+            config.port = std::atoi(arg.c_str() + 7);
+        } else if (arg.rfind("--keepalive-timeout=", 0) == 0) {
+            config.keepAliveTimeoutSec = std::max(0, std::atoi(arg.c_str() + 20));
+        } else if (arg.rfind("--max-requests=", 0) == 0) {
+            config.maxRequestsPerConnection = std::max(1, std::atoi(arg.c_str() + 15));
+        } else if (arg.rfind("--max-header-bytes=", 0) == 0) {
+            config.parserLimits.maxHeaderBytes = std::max(256LL, std::atoll(arg.c_str() + 19));
+        } else if (arg.rfind("--max-body-bytes=", 0) == 0) {
+            config.parserLimits.maxBodyBytes = std::max(0LL, std::atoll(arg.c_str() + 17));
+        } else if (arg.rfind("--workers=", 0) == 0) {
+            config.workerThreads = std::max(1, std::atoi(arg.c_str() + 10));
+        } else if (arg.rfind("--queue-depth=", 0) == 0) {
+            config.maxQueueDepth = std::max(1, std::atoi(arg.c_str() + 14));
+        } else if (arg.rfind("--queue-deadline-ms=", 0) == 0) {
+            config.queueDeadlineMs = std::max(0, std::atoi(arg.c_str() + 20));
+        } else if (arg.rfind("--retry-after=", 0) == 0) {
+            config.retryAfterSec = std::max(0, std::atoi(arg.c_str() + 14));
+        } else if (arg.rfind("--log-level=", 0) == 0) {
+            if (!parseLogLevel(arg.substr(12), config.logLevel)) {
+                std::cerr << "Unknown log level: " << arg.substr(12) << std::endl;
+            }
+        } else if (arg.rfind("--log-file=", 0) == 0) {
+            config.logFile = arg.substr(11);
+        } else if (arg.rfind("--fsync=", 0) == 0) {
+            if (!parseWalSyncPolicy(arg.substr(8), config.walOptions.policy)) {
+                std::cerr << "Unknown fsync policy: " << arg.substr(8) << std::endl;
+            }
+        } else if (arg.rfind("--group-commit-window-us=", 0) == 0) {
+            config.walOptions.batchWindow = std::chrono::microseconds(std::max(0, std::atoi(arg.c_str() + 25)));
+        } else if (arg.rfind("--group-commit-max=", 0) == 0) {
+            config.walOptions.maxBatchRecords = static_cast<size_t>(std::max(1, std::atoi(arg.c_str() + 19)));
+        } else if (arg.rfind("--snapshot-interval=", 0) == 0) {
+            config.snapshotIntervalSec = std::max(0, std::atoi(arg.c_str() + 20));
+        } else if (arg == "--snapshot-mode=fork") {
+#ifdef _WIN32
+            std::cerr << "fork is not available on this platform, using --snapshot-mode=inline" << std::endl;
+#else
+            config.forkSnapshots = true;
+#endif
+        } else if (arg == "--snapshot-mode=inline") {
+            config.forkSnapshots = false;
+        } else if (arg.rfind("--export-json=", 0) == 0) {
+            config.exportJsonPath = arg.substr(14);
+        } else {
+            std::cerr << "Ignoring unknown option: " << arg << std::endl;
+        }
+    }
+    if (config.ioMode == IoMode::THREAD_PER_CONNECTION) {
+        // Blocking mode has a single accept thread and no event loops to pin
+        config.reusePort = false;
+        config.pinThreads = false;
+    }
+    return config;
+}
+
+// ============================================================================
+// BODY WRITER - Fixed-size output buffer for streamed response bodies
+// Producers append serialized output; each time the buffer fills it is handed
+// to the sink as one HTTP chunk, so a large list never exists in memory whole.
+// The chunk-size line is reserved up front and zero-padded, which lets the
+// filled buffer go out as-is without copying.
+// ============================================================================
+class BodyWriter {
+public:
+    typedef std::function<bool(std::string&&)> Sink;   // false once the client is gone
+    static const size_t DEFAULT_CAPACITY = 16 * 1024;
+
+private:
+    static const size_t SIZE_LINE = 10;     // 8 hex digits + CRLF
+    Sink sink;
+    bool chunked;
+    size_t capacity;
+    std::string buffer;
+    bool failed;
+
+    void startBuffer() {
+        buffer.clear();
+        buffer.reserve(capacity + SIZE_LINE + 2);
+        if (chunked) buffer.append("00000000\r\n");
+    }
+
+    size_t payloadSize() const { return buffer.size() - (chunked ? SIZE_LINE : 0); }
+
+    void flush() {
+        if (failed || payloadSize() == 0) return;
+        if (chunked) {
+            static const char digits[] = "0123456789abcdef";
+            size_t size = payloadSize();
+            for (int i = 7; i >= 0; i--, size >>= 4) {
+                buffer[i] = digits[size & 0xF];
+            }
+            buffer.append("\r\n");
+        }
+        if (!sink(std::move(buffer))) failed = true;
+        startBuffer();
+    }
+
+public:
+    // chunked=false passes the raw body through (HTTP/1.0 clients)
+    BodyWriter(Sink sink, bool chunked = true, size_t capacity = DEFAULT_CAPACITY)
+        : sink(std::move(sink)), chunked(chunked), capacity(capacity), failed(false) {
+        startBuffer();
+    }
+
+    void append(const char* data, size_t size) {
+        if (failed) return;
+        buffer.append(data, size);
+        if (payloadSize() >= capacity) flush();
+    }
+    void append(const std::string& data) { append(data.data(), data.size()); }
+
+    // Flush the tail and write the terminating zero-length chunk
+    void finish() {
+        flush();
+        if (chunked && !failed && !sink(std::string("0\r\n\r\n"))) failed = true;
+    }
+
+    // Producers can stop early once the sink has failed
+    bool ok() const { return !failed; }
+};
+
+typedef std::function<void(BodyWriter&)> BodyProducer;
+
+// ============================================================================
+// RESPONSE STREAM - Bounded hand-off of body chunks from the worker producing
+// them to the event loop that owns the socket. The producer blocks once
+// maxChunks are waiting, so a slow client pins a few buffers, not the body.
+// ============================================================================
+class ResponseStream {
+public:
+    enum class Status { CHUNK, PENDING, END };
+
+private:
+    std::mutex mutex;
+    std::condition_variable space;
+    std::deque<std::string> chunks;
+    size_t maxChunks;
+    bool finished;
+    bool cancelled;
+    bool consumerWaiting;
+    std::function<void()> wakeConsumer;
+
+    void publish(std::unique_lock<std::mutex>& lock) {
+        bool wake = consumerWaiting;
+        consumerWaiting = false;
+        lock.unlock();
+        if (wake) wakeConsumer();
+    }
+
+public:
+    ResponseStream(size_t maxChunks, std::function<void()> wakeConsumer)
+        : maxChunks(maxChunks), finished(false), cancelled(false), consumerWaiting(false),
+          wakeConsumer(std::move(wakeConsumer)) {}
+
+    // Producer side; returns false once the consumer has gone away
+    bool push(std::string chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [this] { return cancelled || chunks.size() < maxChunks; });
+        if (cancelled) return false;
+        chunks.push_back(std::move(chunk));
+        publish(lock);
+        return true;
+    }
+
+    void finish() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished = true;
+        publish(lock);
+    }
+
+    // Consumer side; PENDING means wakeConsumer() fires when more arrives
+    Status next(std::string& chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!chunks.empty()) {
+            chunk = std::move(chunks.front());
+            chunks.pop_front();
+            space.notify_one();
+            return Status::CHUNK;
+        }
+        if (finished) return Status::END;
+        consumerWaiting = true;
+        return Status::PENDING;
+    }
+
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+        }
+        space.notify_all();
+    }
+};
+
+// Consumer's handle on a stream; dropping it (connection closed, response
+// discarded) releases a producer blocked on a full window
+class StreamReader {
+private:
+    std::shared_ptr<ResponseStream> stream;
+
+public:
+    explicit StreamReader(std::shared_ptr<ResponseStream> stream) : stream(std::move(stream)) {}
+    ~StreamReader() { stream->cancel(); }
+
+    StreamReader(const StreamReader&) = delete;
+    StreamReader& operator=(const StreamReader&) = delete;
+
+    ResponseStream::Status next(std::string& chunk) { return stream->next(chunk); }
+};
+
+// ============================================================================
+// OUTPUT QUEUE - Rendered responses waiting to be written to a socket
+// Each response keeps its header block and body as separate buffers; queued
+// (pipelined) responses go out together in one gather write, resuming
+// mid-buffer after a partial write. A streamed response keeps its place at
+// the front, refilling its body from the stream, until the stream ends.
+// ============================================================================
+struct WireResponse {
+    std::string head;   // Status line + headers + blank line; empty for a bare chunk
+    std::string body;
+    std::shared_ptr<const std::string> sharedBody;  // Written instead of body when set, never copied
+    BodyProducer producer;                  // Set when the body is streamed chunked
+    std::unique_ptr<StreamReader> stream;   // Attached once a producer is running
+    
+    const std::string& payload() const { return sharedBody ? *sharedBody : body; }
+};
+
+enum class WriteResult {
+    DONE,       // Queue drained
+    BLOCKED,    // Socket buffer full (non-blocking sockets only)
+    WAITING,    // Streamed body has no chunk ready yet
+    FAILED
+};
+
+class OutputQueue {
+private:
+    std::deque<WireResponse> queue;
+    size_t offset;      // Bytes of queue.front() already written
+    size_t pending;     // Unwritten bytes across the queue
+    
+    // Drop n written bytes from the front of the queue
+    void advance(size_t n) {
+        pending -= n;
+        while (!queue.empty()) {
+            size_t remaining = queue.front().head.size() + queue.front().payload().size() - offset;
+            if (n < remaining) {
+                offset += n;
+                return;
+            }
+            n -= remaining;
+            if (queue.front().stream) {
+                // Gather writes stop at a stream, so nothing follows it
+                offset += remaining;
+                return;
+            }
+            queue.pop_front();
+            offset = 0;
+        }
+    }
+    
+    // Make sure the front response has unwritten bytes, refilling a streamed
+    // body as needed. False, with status DONE or WAITING, if there are none.
+    bool prepareFront(WriteResult& status) {
+        while (!queue.empty()) {
+            const WireResponse& front = queue.front();
+            if (!front.stream || offset < front.head.size() + front.payload().size()) return true;
+            if (!refillStream(status)) return false;
+        }
+        status = WriteResult::DONE;
+        return false;
+    }
+    
+    // Refill a fully written streamed response; false when the caller must wait
+    bool refillStream(WriteResult& result) {
+        WireResponse& front = queue.front();
+        std::string chunk;
+        switch (front.stream->next(chunk)) {
+        case ResponseStream::Status::CHUNK:
+            pending += chunk.size();
+            front.body = std::move(chunk);
+            offset = front.head.size();
+            return true;
+        case ResponseStream::Status::END:
+            queue.pop_front();
+            offset = 0;
+            return true;
+        default:
+            result = WriteResult::WAITING;
+            return false;
+        }
+    }
+    
+public:
+    OutputQueue() : offset(0), pending(0) {}
+    
+    void push(WireResponse response) {
+        pending += response.head.size() + response.payload().size();
+        queue.push_back(std::move(response));
+    }
+    
+    bool empty() const { return queue.empty(); }
+    size_t pendingBytes() const { return pending; }
+    
+#ifndef _WIN32
+    // Point iov at unwritten bytes from the front of the queue, stopping after
+    // a streamed response. Returns 0, with status DONE or WAITING, when there
+    // is nothing to write yet.
+    int gather(struct iovec* iov, int maxIov, WriteResult& status) {
+        if (!prepareFront(status)) return 0;
+        int count = 0;
+        size_t skip = offset;
+        for (auto it = queue.begin(); it != queue.end() && count + 2 <= maxIov; ++it) {
+            const std::string* pieces[] = {&it->head, &it->payload()};
+            for (const std::string* piece : pieces) {
+                if (skip >= piece->size()) {
+                    skip -= piece->size();
+                    continue;
+                }
+                iov[count].iov_base = const_cast<char*>(piece->data() + skip);
+                iov[count].iov_len = piece->size() - skip;
+                skip = 0;
+                count++;
+            }
+            if (it->stream) break;
+        }
+        return count;
+    }
+    
+    // Account for n bytes written from a gather() outside writeTo()
+    void consume(size_t n) { advance(n); }
+    
+    // True while a streamed body may still produce more bytes
+    bool streaming() const {
+        for (const auto& response : queue) {
+            if (response.stream) return true;
+        }
+        return false;
+    }
+#endif
+    
+    WriteResult writeTo(socket_t fd) {
+        WriteResult status;
+        while (prepareFront(status)) {
+#ifdef _WIN32
+            const WireResponse& front = queue.front();
+            bool inHead = offset < front.head.size();
+            const std::string& piece = inHead ? front.head : front.payload();
+            size_t start = inHead ? offset : offset - front.head.size();
+            int written = send(fd, piece.data() + start, static_cast<int>(piece.size() - start), 0);
+            if (written < 0) {
+                return WSAGetLastError() == WSAEWOULDBLOCK ? WriteResult::BLOCKED : WriteResult::FAILED;
+            }
+#else
+            const int MAX_IOV = 64;
+            struct iovec iov[MAX_IOV];
+            int count = gather(iov, MAX_IOV, status);
+            
+            ssize_t written = writev(fd, iov, count);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return WriteResult::BLOCKED;
+                return WriteResult::FAILED;
+            }
+#endif
+            advance(static_cast<size_t>(written));
+        }
+        return status;
+    }
+};
+
 // ============================================================================
 // WEBHOOK HTTP CLIENT - Send GET requests to n8n Cloud
 // ============================================================================
@@ -57,7 +539,7 @@ std::string urlEncode(const std::string& str) {
 bool sendWebhookNotification(const std::string& webhookUrl, const std::string& jsonPayload) {
     if (webhookUrl.empty()) return false;
     
-    std::cout << "📤 Sending webhook to: " << webhookUrl << std::endl;
+    appLogger().log(LogLevel::INFO, "📤 Sending webhook to: " + webhookUrl);
     
     // URL-encode the JSON payload for GET request
     std::string encodedPayload = urlEncode(jsonPayload);
@@ -68,42 +550,102 @@ bool sendWebhookNotification(const std::string& webhookUrl, const std::string& j
         << webhookUrl << "?data=" << encodedPayload 
         << "\" > nul 2>&1";
     
-    std::cout << "📧 Executing webhook GET..." << std::endl;
+    appLogger().log(LogLevel::DEBUG, "📧 Executing webhook GET...");
     int result = std::system(cmd.str().c_str());
     
     if (result == 0) {
-        std::cout << "✅ Webhook notification sent successfully!" << std::endl;
+        appLogger().log(LogLevel::INFO, "✅ Webhook notification sent successfully!");
         return true;
     } else {
-        std::cout << "❌ Webhook notification failed (exit code: " << result << ")" << std::endl;
+        appLogger().log(LogLevel::WARN, "❌ Webhook notification failed (exit code: " + std::to_string(result) + ")");
         return false;
     }
 }
 
+// Checkpoints go to SNAPSHOT_FILE; LEGACY_DATA_FILE is imported when there is none yet
+static const char* SNAPSHOT_FILE = "data.snap";
+static const char* LEGACY_DATA_FILE = "data.json";
+
 class HttpServer {
 private:
     socket_t serverSocket;
-    int port;
+    ServerConfig config;
     std::atomic<bool> running;
     LostFoundSystem& system;
+#ifdef HAVE_EPOLL
+    struct EventLoop;
+    std::vector<std::unique_ptr<EventLoop>> eventLoops;
+#endif
+    std::unique_ptr<WorkerPool> workerPool;     // Request handlers
+    std::unique_ptr<WorkerPool> webhookPool;    // Outbound webhook notifications
     
-    struct HttpRequest {
-        std::string method;
-        std::string path;
-        std::string query;
-        std::string body;
-        std::unordered_map<std::string, std::string> headers;
+    // Blocking mode: keep-alive connections waiting for their next request
+    struct BlockingConnection {
+        socket_t fd;
+        RecvBuffer in;
+        HttpRequestParser parser;
+        int requestsServed;
+        std::chrono::steady_clock::time_point lastActivity;
+        
+        BlockingConnection(socket_t fd, const HttpParserLimits& limits)
+            : fd(fd), parser(limits), requestsServed(0), lastActivity(std::chrono::steady_clock::now()) {}
     };
+    typedef std::shared_ptr<BlockingConnection> BlockingConnectionPtr;
+    
+    std::mutex parkedMutex;
+    std::vector<BlockingConnectionPtr> parked;  // Not yet seen by the poller
+    bool pollerStopped;         // Parked connections are closed instead
+#ifndef _WIN32
+    int parkWake[2];            // Pipe that wakes the poller when one is parked
+#endif
+    
+    // Periodic checkpoints bound how much log a restart has to replay
+    std::thread snapshotThread;
+    std::mutex snapshotMutex;
+    std::condition_variable snapshotSignal;
+    bool snapshotStopping;
     
     struct HttpResponse {
         int status;
         std::string statusText;
         std::string contentType;
         std::string body;
+        std::vector<std::pair<std::string, std::string>> headers;  // Extra response headers
+        bool keepAlive;
+        BodyProducer streamBody;    // When set, replaces body and is sent chunked
+        std::shared_ptr<const std::string> sharedBody;  // When set, replaces body (a cached view)
+        
+        HttpResponse() : status(200), statusText("OK"), contentType("application/json"), keepAlive(false) {}
+    };
+    
+    // Header lines that are identical on every response, formatted once
+    std::string corsHeaders;
+    std::string keepAliveHeaders;
+    std::string closeHeaders;
+    
+    typedef HttpResponse (HttpServer::*RouteHandler)(const HttpRequest&, const RouteParams&);
+    Router<RouteHandler> router;
+    
+    // Polled read views whose rendered bodies are reused until the data changes
+    enum CachedView {
+        VIEW_STATS,
+        VIEW_ANALYTICS,
+        VIEW_LOCATIONS,
+        VIEW_ACTIVE_ITEMS,
+        VIEW_COUNT
+    };
+    
+    struct CachedBody {
+        uint64_t generation;                    // 0 = nothing rendered yet
+        std::shared_ptr<const std::string> body;
         
-        HttpResponse() : status(200), statusText("OK"), contentType("application/json") {}
+        CachedBody() : generation(0) {}
     };
     
+    std::mutex viewCacheMutex;
+    CachedBody viewCache[VIEW_COUNT];
+    std::string etagPrefix;     // Per process, so ETags never match across restarts
+    
     std::string extractJsonValue(const std::string& json, const std::string& key) {
         std::string searchKey = "\"" + key + "\"";
         size_t keyPos = json.find(searchKey);
@@ -128,76 +670,68 @@ private:
         return "";
     }
     
+    // One item object, indented as an element of a top-level array
+    void appendItemJson(std::string& out, const Item& item) {
+        out += "  ";
+        JsonWriter json(out, 2, 1);
+        writeJsonObject(json, item, FIELD_API);
+    }
+    
     std::string buildJsonResponse(const std::vector<Item>& items) {
-        std::stringstream ss;
-        ss << "[\n";
-        for (size_t i = 0; i < items.size(); i++) {
-            const auto& item = items[i];
-            ss << "  {\n";
-            ss << "    \"id\": \"" << item.id << "\",\n";
-            ss << "    \"name\": \"" << item.name << "\",\n";
-            ss << "    \"color\": \"" << item.color << "\",\n";
-            ss << "    \"location\": \"" << item.location << "\",\n";
-            ss << "    \"owner\": \"" << item.owner << "\",\n";
-            ss << "    \"type\": \"" << item.type << "\",\n";
-            ss << "    \"timestamp\": " << item.timestamp << ",\n";
-            ss << "    \"description\": \"" << item.description << "\",\n";
-            ss << "    \"category\": \"" << categoryToString(item.category) << "\",\n";
-            ss << "    \"archived\": " << (item.archived ? "true" : "false") << ",\n";
-            ss << "    \"expiresAt\": " << item.expiresAt << "\n";
-            ss << "  }";
-            if (i < items.size() - 1) ss << ",";
-            ss << "\n";
-        }
-        ss << "]";
-        return ss.str();
+        std::string out;
+        JsonWriter json(out, 2);
+        writeJsonArray(json, items, FIELD_API);
+        return out;
     }
     
-    std::string buildMatchesJson(const std::vector<MatchCandidate>& matches) {
-        std::stringstream ss;
-        ss << "[\n";
-        for (size_t i = 0; i < matches.size(); i++) {
-            const auto& match = matches[i];
-            ss << "  {\n";
-            ss << "    \"itemId\": \"" << match.itemId << "\",\n";
-            ss << "    \"itemName\": \"" << match.itemName << "\",\n";
-            ss << "    \"owner\": \"" << match.owner << "\",\n";
-            ss << "    \"location\": \"" << match.location << "\",\n";
-            ss << "    \"color\": \"" << match.color << "\",\n";
-            ss << "    \"score\": " << match.score << ",\n";
-            ss << "    \"nameScore\": " << match.nameScore << ",\n";
-            ss << "    \"colorScore\": " << match.colorScore << ",\n";
-            ss << "    \"proximityScore\": " << match.proximityScore << "\n";
-            ss << "  }";
-            if (i < matches.size() - 1) ss << ",";
-            ss << "\n";
-        }
-        ss << "]";
-        return ss.str();
+    // Visits items straight out of an index
+    typedef std::function<void(const std::function<void(const Item&)>&)> ItemSource;
+    
+    // Same JSON as buildJsonResponse, serialized into the chunked stream as the
+    // source is walked instead of being assembled up front
+    HttpResponse streamItemsJson(ItemSource source) {
+        HttpResponse res;
+        res.streamBody = [this, source](BodyWriter& writer) {
+            std::string itemJson;
+            bool first = true;
+            writer.append("[\n", 2);
+            source([&](const Item& item) {
+                if (!writer.ok()) return;
+                itemJson.clear();
+                if (!first) itemJson += ",\n";
+                appendItemJson(itemJson, item);
+                writer.append(itemJson);
+                first = false;
+            });
+            if (first) {
+                writer.append("]", 1);
+            } else {
+                writer.append("\n]", 2);
+            }
+        };
+        return res;
     }
     
-    std::string buildSuggestionsJson(const std::vector<std::string>& suggestions) {
-        std::stringstream ss;
-        ss << "[";
-        for (size_t i = 0; i < suggestions.size(); i++) {
-            ss << "\"" << suggestions[i] << "\"";
-            if (i < suggestions.size() - 1) ss << ", ";
-        }
-        ss << "]";
-        return ss.str();
+    std::string buildMatchesJson(const std::vector<MatchCandidate>& matches) {
+        std::string out;
+        JsonWriter json(out, 2);
+        writeJsonArray(json, matches, FIELD_API);
+        return out;
     }
     
-    std::string buildLocationsJson(const std::vector<std::string>& locations) {
-        std::stringstream ss;
-        ss << "[";
-        for (size_t i = 0; i < locations.size(); i++) {
-            ss << "\"" << locations[i] << "\"";
-            if (i < locations.size() - 1) ss << ", ";
+    // Names and locations come from reports, so they are escaped like any field
+    std::string buildStringsJson(const std::vector<std::string>& strings) {
+        std::string out;
+        JsonWriter json(out);
+        json.beginArray();
+        for (const std::string& text : strings) {
+            json.value(text);
         }
-        ss << "]";
-        return ss.str();
+        json.endArray();
+        return out;
     }
 
+
     std::string buildAnalyticsJson(const AnalyticsData& data) {
         std::stringstream ss;
         ss << "{\n";
@@ -210,7 +744,7 @@ private:
         ss << "  \"topCategories\": [\n";
         int count = 0;
         for (const auto& pair : data.categoryStats) {
-            ss << "    {\"category\": \"" << pair.first << "\", \"count\": " << pair.second << "}";
+            ss << "    {\"category\": \"" << jsonEscape(pair.first) << "\", \"count\": " << pair.second << "}";
             if (count < data.categoryStats.size() - 1) ss << ",";
             ss << "\n";
             count++;
@@ -221,7 +755,7 @@ private:
         ss << "  \"topLocations\": [\n";
         count = 0;
         for (const auto& pair : data.locationStats) {
-            ss << "    {\"location\": \"" << pair.first << "\", \"count\": " << pair.second << "}";
+            ss << "    {\"location\": \"" << jsonEscape(pair.first) << "\", \"count\": " << pair.second << "}";
             if (count < data.locationStats.size() - 1) ss << ",";
             ss << "\n";
             count++;
@@ -231,64 +765,136 @@ private:
         return ss.str();
     }
     
-    HttpRequest parseRequest(const std::string& raw) {
-        HttpRequest req;
-        std::istringstream stream(raw);
-        std::string line;
-        
-        // Parse first line: METHOD /path HTTP/1.1
-        if (std::getline(stream, line)) {
-            std::istringstream lineStream(line);
-            lineStream >> req.method;
-            std::string fullPath;
-            lineStream >> fullPath;
-            
-            // Split path and query
-            size_t queryPos = fullPath.find("?");
-            if (queryPos != std::string::npos) {
-                req.path = fullPath.substr(0, queryPos);
-                req.query = fullPath.substr(queryPos + 1);
-            } else {
-                req.path = fullPath;
+    std::string buildPoolStatsJson(const WorkerPoolStats& stats) {
+        std::stringstream ss;
+        ss << "{";
+        ss << "\"threads\": " << stats.threads << ",";
+        ss << "\"queueCapacity\": " << stats.queueCapacity << ",";
+        ss << "\"queueDepth\": " << stats.queueDepth << ",";
+        ss << "\"peakQueueDepth\": " << stats.peakQueueDepth << ",";
+        ss << "\"submitted\": " << stats.submitted << ",";
+        ss << "\"completed\": " << stats.completed << ",";
+        ss << "\"rejected\": " << stats.rejected << ",";
+        ss << "\"expired\": " << stats.expired;
+        ss << "}";
+        return ss.str();
+    }
+    
+    void cacheStaticHeaders() {
+        corsHeaders = "Access-Control-Allow-Origin: *\r\n"
+                      "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n"
+                      "Access-Control-Allow-Headers: Content-Type, Authorization, If-None-Match\r\n"
+                      "Access-Control-Expose-Headers: ETag\r\n";
+        keepAliveHeaders = "Connection: keep-alive\r\nKeep-Alive: timeout=" +
+                           std::to_string(config.keepAliveTimeoutSec) + ", max=" +
+                           std::to_string(config.maxRequestsPerConnection) + "\r\n";
+        closeHeaders = "Connection: close\r\n";
+    }
+    
+    // ========================================================================
+    // CONDITIONAL RESPONSES - ETags derived from the data generation
+    // ========================================================================
+    std::string makeETag(uint64_t generation) {
+        return "\"" + etagPrefix + "-" + std::to_string(generation) + "\"";
+    }
+    
+    // If-None-Match holds "*" or a comma-separated list of (possibly weak) tags
+    static bool etagMatches(const std::string& ifNoneMatch, const std::string& etag) {
+        size_t pos = 0;
+        while (pos < ifNoneMatch.size()) {
+            size_t end = ifNoneMatch.find(',', pos);
+            if (end == std::string::npos) end = ifNoneMatch.size();
+            size_t first = ifNoneMatch.find_first_not_of(" \t", pos);
+            size_t last = ifNoneMatch.find_last_not_of(" \t", end - 1);
+            if (first != std::string::npos && first < end && last >= first) {
+                std::string tag = ifNoneMatch.substr(first, last - first + 1);
+                if (tag.compare(0, 2, "W/") == 0) tag.erase(0, 2);
+                if (tag == "*" || tag == etag) return true;
             }
+            pos = end + 1;
         }
+        return false;
+    }
+    
+    // Serve a read view for the current generation: 304 when the client
+    // already has it, else the cached body, rendering only on the first
+    // request after a mutation. The body is shared with the cache, not
+    // copied into the response.
+    HttpResponse cachedView(const HttpRequest& req, CachedView view, const std::function<std::string()>& render) {
+        HttpResponse res;
+        uint64_t generation = system.getGeneration();
+        std::string etag = makeETag(generation);
         
-        // Parse headers
-        while (std::getline(stream, line) && line != "\r" && !line.empty()) {
-            size_t colonPos = line.find(":");
-            if (colonPos != std::string::npos) {
-                std::string key = line.substr(0, colonPos);
-                std::string value = line.substr(colonPos + 2);
-                // Trim carriage return
-                if (!value.empty() && value.back() == '\r') {
-                    value.pop_back();
+        if (etagMatches(req.getHeader("If-None-Match"), etag)) {
+            res.status = 304;
+            res.statusText = "Not Modified";
+        } else {
+            {
+                std::lock_guard<std::mutex> lock(viewCacheMutex);
+                if (viewCache[view].generation == generation) res.sharedBody = viewCache[view].body;
+            }
+            
+            if (!res.sharedBody) {
+                // Mutations bump the generation after publishing, so a render
+                // that starts and ends within one generation shows it (or a
+                // change about to supersede it). One that a bump overlapped
+                // matches no single generation: sent untagged and not cached.
+                res.sharedBody = std::make_shared<const std::string>(render());
+                if (system.getGeneration() != generation) return res;
+                std::lock_guard<std::mutex> lock(viewCacheMutex);
+                if (viewCache[view].generation < generation) {
+                    viewCache[view].generation = generation;
+                    viewCache[view].body = res.sharedBody;
                 }
-                req.headers[key] = value;
             }
         }
         
-        // Parse body (rest of the content)
-        std::stringstream bodyStream;
-        while (std::getline(stream, line)) {
-            bodyStream << line;
+        res.headers.push_back({"ETag", etag});
+        res.headers.push_back({"Cache-Control", "no-cache"});
+        return res;
+    }
+    
+    // Header block only; the body is written from its own buffer
+    std::string buildResponseHead(const HttpResponse& res) {
+        std::string head;
+        head.reserve(256);
+        head += "HTTP/1.1 ";
+        head += std::to_string(res.status);
+        head += ' ';
+        head += res.statusText;
+        if (res.status == 304) {
+            // Not Modified carries no body and no entity headers
+            head += "\r\n";
+        } else if (res.streamBody) {
+            head += "\r\nContent-Type: ";
+            head += res.contentType;
+            head += "\r\nTransfer-Encoding: chunked\r\n";
+        } else {
+            head += "\r\nContent-Type: ";
+            head += res.contentType;
+            head += "\r\nContent-Length: ";
+            head += std::to_string(res.sharedBody ? res.sharedBody->size() : res.body.size());
+            head += "\r\n";
         }
-        req.body = bodyStream.str();
-        
-        return req;
+        head += corsHeaders;
+        for (const auto& header : res.headers) {
+            head += header.first;
+            head += ": ";
+            head += header.second;
+            head += "\r\n";
+        }
+        head += res.keepAlive ? keepAliveHeaders : closeHeaders;
+        head += "\r\n";
+        return head;
     }
     
-    std::string buildResponse(const HttpResponse& res) {
-        std::stringstream ss;
-        ss << "HTTP/1.1 " << res.status << " " << res.statusText << "\r\n";
-        ss << "Content-Type: " << res.contentType << "\r\n";
-        ss << "Content-Length: " << res.body.length() << "\r\n";
-        ss << "Access-Control-Allow-Origin: *\r\n";
-        ss << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-        ss << "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
-        ss << "Connection: close\r\n";
-        ss << "\r\n";
-        ss << res.body;
-        return ss.str();
+    WireResponse renderResponse(HttpResponse& res) {
+        WireResponse wire;
+        wire.head = buildResponseHead(res);
+        wire.body = std::move(res.body);
+        wire.sharedBody = std::move(res.sharedBody);
+        wire.producer = std::move(res.streamBody);
+        return wire;
     }
     
     std::string getQueryParam(const std::string& query, const std::string& key) {
@@ -326,446 +932,1865 @@ private:
         return result;
     }
     
-    HttpResponse handleRequest(const HttpRequest& req) {
+    // A change was made in memory but never reached the log, so it must not
+    // be acknowledged as saved
+    static HttpResponse logFailureResponse() {
+        HttpResponse res;
+        res.status = 500;
+        res.statusText = "Internal Server Error";
+        res.body = "{\"error\": \"The change could not be saved, please retry\"}";
+        return res;
+    }
+    
+    // Not-found answer for a change to an unknown item
+    static HttpResponse itemNotFoundResponse() {
+        HttpResponse res;
+        res.status = 404;
+        res.statusText = "Not Found";
+        res.body = "{\"error\": \"Item not found\"}";
+        return res;
+    }
+    
+    // Report lost item
+    HttpResponse handleReportLost(const HttpRequest& req, const RouteParams&) {
         HttpResponse res;
+        std::string name = extractJsonValue(req.body, "name");
+        std::string color = extractJsonValue(req.body, "color");
+        std::string location = extractJsonValue(req.body, "location");
+        std::string owner = extractJsonValue(req.body, "owner");
+        std::string email = extractJsonValue(req.body, "email");
+        std::string description = extractJsonValue(req.body, "description");
+        std::string category = extractJsonValue(req.body, "category");
+        
+        if (name.empty() || location.empty() || owner.empty() || description.empty()) {
+            res.status = 400;
+            res.statusText = "Bad Request";
+            res.body = "{\"error\": \"Missing required fields: name, location, owner, description\"}";
+            return res;
+        }
         
-        std::cout << "[" << req.method << "] " << req.path << std::endl;
+        std::string id = system.reportLostItem(name, color, location, owner, description, category, email);
+        if (id.empty()) return logFailureResponse();
         
-        // Handle CORS preflight
-        if (req.method == "OPTIONS") {
-            res.status = 204;
-            res.statusText = "No Content";
-            res.body = "";
+        res.body = "{\"success\": true, \"id\": \"" + id + "\", \"message\": \"Lost item reported successfully\"}";
+        
+        return res;
+    }
+    
+    // Report found item and get matches
+    HttpResponse handleReportFound(const HttpRequest& req, const RouteParams&) {
+        HttpResponse res;
+        std::string name = extractJsonValue(req.body, "name");
+        std::string color = extractJsonValue(req.body, "color");
+        std::string location = extractJsonValue(req.body, "location");
+        std::string finder = extractJsonValue(req.body, "finder");
+        std::string finderPhone = extractJsonValue(req.body, "finderPhone");
+        std::string finderEmail = extractJsonValue(req.body, "finderEmail");
+        std::string description = extractJsonValue(req.body, "description");
+        std::string category = extractJsonValue(req.body, "category");
+        
+        if (name.empty() || location.empty() || description.empty()) {
+            res.status = 400;
+            res.statusText = "Bad Request";
+            res.body = "{\"error\": \"Missing required fields: name, location, description\"}";
             return res;
         }
         
-        // Route handling
-        if (req.path == "/api/lost" && req.method == "POST") {
-            // Report lost item
-            std::string name = extractJsonValue(req.body, "name");
-            std::string color = extractJsonValue(req.body, "color");
-            std::string location = extractJsonValue(req.body, "location");
-            std::string owner = extractJsonValue(req.body, "owner");
-            std::string email = extractJsonValue(req.body, "email");
-            std::string description = extractJsonValue(req.body, "description");
-            std::string category = extractJsonValue(req.body, "category");
-            
-            if (name.empty() || location.empty() || owner.empty() || description.empty()) {
-                res.status = 400;
-                res.statusText = "Bad Request";
-                res.body = "{\"error\": \"Missing required fields: name, location, owner, description\"}";
-                return res;
-            }
-            
-            std::string id = system.reportLostItem(name, color, location, owner, description, category, email);
-            system.saveToFile("data.json");
-            
-            res.body = "{\"success\": true, \"id\": \"" + id + "\", \"message\": \"Lost item reported successfully\"}";
-        }
-        else if (req.path == "/api/found" && req.method == "POST") {
-            // Report found item and get matches
-            std::string name = extractJsonValue(req.body, "name");
-            std::string color = extractJsonValue(req.body, "color");
-            std::string location = extractJsonValue(req.body, "location");
-            std::string finder = extractJsonValue(req.body, "finder");
-            std::string finderPhone = extractJsonValue(req.body, "finderPhone");
-            std::string finderEmail = extractJsonValue(req.body, "finderEmail");
-            std::string description = extractJsonValue(req.body, "description");
-            std::string category = extractJsonValue(req.body, "category");
-            
-            if (name.empty() || location.empty() || description.empty()) {
-                res.status = 400;
-                res.statusText = "Bad Request";
-                res.body = "{\"error\": \"Missing required fields: name, location, description\"}";
-                return res;
-            }
-            
-            auto matches = system.reportFoundItem(name, color, location, finder, description, category, finderEmail);
-            system.saveToFile("data.json");
-            
-            // Trigger n8n webhook if configured and matches found
-            if (!system.getWebhookUrl().empty() && !matches.empty()) {
-                std::cout << "🔔 Webhook trigger: " << matches.size() << " matches found" << std::endl;
-                
-                // Build JSON payload for n8n with comprehensive data for LLM analysis
-                std::stringstream webhookPayload;
-                webhookPayload << "{";
-                webhookPayload << "\"event\":\"match_found\",";
-                webhookPayload << "\"foundItem\":{";
-                webhookPayload << "\"name\":\"" << name << "\",";
-                webhookPayload << "\"description\":\"" << description << "\",";
-                webhookPayload << "\"color\":\"" << color << "\",";
-                webhookPayload << "\"location\":\"" << location << "\",";
-                webhookPayload << "\"finder\":\"" << finder << "\",";
-                webhookPayload << "\"finderPhone\":\"" << finderPhone << "\",";
-                webhookPayload << "\"category\":\"" << category << "\",";
-                webhookPayload << "\"reportedAt\":" << std::time(nullptr);
-                webhookPayload << "},";
-                webhookPayload << "\"matchCount\":" << matches.size() << ",";
-                webhookPayload << "\"matches\":[";
-                
-                for (size_t i = 0; i < matches.size(); i++) {
-                    const auto& m = matches[i];
-                    // Get the full item to access email and other details
-                    Item* matchedItem = system.getItemById(m.itemId);
-                    std::string ownerEmail = matchedItem ? matchedItem->email : "";
-                    
-                    webhookPayload << "{";
-                    webhookPayload << "\"itemId\":\"" << m.itemId << "\",";
-                    webhookPayload << "\"itemName\":\"" << m.itemName << "\",";
-                    webhookPayload << "\"description\":\"" << (matchedItem ? matchedItem->description : "") << "\",";
-                    webhookPayload << "\"owner\":\"" << m.owner << "\",";
-                    webhookPayload << "\"email\":\"" << ownerEmail << "\",";
-                    webhookPayload << "\"location\":\"" << m.location << "\",";
-                    webhookPayload << "\"color\":\"" << m.color << "\",";
-                    webhookPayload << "\"category\":\"" << (matchedItem ? categoryToString(matchedItem->category) : "") << "\",";
-                    webhookPayload << "\"reportedAt\":" << (matchedItem ? matchedItem->timestamp : 0) << ",";
-                    webhookPayload << "\"score\":" << m.score << ",";
-                    webhookPayload << "\"scoreBreakdown\":{";
-                    webhookPayload << "\"nameScore\":" << m.nameScore << ",";
-                    webhookPayload << "\"colorScore\":" << m.colorScore << ",";
-                    webhookPayload << "\"proximityScore\":" << m.proximityScore;
-                    webhookPayload << "}";
-                    webhookPayload << "}";
-                    if (i < matches.size() - 1) webhookPayload << ",";
-                }
-                webhookPayload << "]";
-                webhookPayload << "}";
-                
-                // Send webhook in background thread to not block response
-                std::thread([webhookUrl = system.getWebhookUrl(), payload = webhookPayload.str()]() {
-                    sendWebhookNotification(webhookUrl, payload);
-                }).detach();
-            }
-            
-            std::stringstream ss;
-            ss << "{\"success\": true, \"matches\": " << buildMatchesJson(matches) << "}";
-            res.body = ss.str();
+        std::vector<MatchCandidate> matches;
+        if (system.reportFoundItem(name, color, location, finder, description, category, finderEmail, matches).empty()) {
+            return logFailureResponse();
         }
-        else if (req.path == "/api/search" && req.method == "GET") {
-            // Autocomplete search
-            std::string query = urlDecode(getQueryParam(req.query, "q"));
-            std::string category = urlDecode(getQueryParam(req.query, "category"));
-            
-            std::vector<std::string> suggestions;
-            if (!category.empty()) {
-                suggestions = system.searchAutocompleteByCategory(query, category);
-            } else {
-                suggestions = system.searchAutocomplete(query);
-            }
-            res.body = buildSuggestionsJson(suggestions);
-        }
-        else if (req.path == "/api/search/advanced" && req.method == "GET") {
-            // Advanced search with multiple filters
-            std::string name = urlDecode(getQueryParam(req.query, "name"));
-            std::string color = urlDecode(getQueryParam(req.query, "color"));
-            std::string location = urlDecode(getQueryParam(req.query, "location"));
-            std::string category = urlDecode(getQueryParam(req.query, "category"));
-            std::string type = urlDecode(getQueryParam(req.query, "type"));
-            std::string dateFromStr = getQueryParam(req.query, "dateFrom");
-            std::string dateToStr = getQueryParam(req.query, "dateTo");
-            std::string includeArchivedStr = getQueryParam(req.query, "includeArchived");
-            
-            long long dateFrom = dateFromStr.empty() ? 0 : std::stoll(dateFromStr);
-            long long dateTo = dateToStr.empty() ? 0 : std::stoll(dateToStr);
-            bool includeArchived = includeArchivedStr == "true";
-            
-            auto items = system.advancedSearch(name, color, location, category, type, dateFrom, dateTo, includeArchived);
-            res.body = buildJsonResponse(items);
-        }
-        else if (req.path == "/api/history" && req.method == "GET") {
-            // Get sorted history
-            auto items = system.getHistory(false);
-            res.body = buildJsonResponse(items);
-        }
-        else if (req.path == "/api/items" && req.method == "GET") {
-            // Get all items (active only by default)
-            auto items = system.getActiveItems();
-            res.body = buildJsonResponse(items);
-        }
-        else if (req.path == "/api/items/active" && req.method == "GET") {
-            // Get active (non-archived) items
-            auto items = system.getActiveItems();
-            res.body = buildJsonResponse(items);
-        }
-        else if (req.path == "/api/items/archived" && req.method == "GET") {
-            // Get archived items
-            auto items = system.getArchivedItems();
-            res.body = buildJsonResponse(items);
-        }
-        else if (req.path == "/api/locations" && req.method == "GET") {
-            // Get available locations
-            auto locations = system.getLocations();
-            res.body = buildLocationsJson(locations);
-        }
-        else if (req.path == "/api/categories" && req.method == "GET") {
-            // Get all categories
-            auto categories = system.getCategories();
-            res.body = buildLocationsJson(categories);  // Reuse string array builder
-        }
-        else if (req.path.rfind("/api/category/", 0) == 0 && req.method == "GET") {
-            // Get items by category
-            std::string categoryName = req.path.substr(14);  // Extract category after "/api/category/"
-            auto items = system.getItemsByCategory(categoryName);
-            res.body = buildJsonResponse(items);
-        }
-        else if (req.path == "/api/lost" && req.method == "GET") {
-            // Get all lost items (active only)
-            auto allItems = system.getItemsByType("lost");
-            std::vector<Item> activeItems;
-            for (const auto& item : allItems) {
-                if (!item.archived) activeItems.push_back(item);
-            }
-            res.body = buildJsonResponse(activeItems);
-        }
-        else if (req.path == "/api/found" && req.method == "GET") {
-            // Get all found items (active only)
-            auto allItems = system.getItemsByType("found");
-            std::vector<Item> activeItems;
-            for (const auto& item : allItems) {
-                if (!item.archived) activeItems.push_back(item);
-            }
-            res.body = buildJsonResponse(activeItems);
-        }
-        else if (req.path == "/api/stats" && req.method == "GET") {
-            // Get statistics
-            std::stringstream ss;
-            ss << "{";
-            ss << "\"totalItems\": " << system.getTotalItems() << ",";
-            ss << "\"activeItems\": " << system.getActiveItemCount() << ",";
-            ss << "\"archivedItems\": " << system.getArchivedItemCount() << ",";
-            ss << "\"lostItems\": " << system.getItemsByType("lost").size() << ",";
-            ss << "\"foundItems\": " << system.getItemsByType("found").size();
-            ss << "}";
-            res.body = ss.str();
-        }
-        else if (req.path == "/api/webhook/config" && req.method == "POST") {
-            // Configure n8n webhook URL
-            std::string url = extractJsonValue(req.body, "url");
-            system.setWebhookUrl(url);
-            system.saveToFile("data.json");
-            res.body = "{\"success\": true, \"message\": \"Webhook URL configured\", \"url\": \"" + url + "\"}";
-        }
-        else if (req.path == "/api/webhook/config" && req.method == "GET") {
-            // Get webhook configuration
-            res.body = "{\"url\": \"" + system.getWebhookUrl() + "\"}";
-        }
-        else if (req.path == "/api/archive/expired" && req.method == "POST") {
-            // Manually trigger expiration check
-            int archived = system.archiveExpiredItems();
-            system.saveToFile("data.json");
-            std::stringstream ss;
-            ss << "{\"success\": true, \"archivedCount\": " << archived << "}";
-            res.body = ss.str();
-        }
-        else if (req.path == "/api/analytics" && req.method == "GET") {
-            // Get detailed analytics
-            AnalyticsData data = system.getAnalytics();
-            res.body = buildAnalyticsJson(data);
-        }
-        else if (req.path.rfind("/api/item/", 0) == 0 && req.path.find("/claim") != std::string::npos && req.method == "POST") {
-            // Claim item: /api/item/{id}/claim
-            size_t claimPos = req.path.find("/claim");
-            std::string itemId = req.path.substr(10, claimPos - 10);
-            std::string claimedBy = extractJsonValue(req.body, "claimedBy");
-            std::string claimerPhone = extractJsonValue(req.body, "claimerPhone");
-            
-            if (claimedBy.empty()) {
-                res.status = 400;
-                res.body = "{\"error\": \"Missing claimedBy field\"}";
-                return res;
-            }
+        
+        // Trigger n8n webhook if configured and matches found
+        if (!system.getWebhookUrl().empty() && !matches.empty()) {
+            appLogger().log(LogLevel::INFO, "🔔 Webhook trigger: " + std::to_string(matches.size()) + " matches found");
             
-            if (claimerPhone.empty()) {
-                res.status = 400;
-                res.body = "{\"error\": \"Missing claimerPhone field\"}";
-                return res;
-            }
+            // Build JSON payload for n8n with comprehensive data for LLM analysis
+            std::string webhookPayload;
+            JsonWriter payload(webhookPayload);
+            payload.beginObject();
+            payload.member("event", "match_found");
+            payload.key("foundItem");
+            payload.beginObject();
+            payload.member("name", name);
+            payload.member("description", description);
+            payload.member("color", color);
+            payload.member("location", location);
+            payload.member("finder", finder);
+            payload.member("finderPhone", finderPhone);
+            payload.member("category", category);
+            payload.member("reportedAt", static_cast<long long>(std::time(nullptr)));
+            payload.endObject();
+            payload.member("matchCount", matches.size());
+            payload.key("matches");
+            payload.beginArray();
             
-            bool success = system.claimItem(itemId, claimedBy);
-            if (success) {
-                system.saveToFile("data.json");
-                
-                // Trigger webhook for claiming - send to claimWebhookUrl if configured
-                std::string claimWebhookUrl = system.getClaimWebhookUrl();
-                Item* item = system.getItemById(itemId);
-                if (item && !claimWebhookUrl.empty()) {
-                    std::stringstream webhookPayload;
-                    webhookPayload << "{";
-                    webhookPayload << "\"event\":\"item_claimed_notification\",";
-                    webhookPayload << "\"claimer\":{";
-                    webhookPayload << "\"name\":\"" << claimedBy << "\",";
-                    webhookPayload << "\"phone\":\"" << claimerPhone << "\"";
-                    webhookPayload << "},";
-                    webhookPayload << "\"founder\":{";
-                    webhookPayload << "\"name\":\"" << item->owner << "\",";
-                    webhookPayload << "\"email\":\"" << item->email << "\"";
-                    webhookPayload << "},";
-                    webhookPayload << "\"item\":{";
-                    webhookPayload << "\"id\":\"" << item->id << "\",";
-                    webhookPayload << "\"name\":\"" << item->name << "\",";
-                    webhookPayload << "\"description\":\"" << item->description << "\",";
-                    webhookPayload << "\"color\":\"" << item->color << "\",";
-                    webhookPayload << "\"location\":\"" << item->location << "\",";
-                    webhookPayload << "\"category\":\"" << categoryToString(item->category) << "\"";
-                    webhookPayload << "},";
-                    webhookPayload << "\"claimedAt\":" << item->claimedAt;
-                    webhookPayload << "}";
-                    
-                    // Send webhook in background thread to not block response
-                    std::thread([claimWebhookUrl, payload = webhookPayload.str()]() {
-                        sendWebhookNotification(claimWebhookUrl, payload);
-                    }).detach();
-                }
+            for (const auto& m : matches) {
+                // Get the full item to access email and other details
+                Item matchedCopy;
+                Item* matchedItem = system.getItemById(m.itemId, matchedCopy) ? &matchedCopy : nullptr;
                 
-                res.body = "{\"success\": true, \"message\": \"Item claimed successfully\"}";
-            } else {
-                res.status = 404;
-                res.body = "{\"error\": \"Item not found\"}";
+                payload.beginObject();
+                payload.member("itemId", m.itemId);
+                payload.member("itemName", m.itemName);
+                payload.member("description", matchedItem ? matchedItem->description : std::string());
+                payload.member("owner", m.owner);
+                payload.member("email", matchedItem ? matchedItem->email : std::string());
+                payload.member("location", m.location);
+                payload.member("color", m.color);
+                payload.member("category", matchedItem ? categoryToString(matchedItem->category) : std::string());
+                payload.member("reportedAt", matchedItem ? matchedItem->timestamp : 0LL);
+                payload.member("score", m.score);
+                payload.key("scoreBreakdown");
+                payload.beginObject();
+                payload.member("nameScore", m.nameScore);
+                payload.member("colorScore", m.colorScore);
+                payload.member("proximityScore", m.proximityScore);
+                payload.endObject();
+                payload.endObject();
             }
-        }
-        else if (req.path.rfind("/api/item/", 0) == 0 && req.path.find("/archive") != std::string::npos && req.method == "POST") {
-            // Archive specific item
-            size_t archivePos = req.path.find("/archive");
-            std::string itemId = req.path.substr(10, archivePos - 10);
+            payload.endArray();
+            payload.endObject();
             
-            bool archived = system.archiveItem(itemId);
-            if (archived) {
-                system.saveToFile("data.json");
-                res.body = "{\"success\": true, \"message\": \"Item archived\"}";
-            } else {
-                res.status = 404;
-                res.statusText = "Not Found";
-                res.body = "{\"error\": \"Item not found\"}";
-            }
-        }
-        else if (req.path == "/api/webhook" && req.method == "GET") {
-            // Get current webhook URL
-            res.body = "{\"webhookUrl\": \"" + system.getWebhookUrl() + "\"}";
-        }
-        else if (req.path == "/api/webhook" && req.method == "POST") {
-            // Update webhook URL
-            std::string url = extractJsonValue(req.body, "url");
-            if (url.empty()) {
-                res.status = 400;
-                res.statusText = "Bad Request";
-                res.body = "{\"error\": \"URL is required\"}";
-            } else {
-                system.setWebhookUrl(url);
-                system.saveToFile("data.json");
-                res.body = "{\"success\": true, \"webhookUrl\": \"" + url + "\"}";
-            }
-        }
-        else if (req.path == "/api/webhook/claim" && req.method == "GET") {
-            // Get current claim webhook URL
-            res.body = "{\"claimWebhookUrl\": \"" + system.getClaimWebhookUrl() + "\"}";
-        }
-        else if (req.path == "/api/webhook/claim" && req.method == "POST") {
-            // Update claim webhook URL
-            std::string url = extractJsonValue(req.body, "url");
-            if (url.empty()) {
-                res.status = 400;
-                res.statusText = "Bad Request";
-                res.body = "{\"error\": \"URL is required\"}";
+            // Send webhook in the background to not block response
+            dispatchWebhook(system.getWebhookUrl(), webhookPayload);
+        }
+        
+        std::stringstream ss;
+        ss << "{\"success\": true, \"matches\": " << buildMatchesJson(matches) << "}";
+        res.body = ss.str();
+        
+        return res;
+    }
+    
+    // Autocomplete search
+    HttpResponse handleSearch(const HttpRequest& req, const RouteParams&) {
+        HttpResponse res;
+        std::string query = urlDecode(getQueryParam(req.query, "q"));
+        std::string category = urlDecode(getQueryParam(req.query, "category"));
+        // fuzzy=1 or 2 tolerates that many typos, fuzzy=true as many as
+        // the query is long enough for
+        std::string fuzzy = getQueryParam(req.query, "fuzzy");
+        int maxEdits = fuzzy == "true" || fuzzy == "2" ? 2 : fuzzy == "1" ? 1 : 0;
+        
+        std::vector<std::string> suggestions;
+        if (!category.empty()) {
+            suggestions = system.searchAutocompleteByCategory(query, category, maxEdits);
+        } else {
+            suggestions = system.searchAutocomplete(query, maxEdits);
+        }
+        res.body = buildStringsJson(suggestions);
+        
+        return res;
+    }
+    
+    // Advanced search with multiple filters
+    HttpResponse handleAdvancedSearch(const HttpRequest& req, const RouteParams&) {
+        std::string name = urlDecode(getQueryParam(req.query, "name"));
+        std::string color = urlDecode(getQueryParam(req.query, "color"));
+        std::string location = urlDecode(getQueryParam(req.query, "location"));
+        std::string category = urlDecode(getQueryParam(req.query, "category"));
+        std::string type = urlDecode(getQueryParam(req.query, "type"));
+        std::string dateFromStr = getQueryParam(req.query, "dateFrom");
+        std::string dateToStr = getQueryParam(req.query, "dateTo");
+        std::string includeArchivedStr = getQueryParam(req.query, "includeArchived");
+        
+        long long dateFrom = dateFromStr.empty() ? 0 : std::stoll(dateFromStr);
+        long long dateTo = dateToStr.empty() ? 0 : std::stoll(dateToStr);
+        bool includeArchived = includeArchivedStr == "true";
+        
+        return streamItemsJson([=](const std::function<void(const Item&)>& visit) {
+            system.forEachSearchResult(name, color, location, category, type,
+                                       dateFrom, dateTo, includeArchived, visit);
+        });
+    }
+    
+    // Get sorted history
+    HttpResponse handleHistory(const HttpRequest&, const RouteParams&) {
+        return streamItemsJson([this](const std::function<void(const Item&)>& visit) {
+            system.forEachHistoryItem(false, visit);
+        });
+    }
+    
+    // Get active (non-archived) items
+    HttpResponse handleActiveItems(const HttpRequest&, const RouteParams&) {
+        return streamItemsJson([this](const std::function<void(const Item&)>& visit) {
+            system.forEachActiveItem(visit);
+        });
+    }
+    
+    // Dashboard polling target: rendered whole and cached per generation
+    // rather than streamed like /api/items
+    HttpResponse handleActiveItemsView(const HttpRequest& req, const RouteParams&) {
+        return cachedView(req, VIEW_ACTIVE_ITEMS, [this]() {
+            return buildJsonResponse(system.getActiveItems());
+        });
+    }
+    
+    // Get archived items
+    HttpResponse handleArchivedItems(const HttpRequest&, const RouteParams&) {
+        return streamItemsJson([this](const std::function<void(const Item&)>& visit) {
+            system.forEachArchivedItem(visit);
+        });
+    }
+    
+    // Get available locations
+    HttpResponse handleLocations(const HttpRequest& req, const RouteParams&) {
+        return cachedView(req, VIEW_LOCATIONS, [this]() {
+            return buildStringsJson(system.getLocations());
+        });
+    }
+    
+    // Get all categories
+    HttpResponse handleCategories(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        auto categories = system.getCategories();
+        res.body = buildStringsJson(categories);
+        
+        return res;
+    }
+    
+    // Get items by category
+    HttpResponse handleItemsByCategory(const HttpRequest&, const RouteParams& params) {
+        HttpResponse res;
+        std::string categoryName = params.get("name");
+        auto items = system.getItemsByCategory(categoryName);
+        res.body = buildJsonResponse(items);
+        
+        return res;
+    }
+    
+    // Get all lost items (active only)
+    HttpResponse handleLostItems(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        res.body = buildJsonResponse(system.getActiveItemsByType("lost"));
+        
+        return res;
+    }
+    
+    // Get all found items (active only)
+    HttpResponse handleFoundItems(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        res.body = buildJsonResponse(system.getActiveItemsByType("found"));
+        
+        return res;
+    }
+    
+    // Get statistics
+    HttpResponse handleStats(const HttpRequest& req, const RouteParams&) {
+        return cachedView(req, VIEW_STATS, [this]() {
+            std::stringstream ss;
+            ss << "{";
+            ss << "\"totalItems\": " << system.getTotalItems() << ",";
+            ss << "\"activeItems\": " << system.getActiveItemCount() << ",";
+            ss << "\"archivedItems\": " << system.getArchivedItemCount() << ",";
+            ss << "\"lostItems\": " << system.countItemsByType("lost") << ",";
+            ss << "\"foundItems\": " << system.countItemsByType("found");
+            ss << "}";
+            return ss.str();
+        });
+    }
+    
+    // Server load counters
+    HttpResponse handleMetrics(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        std::stringstream ss;
+        ss << "{\"workerPool\": " << buildPoolStatsJson(workerPool->getStats())
+           << ", \"webhookPool\": " << buildPoolStatsJson(webhookPool->getStats());
+        LoggerStats logStats = appLogger().getStats();
+        ss << ", \"logger\": {\"capacity\": " << logStats.capacity << ","
+           << "\"written\": " << logStats.written << ","
+           << "\"dropped\": " << logStats.dropped << "}";
+        EpochStats epochStats = system.getEpochStats();
+        ss << ", \"snapshots\": {\"epoch\": " << epochStats.epoch << ","
+           << "\"pendingRetired\": " << epochStats.pendingRetired << ","
+           << "\"reclaimed\": " << epochStats.reclaimed << "}";
+        WalStats walStats = system.getLogStats();
+        ss << ", \"wal\": {\"fsync\": \"" << walSyncPolicyName(config.walOptions.policy) << "\","
+           << "\"segment\": " << walStats.segment << ","
+           << "\"appended\": " << walStats.appended << ","
+           << "\"sinceCheckpoint\": " << walStats.sinceCheckpoint << ","
+           << "\"batches\": " << walStats.batches << ","
+           << "\"syncs\": " << walStats.syncs << ","
+           << "\"writeErrors\": " << walStats.writeErrors << "}";
+        CheckpointStats checkpointStats = system.getCheckpointStats();
+        ss << ", \"checkpoints\": {\"mode\": \"" << (config.forkSnapshots ? "fork" : "inline") << "\","
+           << "\"completed\": " << checkpointStats.completed << ","
+           << "\"failed\": " << checkpointStats.failed << ","
+           << "\"inProgress\": " << (checkpointStats.inProgress ? "true" : "false") << ","
+           << "\"lastForked\": " << (checkpointStats.lastForked ? "true" : "false") << ","
+           << "\"lastDurationMs\": " << checkpointStats.lastDurationMs << ","
+           << "\"lastForkMs\": " << checkpointStats.lastForkMs << ","
+           << "\"lastCowBytes\": " << checkpointStats.lastCowBytes << ","
+           << "\"lastCompletedAt\": " << checkpointStats.lastCompletedAt << "}";
+        ColdArchiveStats coldStats = system.getColdStats();
+        ss << ", \"cold\": {\"segments\": " << coldStats.segments << ","
+           << "\"items\": " << coldStats.items << ","
+           << "\"bytes\": " << coldStats.bytes << ","
+           << "\"tombstones\": " << coldStats.tombstones << "}";
+#ifdef HAVE_IO_URING
+        // Divide by workerPool.completed for syscalls per request
+        if (config.ioMode == IoMode::IO_URING) {
+            ss << ", \"ioUring\": {\"enterCalls\": " << uringEnterCalls() << "}";
+        }
+#endif
+        ss << "}";
+        res.body = ss.str();
+        
+        return res;
+    }
+    
+    // Configure n8n webhook URL
+    HttpResponse handleSetWebhookConfig(const HttpRequest& req, const RouteParams&) {
+        HttpResponse res;
+        std::string url = extractJsonValue(req.body, "url");
+        if (!system.setWebhookUrl(url)) return logFailureResponse();
+        std::string body;
+        JsonWriter json(body);
+        json.beginObject();
+        json.member("success", true);
+        json.member("message", "Webhook URL configured");
+        json.member("url", url);
+        json.endObject();
+        res.body = body;
+        
+        return res;
+    }
+    
+    // Get webhook configuration
+    HttpResponse handleGetWebhookConfig(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        std::string body;
+        JsonWriter json(body);
+        json.beginObject();
+        json.member("url", system.getWebhookUrl());
+        json.endObject();
+        res.body = body;
+        
+        return res;
+    }
+    
+    // Manually trigger expiration check
+    HttpResponse handleArchiveExpired(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        int archived = 0;
+        if (system.archiveExpiredItems(archived) == MutationStatus::LOG_FAILED) return logFailureResponse();
+        std::stringstream ss;
+        ss << "{\"success\": true, \"archivedCount\": " << archived << "}";
+        res.body = ss.str();
+        
+        return res;
+    }
+    
+    // Get detailed analytics
+    HttpResponse handleAnalytics(const HttpRequest& req, const RouteParams&) {
+        return cachedView(req, VIEW_ANALYTICS, [this]() {
+            return buildAnalyticsJson(system.getAnalytics());
+        });
+    }
+    
+    // Claim item
+    HttpResponse handleClaimItem(const HttpRequest& req, const RouteParams& params) {
+        HttpResponse res;
+        std::string itemId = params.get("id");
+        std::string claimedBy = extractJsonValue(req.body, "claimedBy");
+        std::string claimerPhone = extractJsonValue(req.body, "claimerPhone");
+        
+        if (claimedBy.empty()) {
+            res.status = 400;
+            res.body = "{\"error\": \"Missing claimedBy field\"}";
+            return res;
+        }
+        
+        if (claimerPhone.empty()) {
+            res.status = 400;
+            res.body = "{\"error\": \"Missing claimerPhone field\"}";
+            return res;
+        }
+        
+        MutationStatus status = system.claimItem(itemId, claimedBy);
+        if (status == MutationStatus::LOG_FAILED) return logFailureResponse();
+        if (status == MutationStatus::DONE) {
+            // Trigger webhook for claiming - send to claimWebhookUrl if configured
+            std::string claimWebhookUrl = system.getClaimWebhookUrl();
+            Item claimedCopy;
+            Item* item = system.getItemById(itemId, claimedCopy) ? &claimedCopy : nullptr;
+            if (item && !claimWebhookUrl.empty()) {
+                std::string webhookPayload;
+                JsonWriter payload(webhookPayload);
+                payload.beginObject();
+                payload.member("event", "item_claimed_notification");
+                payload.key("claimer");
+                payload.beginObject();
+                payload.member("name", claimedBy);
+                payload.member("phone", claimerPhone);
+                payload.endObject();
+                payload.key("founder");
+                payload.beginObject();
+                payload.member("name", item->owner);
+                payload.member("email", item->email);
+                payload.endObject();
+                payload.key("item");
+                payload.beginObject();
+                payload.member("id", item->id);
+                payload.member("name", item->name);
+                payload.member("description", item->description);
+                payload.member("color", item->color);
+                payload.member("location", item->location);
+                payload.member("category", item->category);
+                payload.endObject();
+                payload.member("claimedAt", item->claimedAt);
+                payload.endObject();
+                
+                // Send webhook in the background to not block response
+                dispatchWebhook(claimWebhookUrl, webhookPayload);
+            }
+            
+            res.body = "{\"success\": true, \"message\": \"Item claimed successfully\"}";
+        } else {
+            res.status = 404;
+            res.body = "{\"error\": \"Item not found\"}";
+        }
+        
+        return res;
+    }
+    
+    // Archive specific item
+    HttpResponse handleArchiveItem(const HttpRequest&, const RouteParams& params) {
+        HttpResponse res;
+        std::string itemId = params.get("id");
+        
+        MutationStatus status = system.archiveItem(itemId);
+        if (status == MutationStatus::LOG_FAILED) return logFailureResponse();
+        if (status == MutationStatus::NOT_FOUND) return itemNotFoundResponse();
+        res.body = "{\"success\": true, \"message\": \"Item archived\"}";
+        
+        return res;
+    }
+    
+    // Get current webhook URL
+    HttpResponse handleGetWebhook(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        std::string body;
+        JsonWriter json(body);
+        json.beginObject();
+        json.member("webhookUrl", system.getWebhookUrl());
+        json.endObject();
+        res.body = body;
+        
+        return res;
+    }
+    
+    // Update webhook URL
+    HttpResponse handleSetWebhook(const HttpRequest& req, const RouteParams&) {
+        HttpResponse res;
+        std::string url = extractJsonValue(req.body, "url");
+        if (url.empty()) {
+            res.status = 400;
+            res.statusText = "Bad Request";
+            res.body = "{\"error\": \"URL is required\"}";
+        } else if (!system.setWebhookUrl(url)) {
+            return logFailureResponse();
+        } else {
+            std::string body;
+            JsonWriter json(body);
+            json.beginObject();
+            json.member("success", true);
+            json.member("webhookUrl", url);
+            json.endObject();
+            res.body = body;
+        }
+        
+        return res;
+    }
+    
+    // Get current claim webhook URL
+    HttpResponse handleGetClaimWebhook(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        std::string body;
+        JsonWriter json(body);
+        json.beginObject();
+        json.member("claimWebhookUrl", system.getClaimWebhookUrl());
+        json.endObject();
+        res.body = body;
+        
+        return res;
+    }
+    
+    // Update claim webhook URL
+    HttpResponse handleSetClaimWebhook(const HttpRequest& req, const RouteParams&) {
+        HttpResponse res;
+        std::string url = extractJsonValue(req.body, "url");
+        if (url.empty()) {
+            res.status = 400;
+            res.statusText = "Bad Request";
+            res.body = "{\"error\": \"URL is required\"}";
+        } else if (!system.setClaimWebhookUrl(url)) {
+            return logFailureResponse();
+        } else {
+            std::string body;
+            JsonWriter json(body);
+            json.beginObject();
+            json.member("success", true);
+            json.member("claimWebhookUrl", url);
+            json.endObject();
+            res.body = body;
+        }
+        
+        return res;
+    }
+    
+    // API info
+    HttpResponse handleApiInfo(const HttpRequest&, const RouteParams&) {
+        HttpResponse res;
+        res.body = "{\"name\": \"Lost & Found API\", \"version\": \"2.0.0\", \"status\": \"running\", \"features\": [\"categories\", \"advanced-search\", \"expiration\", \"webhooks\"]}";
+        
+        return res;
+    }
+    
+    // Delete item by ID
+    HttpResponse handleDeleteItem(const HttpRequest&, const RouteParams& params) {
+        HttpResponse res;
+        std::string itemId = params.get("id");
+        MutationStatus status = system.deleteItem(itemId);
+        if (status == MutationStatus::LOG_FAILED) return logFailureResponse();
+        if (status == MutationStatus::NOT_FOUND) return itemNotFoundResponse();
+        res.body = "{\"success\": true, \"message\": \"Item deleted successfully\"}";
+        
+        return res;
+    }
+    
+    // ========================================================================
+    // ROUTE TABLE - Built once at startup, resolved per request in
+    // O(path segments) by the router trie
+    // ========================================================================
+    void registerRoutes() {
+        router.add("POST", "/api/lost", &HttpServer::handleReportLost);
+        router.add("GET", "/api/lost", &HttpServer::handleLostItems);
+        router.add("POST", "/api/found", &HttpServer::handleReportFound);
+        router.add("GET", "/api/found", &HttpServer::handleFoundItems);
+        router.add("GET", "/api/search", &HttpServer::handleSearch);
+        router.add("GET", "/api/search/advanced", &HttpServer::handleAdvancedSearch);
+        router.add("GET", "/api/history", &HttpServer::handleHistory);
+        router.add("GET", "/api/items", &HttpServer::handleActiveItems);
+        router.add("GET", "/api/items/active", &HttpServer::handleActiveItemsView);
+        router.add("GET", "/api/items/archived", &HttpServer::handleArchivedItems);
+        router.add("GET", "/api/locations", &HttpServer::handleLocations);
+        router.add("GET", "/api/categories", &HttpServer::handleCategories);
+        router.add("GET", "/api/category/{name}", &HttpServer::handleItemsByCategory);
+        router.add("GET", "/api/stats", &HttpServer::handleStats);
+        router.add("GET", "/api/metrics", &HttpServer::handleMetrics);
+        router.add("GET", "/api/analytics", &HttpServer::handleAnalytics);
+        router.add("POST", "/api/archive/expired", &HttpServer::handleArchiveExpired);
+        router.add("POST", "/api/item/{id}/claim", &HttpServer::handleClaimItem);
+        router.add("POST", "/api/item/{id}/archive", &HttpServer::handleArchiveItem);
+        router.add("DELETE", "/api/item/{id}", &HttpServer::handleDeleteItem);
+        router.add("GET", "/api/webhook", &HttpServer::handleGetWebhook);
+        router.add("POST", "/api/webhook", &HttpServer::handleSetWebhook);
+        router.add("GET", "/api/webhook/config", &HttpServer::handleGetWebhookConfig);
+        router.add("POST", "/api/webhook/config", &HttpServer::handleSetWebhookConfig);
+        router.add("GET", "/api/webhook/claim", &HttpServer::handleGetClaimWebhook);
+        router.add("POST", "/api/webhook/claim", &HttpServer::handleSetClaimWebhook);
+        router.add("*", "/", &HttpServer::handleApiInfo);
+        router.add("*", "/api", &HttpServer::handleApiInfo);
+    }
+    
+    // routeId reports the matched route (-1 if none) for the request log
+    HttpResponse handleRequest(const HttpRequest& req, int& routeId) {
+        HttpResponse res;
+        routeId = -1;
+        
+        // Handle CORS preflight
+        if (req.method == "OPTIONS") {
+            res.status = 204;
+            res.statusText = "No Content";
+            res.body = "";
+            return res;
+        }
+        
+        RouteParams params;
+        auto match = router.match(req.method, req.path, params);
+        routeId = match.routeId;
+        if (match.handler) {
+            return (this->*(*match.handler))(req, params);
+        }
+        
+        if (!match.allow.empty()) {
+            res.status = 405;
+            res.statusText = "Method Not Allowed";
+            res.headers.push_back({"Allow", match.allow});
+            res.body = "{\"error\": \"Method not allowed\"}";
+        } else {
+            res.status = 404;
+            res.statusText = "Not Found";
+            res.body = "{\"error\": \"Endpoint not found\"}";
+        }
+        return res;
+    }
+    
+    // Handle one parsed request and render its response. requestNumber is
+    // 1-based within the connection; keepAlive reports whether it may continue.
+    // Logged latency covers handling and rendering; a streamed body is
+    // still being produced when the record is written.
+    WireResponse serveRequest(const HttpRequest& req, int requestNumber, bool& keepAlive) {
+        auto started = std::chrono::steady_clock::now();
+        int routeId;
+        HttpResponse res = handleRequest(req, routeId);
+        res.keepAlive = req.wantsKeepAlive() && requestNumber < config.maxRequestsPerConnection;
+        keepAlive = res.keepAlive;
+        
+        // Chunked encoding is HTTP/1.1 only; older clients get the body whole
+        if (res.streamBody && req.version != "HTTP/1.1") {
+            BodyWriter writer([&res](std::string&& piece) {
+                res.body += piece;
+                return true;
+            }, false);
+            res.streamBody(writer);
+            writer.finish();
+            res.streamBody = nullptr;
+        }
+        WireResponse wire = renderResponse(res);
+        
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started).count();
+        appLogger().logRequest(res.status >= 500 ? LogLevel::WARN : LogLevel::INFO,
+                               req.method, req.path, routeId, res.status, static_cast<uint32_t>(latency));
+        return wire;
+    }
+    
+    // Malformed or oversized request; the connection is closed after this
+    WireResponse buildParseErrorResponse(const HttpRequestParser& parser) {
+        HttpResponse res;
+        res.status = parser.getErrorStatus();
+        res.statusText = parser.getErrorText();
+        res.body = "{\"error\": \"" + parser.getErrorText() + "\"}";
+        return renderResponse(res);
+    }
+    
+    // Run the parser over buffered bytes. Returns true with a rendered response
+    // queued on out when a request completed or was rejected; false when more
+    // bytes are needed.
+    bool serveBuffered(socket_t clientSocket, RecvBuffer& in, HttpRequestParser& parser,
+                       int& requestsServed, OutputQueue& out, bool& keepAlive) {
+        in.consume(parser.feed(in.readPtr(), in.readable()));
+        
+        if (parser.getState() == HttpRequestParser::State::COMPLETE) {
+            WireResponse response = serveRequest(parser.request(), ++requestsServed, keepAlive);
+            parser.reset();
+            if (response.producer) {
+                BodyProducer producer = std::move(response.producer);
+                out.push(std::move(response));
+                if (!streamBlocking(clientSocket, out, producer)) keepAlive = false;
+            } else {
+                out.push(std::move(response));
+            }
+            return true;
+        }
+        if (parser.getState() == HttpRequestParser::State::ERROR) {
+            out.push(buildParseErrorResponse(parser));
+            keepAlive = false;
+            return true;
+        }
+        return false;
+    }
+    
+    // Blocking sockets stream from the serving thread: flush what is queued
+    // (ending with the chunked header block), then write each chunk as it fills
+    bool streamBlocking(socket_t clientSocket, OutputQueue& out, const BodyProducer& producer) {
+        if (out.writeTo(clientSocket) != WriteResult::DONE) return false;
+        BodyWriter writer([&out, clientSocket](std::string&& chunk) {
+            WireResponse piece;
+            piece.body = std::move(chunk);
+            out.push(std::move(piece));
+            return out.writeTo(clientSocket) == WriteResult::DONE;
+        });
+        producer(writer);
+        writer.finish();
+        return writer.ok();
+    }
+    
+    // Half-close and discard unread input so a client that is still sending
+    // sees our (error) response rather than a connection reset
+    void closeGracefully(socket_t clientSocket) {
+#ifndef _WIN32
+        shutdown(clientSocket, SHUT_WR);
+        char discard[4096];
+        while (recv(clientSocket, discard, sizeof(discard), MSG_DONTWAIT) > 0) {
+        }
+#endif
+        CLOSE_SOCKET(clientSocket);
+    }
+    
+    // ========================================================================
+    // BLOCKING MODE - Pooled workers over blocking sockets
+    // Between requests a connection is parked with the idle poller rather
+    // than left with a worker blocked in recv(), so idle keep-alive clients
+    // never hold workers that newly accepted connections are waiting for.
+    // ========================================================================
+    // Handle what the client has sent so far, answering every complete
+    // (possibly pipelined) request in order, then park the connection again
+    void handleClient(const BlockingConnectionPtr& conn) {
+        char* space = conn->in.writePtr(4096);
+        int bytesRead = recv(conn->fd, space, static_cast<int>(conn->in.writable()), 0);
+        if (bytesRead <= 0) {
+            closeGracefully(conn->fd);
+            return;
+        }
+        conn->in.commit(bytesRead);
+        
+        OutputQueue responses;
+        bool keepAlive = true;
+        while (keepAlive && serveBuffered(conn->fd, conn->in, conn->parser, conn->requestsServed, responses, keepAlive)) {
+        }
+        if (responses.writeTo(conn->fd) != WriteResult::DONE) {
+            keepAlive = false;
+        }
+        
+        if (!keepAlive) {
+            closeGracefully(conn->fd);
+            return;
+        }
+        conn->lastActivity = std::chrono::steady_clock::now();
+        parkConnection(conn);
+    }
+    
+    // Pool saturated or the request waited past the queueing deadline
+    WireResponse buildOverloadResponse() {
+        HttpResponse res;
+        res.status = 503;
+        res.statusText = "Service Unavailable";
+        res.headers.push_back({"Retry-After", std::to_string(config.retryAfterSec)});
+        res.body = "{\"error\": \"Server is busy, please retry shortly\"}";
+        return renderResponse(res);
+    }
+    
+    // Answer 503 on a blocking socket that never got a worker
+    void rejectClient(socket_t clientSocket) {
+        OutputQueue response;
+        response.push(buildOverloadResponse());
+        response.writeTo(clientSocket);
+        closeGracefully(clientSocket);
+    }
+    
+    // Queue a webhook on its own small pool so slow endpoints can't tie up
+    // request workers; notifications are dropped when that queue is full
+    void dispatchWebhook(const std::string& url, const std::string& payload) {
+        bool queued = webhookPool->trySubmit([url, payload]() {
+            sendWebhookNotification(url, payload);
+        });
+        if (!queued) {
+            appLogger().log(LogLevel::WARN, "⚠️ Webhook queue full, notification dropped");
+        }
+    }
+    
+    // Hand a connection with bytes waiting to a worker
+    void dispatchConnection(const BlockingConnectionPtr& conn) {
+        bool queued = workerPool->trySubmit(
+            [this, conn]() { handleClient(conn); },
+            [this, conn]() { rejectClient(conn->fd); });
+        if (!queued) {
+            rejectClient(conn->fd);
+        }
+    }
+    
+    // Give a connection to the idle poller until the client sends more
+    void parkConnection(const BlockingConnectionPtr& conn) {
+        bool taken;
+        {
+            std::lock_guard<std::mutex> lock(parkedMutex);
+            taken = !pollerStopped;
+            if (taken) parked.push_back(conn);
+        }
+        if (!taken) {
+            closeGracefully(conn->fd);
+            return;
+        }
+#ifndef _WIN32
+        char one = 1;
+        ssize_t written = write(parkWake[1], &one, 1);
+        (void)written;
+#endif
+    }
+    
+    // Wait on every parked connection at once: dispatch those the client
+    // has written to (or closed), close those idle past the keep-alive timeout
+    void runIdlePoller() {
+        std::vector<BlockingConnectionPtr> idle;
+        std::vector<BlockingConnectionPtr> still;
+        std::vector<struct pollfd> fds;
+        auto idleTimeout = std::chrono::seconds(config.keepAliveTimeoutSec);
+#ifdef _WIN32
+        const int waitMs = 10;      // No wake pipe: newly parked connections are picked up on the next round
+        const size_t first = 0;
+#else
+        const int waitMs = 1000;
+        const size_t first = 1;     // fds[0] is the wake pipe
+#endif
+        
+        while (running) {
+            {
+                std::lock_guard<std::mutex> lock(parkedMutex);
+                idle.insert(idle.end(), parked.begin(), parked.end());
+                parked.clear();
+            }
+            
+            fds.clear();
+#ifndef _WIN32
+            fds.push_back({parkWake[0], POLLIN, 0});
+#endif
+            for (const BlockingConnectionPtr& conn : idle) {
+                struct pollfd entry;
+                entry.fd = conn->fd;
+                entry.events = POLLIN;
+                entry.revents = 0;
+                fds.push_back(entry);
+            }
+            if (fds.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+                continue;
+            }
+            int ready = POLL_SOCKETS(fds.data(), static_cast<unsigned long>(fds.size()), waitMs);
+            if (ready < 0) continue;    // EINTR; anything else shows up per descriptor
+#ifndef _WIN32
+            if (fds[0].revents & POLLIN) {
+                char drained[64];
+                while (read(parkWake[0], drained, sizeof(drained)) > 0) {
+                }
+            }
+#endif
+            
+            auto now = std::chrono::steady_clock::now();
+            still.clear();
+            for (size_t i = 0; i < idle.size(); i++) {
+                if (fds[first + i].revents != 0) {
+                    dispatchConnection(idle[i]);
+                } else if (now - idle[i]->lastActivity > idleTimeout) {
+                    closeGracefully(idle[i]->fd);
+                } else {
+                    still.push_back(idle[i]);
+                }
+            }
+            idle.swap(still);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(parkedMutex);
+            pollerStopped = true;
+            idle.insert(idle.end(), parked.begin(), parked.end());
+            parked.clear();
+        }
+        for (const BlockingConnectionPtr& conn : idle) {
+            closeGracefully(conn->fd);
+        }
+    }
+    
+    // Blocking sockets: one accept thread, the idle poller, and pooled
+    // workers that only ever hold a connection while it has bytes to handle
+    void runThreadPerConnection() {
+#ifndef _WIN32
+        if (pipe(parkWake) != 0) {
+            std::cerr << "Failed to create the idle poller's wake pipe" << std::endl;
+            return;
+        }
+        for (int fd : parkWake) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+#endif
+        std::thread poller(&HttpServer::runIdlePoller, this);
+        
+        while (running) {
+            struct sockaddr_in clientAddr;
+            int clientAddrLen = sizeof(clientAddr);
+            
+            socket_t clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, 
+#ifdef _WIN32
+                (int*)&clientAddrLen
+#else
+                (socklen_t*)&clientAddrLen
+#endif
+            );
+            
+            if (clientSocket != INVALID_SOCKET) {
+                // A worker only reads once the poller has seen bytes; the
+                // timeout just bounds a read that still finds none
+#ifdef _WIN32
+                DWORD timeoutMs = config.keepAliveTimeoutSec * 1000;
+                setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeoutMs, sizeof(timeoutMs));
+#else
+                struct timeval timeout;
+                timeout.tv_sec = config.keepAliveTimeoutSec;
+                timeout.tv_usec = 0;
+                setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+                parkConnection(std::make_shared<BlockingConnection>(clientSocket, config.parserLimits));
+            }
+        }
+        
+        poller.join();
+#ifndef _WIN32
+        close(parkWake[0]);
+        close(parkWake[1]);
+#endif
+    }
+    
+#ifdef HAVE_EPOLL
+    // ========================================================================
+    // EPOLL REACTOR - Non-blocking sockets, edge-triggered readiness
+    // Event loops only do I/O and parsing. Each complete request is handed to
+    // the worker pool and its response comes back through the loop's
+    // completion queue; a connection has at most one request in flight so
+    // pipelined responses stay in order.
+    // ========================================================================
+    // Pipelined responses are queued at most this far ahead of the socket
+    static const size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+    // Chunks a streaming worker may run ahead of the socket
+    static constexpr size_t STREAM_WINDOW_CHUNKS = 4;
+    
+    // Input buffered ahead of the parser is held to one request of the
+    // largest size allowed; past that a connection stops reading until the
+    // requests in front are answered, so a client pipelining without reading
+    // its responses can't grow the buffer without bound
+    size_t maxBufferedInput() const {
+        return config.parserLimits.maxHeaderBytes + config.parserLimits.maxBodyBytes;
+    }
+    
+    struct Connection {
+        socket_t fd;
+        uint64_t id;                // Distinguishes connections that reuse an fd
+        RecvBuffer in;
+        HttpRequestParser parser;
+        OutputQueue out;
+        int requestsServed;
+        bool inFlight;
+        bool closeAfterWrite;
+        bool peerClosed;
+        bool readPaused;            // Input buffer full; not reading until it drains
+        std::chrono::steady_clock::time_point lastActivity;
+#ifdef HAVE_IO_URING
+        // io_uring backend: submitted operations that still reference this
+        static const int MAX_SEND_IOV = 64;
+        int pendingOps;
+        bool recvArmed;
+        bool sending;
+        bool closeLinked;           // send -> shutdown -> close chain submitted
+        bool closing;
+        bool fdClosed;
+        struct msghdr sendMsg;
+        struct iovec sendIov[MAX_SEND_IOV];
+#endif
+        
+        Connection(socket_t fd, uint64_t id, const HttpParserLimits& limits)
+            : fd(fd), id(id), parser(limits), requestsServed(0), inFlight(false),
+              closeAfterWrite(false), peerClosed(false), readPaused(false), lastActivity(std::chrono::steady_clock::now())
+#ifdef HAVE_IO_URING
+              , pendingOps(0), recvArmed(false), sending(false), closeLinked(false), closing(false),
+              fdClosed(false)
+#endif
+        {}
+    };
+    
+    struct Completion {
+        socket_t fd;
+        uint64_t connectionId;
+        WireResponse response;
+        bool keepAlive;
+        bool streamReady;           // No response: a streamed body has chunks waiting
+    };
+    
+    struct EventLoop {
+        int index;
+        socket_t listener;          // Shared serverSocket, or this loop's own with --reuseport
+        int epollFd;
+        int wakeFd;                 // eventfd poked by workers after posting a completion
+        std::mutex completionMutex;
+        std::vector<Completion> completions;
+        bool stopped;               // Loop has exited; completions are dropped as posted
+        std::unordered_map<socket_t, std::unique_ptr<Connection>> connections;
+        uint64_t nextConnectionId;
+#ifdef HAVE_IO_URING
+        std::unique_ptr<IoUring> ring;                  // Set only in io_uring mode
+        std::unique_ptr<ProvidedBuffers> recvBuffers;
+        std::vector<std::unique_ptr<Connection>> retired;   // Closed, operations still in flight
+        std::atomic<uint64_t> enterCalls;
+#endif
+        
+        EventLoop(int index, socket_t listener)
+            : index(index), listener(listener), epollFd(-1), wakeFd(-1), stopped(false), nextConnectionId(0)
+#ifdef HAVE_IO_URING
+              , enterCalls(0)
+#endif
+        {}
+    };
+    
+    // A completion posted after its loop exited is dropped, which cancels
+    // the stream it may carry
+    void postCompletion(EventLoop& loop, Completion completion) {
+        {
+            std::lock_guard<std::mutex> lock(loop.completionMutex);
+            if (loop.stopped) return;
+            loop.completions.push_back(std::move(completion));
+        }
+        uint64_t one = 1;
+        ssize_t written = write(loop.wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+    
+    // Returns false if the pool refused the request
+    bool dispatchRequest(EventLoop& loop, Connection& conn, HttpRequest req) {
+        int requestNumber = ++conn.requestsServed;
+        socket_t fd = conn.fd;
+        uint64_t id = conn.id;
+        auto request = std::make_shared<HttpRequest>(std::move(req));
+        
+        return workerPool->trySubmit(
+            [this, &loop, fd, id, requestNumber, request]() {
+                bool keepAlive;
+                WireResponse response = serveRequest(*request, requestNumber, keepAlive);
+                if (!response.producer) {
+                    postCompletion(loop, {fd, id, std::move(response), keepAlive, false});
+                    return;
+                }
+                
+                // The header block goes out now; this worker then produces the
+                // body into the stream while the loop writes it
+                BodyProducer producer = std::move(response.producer);
+                auto stream = std::make_shared<ResponseStream>(STREAM_WINDOW_CHUNKS, [this, &loop, fd, id]() {
+                    postCompletion(loop, {fd, id, WireResponse(), true, true});
+                });
+                response.stream.reset(new StreamReader(stream));
+                postCompletion(loop, {fd, id, std::move(response), keepAlive, false});
+                
+                BodyWriter writer([&stream](std::string&& chunk) {
+                    return stream->push(std::move(chunk));
+                });
+                producer(writer);
+                writer.finish();
+                stream->finish();
+            },
+            [this, &loop, fd, id]() {
+                postCompletion(loop, {fd, id, buildOverloadResponse(), false, false});
+            });
+    }
+    
+    // Dispatch the next buffered request (if none is in flight) and push queued
+    // output. Returns false once the connection should be closed.
+    bool serviceConnection(EventLoop& loop, Connection& conn) {
+        while (true) {
+            bool progressed = false;
+            if (!conn.inFlight && !conn.closeAfterWrite &&
+                conn.out.pendingBytes() < MAX_PENDING_OUTPUT) {
+                conn.in.consume(conn.parser.feed(conn.in.readPtr(), conn.in.readable()));
+                if (conn.readPaused && conn.in.readable() < maxBufferedInput() && !resumeReading(loop, conn)) {
+                    return false;
+                }
+                
+                if (conn.parser.getState() == HttpRequestParser::State::COMPLETE) {
+                    if (dispatchRequest(loop, conn, conn.parser.takeRequest())) {
+                        conn.inFlight = true;
+                    } else {
+                        conn.out.push(buildOverloadResponse());
+                        conn.closeAfterWrite = true;
+                    }
+                    progressed = true;
+                } else if (conn.parser.getState() == HttpRequestParser::State::ERROR) {
+                    conn.out.push(buildParseErrorResponse(conn.parser));
+                    conn.closeAfterWrite = true;
+                    progressed = true;
+                }
+            }
+            
+#ifdef HAVE_IO_URING
+            WriteResult written = loop.ring ? flushUring(loop, conn) : conn.out.writeTo(conn.fd);
+#else
+            WriteResult written = conn.out.writeTo(conn.fd);
+#endif
+            if (written == WriteResult::FAILED) return false;
+            if (written == WriteResult::BLOCKED) return true;   // Resume on EPOLLOUT / send completion
+            if (written == WriteResult::WAITING) return true;   // Resume on streamReady
+            if (conn.closeAfterWrite) return false;
+            if (conn.peerClosed && !conn.inFlight) return false;
+            if (!progressed) return true;             // Need more bytes or a response
+        }
+    }
+    
+    // Stop reading while the input buffer is full: EPOLLIN off, or the
+    // multishot receive cancelled (its -ECANCELED completion isn't an error)
+    void pauseReading(EventLoop& loop, Connection& conn) {
+        conn.readPaused = true;
+#ifdef HAVE_IO_URING
+        if (loop.ring) {
+            if (conn.recvArmed) cancelOp(loop, conn, URING_RECV);
+            return;
+        }
+#endif
+        epoll_event ev{};
+        ev.events = EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = &conn;
+        epoll_ctl(loop.epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+    }
+    
+    // Read again once the buffer has drained below the limit. Turning
+    // EPOLLIN back on reports input that arrived meanwhile. False if the
+    // connection can't be read from any more.
+    bool resumeReading(EventLoop& loop, Connection& conn) {
+        conn.readPaused = false;
+#ifdef HAVE_IO_URING
+        if (loop.ring) {
+            return conn.recvArmed || conn.peerClosed || armRecv(loop, conn);
+        }
+#endif
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = &conn;
+        return epoll_ctl(loop.epollFd, EPOLL_CTL_MOD, conn.fd, &ev) == 0;
+    }
+    
+    // Read until EAGAIN or a full buffer, then dispatch whatever complete
+    // requests arrived
+    bool onReadable(EventLoop& loop, Connection& conn) {
+        while (true) {
+            if (conn.in.readable() >= maxBufferedInput()) {
+                if (!conn.readPaused) pauseReading(loop, conn);
+                break;
+            }
+            char* space = conn.in.writePtr(4096);
+            ssize_t n = recv(conn.fd, space, conn.in.writable(), 0);
+            if (n > 0) {
+                conn.in.commit(n);
+            } else if (n == 0) {
+                // A half-closed client still gets the responses it is owed
+                conn.peerClosed = true;
+                break;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
             } else {
-                system.setClaimWebhookUrl(url);
-                system.saveToFile("data.json");
-                res.body = "{\"success\": true, \"claimWebhookUrl\": \"" + url + "\"}";
+                return false;
             }
         }
-        else if (req.path == "/" || req.path == "/api") {
-            // API info
-            res.body = "{\"name\": \"Lost & Found API\", \"version\": \"2.0.0\", \"status\": \"running\", \"features\": [\"categories\", \"advanced-search\", \"expiration\", \"webhooks\"]}";
+        
+        conn.lastActivity = std::chrono::steady_clock::now();
+        return serviceConnection(loop, conn);
+    }
+    
+    // On loop exit: drop undelivered responses and refuse later ones. A
+    // streamed response's reader is cancelled as it goes, so the worker
+    // producing its body stops instead of blocking on a full window while
+    // the pool is joined.
+    void stopCompletions(EventLoop& loop) {
+        std::vector<Completion> pending;    // Destroyed once the lock is released
+        std::lock_guard<std::mutex> lock(loop.completionMutex);
+        loop.stopped = true;
+        pending.swap(loop.completions);
+    }
+    
+    // Deliver worker responses to their connections (if still open)
+    void drainCompletions(EventLoop& loop) {
+        uint64_t counter;
+        ssize_t drained = read(loop.wakeFd, &counter, sizeof(counter));
+        (void)drained;
+        
+        std::vector<Completion> batch;
+        {
+            std::lock_guard<std::mutex> lock(loop.completionMutex);
+            batch.swap(loop.completions);
         }
-        else if (req.path.rfind("/api/item/", 0) == 0 && req.method == "DELETE") {
-            // Delete item by ID
-            std::string itemId = req.path.substr(10); // Extract ID after "/api/item/"
+        
+        for (auto& completion : batch) {
+            auto it = loop.connections.find(completion.fd);
+            if (it == loop.connections.end() || it->second->id != completion.connectionId) {
+                continue; // Closed while the request was being handled
+            }
             
-            if (itemId.empty()) {
-                res.status = 400;
-                res.statusText = "Bad Request";
-                res.body = "{\"error\": \"Item ID is required\"}";
-                return res;
+            Connection& conn = *it->second;
+            if (!completion.streamReady) {
+                conn.inFlight = false;
+                conn.out.push(std::move(completion.response));
+                if (!completion.keepAlive) conn.closeAfterWrite = true;
             }
+            conn.lastActivity = std::chrono::steady_clock::now();
             
-            bool deleted = system.deleteItem(itemId);
+            if (!serviceConnection(loop, conn)) {
+                closeConnection(loop, completion.fd);
+            }
+        }
+    }
+    
+    void acceptConnections(EventLoop& loop) {
+        while (running) {
+            socket_t clientSocket = accept4(loop.listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientSocket == INVALID_SOCKET) {
+                if (errno == EINTR) continue;
+                return; // EAGAIN: backlog drained (or another loop won the race)
+            }
             
-            if (deleted) {
-                system.saveToFile("data.json");
-                res.body = "{\"success\": true, \"message\": \"Item deleted successfully\"}";
-            } else {
-                res.status = 404;
-                res.statusText = "Not Found";
-                res.body = "{\"error\": \"Item not found\"}";
+            auto conn = std::make_unique<Connection>(clientSocket, ++loop.nextConnectionId, config.parserLimits);
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.ptr = conn.get();
+            if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, clientSocket, &ev) < 0) {
+                CLOSE_SOCKET(clientSocket);
+                continue;
             }
+            loop.connections[clientSocket] = std::move(conn);
         }
-        else {
-            res.status = 404;
-            res.statusText = "Not Found";
-            res.body = "{\"error\": \"Endpoint not found\"}";
+    }
+    
+    void closeConnection(EventLoop& loop, socket_t fd) {
+#ifdef HAVE_IO_URING
+        if (loop.ring) {
+            auto it = loop.connections.find(fd);
+            if (it != loop.connections.end()) retireUring(loop, *it->second);
+            return;
         }
+#endif
+        epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        closeGracefully(fd);
+        loop.connections.erase(fd);
+    }
+    
+    // Close keep-alive connections that have been idle too long (checked once a second)
+    void sweepIdleConnections(EventLoop& loop, std::chrono::steady_clock::time_point& lastSweep) {
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSweep < std::chrono::seconds(1)) return;
+        lastSweep = now;
         
-        return res;
+        auto idleTimeout = std::chrono::seconds(config.keepAliveTimeoutSec);
+        std::vector<socket_t> expired;
+        for (auto& pair : loop.connections) {
+            const Connection& conn = *pair.second;
+            if (!conn.inFlight && conn.out.empty() && now - conn.lastActivity > idleTimeout) {
+                expired.push_back(pair.first);
+            }
+        }
+        for (socket_t fd : expired) {
+            closeConnection(loop, fd);
+        }
     }
     
-    void handleClient(socket_t clientSocket) {
-        char buffer[8192] = {0};
-        int bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+    // Pin the calling thread to the index-th CPU this process may run on
+    static void pinToCpu(int index) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) return;
         
-        if (bytesRead > 0) {
-            std::string request(buffer, bytesRead);
-            HttpRequest req = parseRequest(request);
-            HttpResponse res = handleRequest(req);
-            std::string response = buildResponse(res);
+        int target = index % CPU_COUNT(&allowed);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &allowed) || target-- > 0) continue;
+            cpu_set_t single;
+            CPU_ZERO(&single);
+            CPU_SET(cpu, &single);
+            pthread_setaffinity_np(pthread_self(), sizeof(single), &single);
+            return;
+        }
+    }
+    
+    // One reactor per thread. Loops either share the listening socket, with
+    // EPOLLEXCLUSIVE so a new connection wakes only one of them, or each own
+    // an SO_REUSEPORT listener and the kernel spreads connections across them.
+    void runEventLoop(EventLoop& loop) {
+        if (config.pinThreads) {
+            pinToCpu(loop.index);
+        }
+        
+        loop.epollFd = epoll_create1(EPOLL_CLOEXEC);
+        loop.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop.epollFd < 0 || loop.wakeFd < 0) {
+            std::cerr << "Failed to create event loop" << std::endl;
+            return;
+        }
+        
+        // data.ptr tags: nullptr = listener, &loop = wakeup, otherwise a Connection
+        epoll_event listenEvent{};
+        listenEvent.events = config.reusePort ? EPOLLIN : (EPOLLIN | EPOLLEXCLUSIVE);
+        listenEvent.data.ptr = nullptr;
+        epoll_event wakeEvent{};
+        wakeEvent.events = EPOLLIN;
+        wakeEvent.data.ptr = &loop;
+        if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, loop.listener, &listenEvent) < 0 ||
+            epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, loop.wakeFd, &wakeEvent) < 0) {
+            std::cerr << "Failed to register event loop descriptors with epoll" << std::endl;
+            return;
+        }
+        
+        std::vector<epoll_event> events(256);
+        auto lastSweep = std::chrono::steady_clock::now();
+        
+        while (running) {
+            int ready = epoll_wait(loop.epollFd, events.data(), static_cast<int>(events.size()), 1000);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            
+            bool wakeup = false;
+            for (int i = 0; i < ready; i++) {
+                if (events[i].data.ptr == nullptr) {
+                    acceptConnections(loop);
+                    continue;
+                }
+                if (events[i].data.ptr == &loop) {
+                    wakeup = true;
+                    continue;
+                }
+                
+                Connection* conn = static_cast<Connection*>(events[i].data.ptr);
+                uint32_t flags = events[i].events;
+                bool keepOpen = !(flags & EPOLLERR);
+                if (keepOpen && (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+                    keepOpen = onReadable(loop, *conn);
+                }
+                if (keepOpen && (flags & EPOLLOUT) && !conn->out.empty()) {
+                    keepOpen = serviceConnection(loop, *conn);
+                }
+                if (!keepOpen) {
+                    closeConnection(loop, conn->fd);
+                }
+            }
             
-            send(clientSocket, response.c_str(), response.length(), 0);
+            // Completions last, after this batch's events stopped referencing
+            // any connection they might close
+            if (wakeup) {
+                drainCompletions(loop);
+            }
+            
+            sweepIdleConnections(loop, lastSweep);
         }
         
-        CLOSE_SOCKET(clientSocket);
+        stopCompletions(loop);
+        for (auto& pair : loop.connections) {
+            CLOSE_SOCKET(pair.first);
+        }
+        loop.connections.clear();
+        if (loop.listener != serverSocket) {
+            CLOSE_SOCKET(loop.listener);
+        }
     }
     
-public:
-    HttpServer(int port, LostFoundSystem& sys) : port(port), running(false), system(sys) {
-        serverSocket = INVALID_SOCKET;
+    // Start config.eventLoopThreads loops running loopBody and wait for them
+    bool runEventLoops(void (HttpServer::*loopBody)(EventLoop&)) {
+        // Listeners must not block: accepts run until EAGAIN, and shared
+        // listeners are raced for by several loops
+        fcntl(serverSocket, F_SETFL, fcntl(serverSocket, F_GETFL, 0) | O_NONBLOCK);
+        
+        for (int i = 0; i < config.eventLoopThreads; i++) {
+            socket_t listener = serverSocket;
+            if (config.reusePort && i > 0) {
+                listener = openListener();
+                if (listener == INVALID_SOCKET) {
+                    for (auto& loop : eventLoops) {
+                        if (loop->listener != serverSocket) CLOSE_SOCKET(loop->listener);
+                    }
+                    eventLoops.clear();
+                    return false;
+                }
+                fcntl(listener, F_SETFL, fcntl(listener, F_GETFL, 0) | O_NONBLOCK);
+            }
+            eventLoops.push_back(std::make_unique<EventLoop>(i, listener));
+        }
+        
+        std::vector<std::thread> loops;
+        for (auto& loop : eventLoops) {
+            loops.emplace_back(loopBody, this, std::ref(*loop));
+        }
+        for (auto& loop : loops) {
+            loop.join();
+        }
+        return true;
     }
     
-    bool start() {
-#ifdef _WIN32
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-            std::cerr << "WSAStartup failed" << std::endl;
-            return false;
+#ifdef HAVE_IO_URING
+    // ========================================================================
+    // IO_URING BACKEND - Completion-based event loops
+    // Each loop keeps a multishot accept on its listener and a multishot
+    // receive per connection that picks from a group of provided buffers.
+    // Sends go out as one SENDMSG over the queued iovecs; a final response is
+    // linked to shutdown + close so the whole teardown is one submission.
+    // Everything queued in a loop iteration is submitted by a single
+    // io_uring_enter that also waits for the next completions.
+    // ========================================================================
+    static const unsigned URING_ENTRIES = 1024;
+    static const unsigned URING_RECV_BUFFERS = 256;     // Per loop, power of two
+    static const size_t URING_RECV_BUFFER_SIZE = 16 * 1024;
+    
+    // user_data = Connection pointer (8-byte aligned) | operation tag
+    enum UringOp : uint64_t {
+        URING_BUFFERS = 0,      // Returned receive buffer (failures only)
+        URING_ACCEPT = 1,
+        URING_WAKE = 2,
+        URING_RECV = 3,
+        URING_SEND = 4,
+        URING_SHUTDOWN = 5,
+        URING_CLOSE = 6,
+        URING_CANCEL = 7
+    };
+    static const uint64_t URING_OP_MASK = 7;
+    
+    static uint64_t uringTag(Connection* conn, UringOp op) {
+        return reinterpret_cast<uint64_t>(conn) | op;
+    }
+    
+    // Ops the backend needs; SEND_ZC marks the 6.0 kernels that also have
+    // multishot receive, which can't be probed directly
+    static bool uringSupported(IoUring& ring) {
+        static const uint8_t required[] = {
+            IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_SHUTDOWN,
+            IORING_OP_CLOSE, IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL, IORING_OP_PROVIDE_BUFFERS,
+            IORING_OP_SEND_ZC
+        };
+        return ring.hasFeature(IORING_FEAT_EXT_ARG) && ring.hasFeature(IORING_FEAT_NODROP) &&
+               ring.supportsOps(required, sizeof(required));
+    }
+    
+    // Set up a ring the way the loops will; empty string when usable
+    std::string probeUring() {
+        IoUring ring;
+        int result = ring.init(8);
+        if (result < 0) return std::string("io_uring_setup: ") + std::strerror(-result);
+        if (!uringSupported(ring)) return "kernel lacks required io_uring features (needs 6.0+)";
+        ProvidedBuffers buffers;
+        result = buffers.init(ring, 0, 8, 4096);
+        if (result < 0) return std::string("provide buffers: ") + std::strerror(-result);
+        return "";
+    }
+    
+    uint64_t uringEnterCalls() {
+        uint64_t total = 0;
+        for (auto& loop : eventLoops) {
+            total += loop->enterCalls.load(std::memory_order_relaxed);
         }
-#endif
+        return total;
+    }
+    
+    io_uring_sqe* uringSqe(EventLoop& loop, Connection* conn, UringOp op) {
+        io_uring_sqe* sqe = loop.ring->getSqe();
+        if (sqe) {
+            sqe->user_data = uringTag(conn, op);
+            if (conn) conn->pendingOps++;
+        }
+        return sqe;
+    }
+    
+    void armAccept(EventLoop& loop) {
+        io_uring_sqe* sqe = uringSqe(loop, nullptr, URING_ACCEPT);
+        if (!sqe) return;
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = loop.listener;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+    }
+    
+    void armWake(EventLoop& loop) {
+        io_uring_sqe* sqe = uringSqe(loop, nullptr, URING_WAKE);
+        if (!sqe) return;
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = loop.wakeFd;
+        sqe->len = IORING_POLL_ADD_MULTI;
+        sqe->poll32_events = POLLIN;
+    }
+    
+    bool armRecv(EventLoop& loop, Connection& conn) {
+        io_uring_sqe* sqe = uringSqe(loop, &conn, URING_RECV);
+        if (!sqe) return false;
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = conn.fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = loop.recvBuffers->group();
+        conn.recvArmed = true;
+        return true;
+    }
+    
+    void cancelOp(EventLoop& loop, Connection& conn, UringOp op) {
+        io_uring_sqe* sqe = uringSqe(loop, &conn, URING_CANCEL);
+        if (!sqe) return;
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = uringTag(&conn, op);
+    }
+    
+    // Queue the next send (if none is in flight). The last bytes owed on a
+    // connection closing after this response are linked to shutdown + close.
+    WriteResult flushUring(EventLoop& loop, Connection& conn) {
+        if (conn.sending || conn.closeLinked) return WriteResult::BLOCKED;
         
-        serverSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-        if (serverSocket == INVALID_SOCKET) {
+        WriteResult status;
+        int count = conn.out.gather(conn.sendIov, Connection::MAX_SEND_IOV, status);
+        if (count == 0) return status;
+        
+        size_t total = 0;
+        for (int i = 0; i < count; i++) {
+            total += conn.sendIov[i].iov_len;
+        }
+        bool last = conn.closeAfterWrite && total == conn.out.pendingBytes() && !conn.out.streaming();
+        
+        std::memset(&conn.sendMsg, 0, sizeof(conn.sendMsg));
+        conn.sendMsg.msg_iov = conn.sendIov;
+        conn.sendMsg.msg_iovlen = count;
+        io_uring_sqe* sqe = uringSqe(loop, &conn, URING_SEND);
+        if (!sqe) return WriteResult::FAILED;
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = conn.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&conn.sendMsg);
+        sqe->len = 1;
+        // WAITALL makes a short send fail the link instead of closing early
+        sqe->msg_flags = MSG_NOSIGNAL | (last ? MSG_WAITALL : 0);
+        conn.sending = true;
+        
+        if (last) {
+            sqe->flags |= IOSQE_IO_LINK;
+            io_uring_sqe* shut = uringSqe(loop, &conn, URING_SHUTDOWN);
+            io_uring_sqe* closeSqe = shut ? uringSqe(loop, &conn, URING_CLOSE) : nullptr;
+            if (shut && closeSqe) {
+                shut->opcode = IORING_OP_SHUTDOWN;
+                shut->fd = conn.fd;
+                shut->len = SHUT_WR;
+                shut->flags = IOSQE_IO_LINK;
+                closeSqe->opcode = IORING_OP_CLOSE;
+                closeSqe->fd = conn.fd;
+                conn.closeLinked = true;
+            }
+        }
+        return WriteResult::BLOCKED;
+    }
+    
+    // Stop serving a connection. It moves to the retired list until every
+    // operation referencing it has completed.
+    void retireUring(EventLoop& loop, Connection& conn) {
+        if (conn.closing) return;
+        conn.closing = true;
+        
+        auto it = loop.connections.find(conn.fd);
+        if (it != loop.connections.end() && it->second.get() == &conn) {
+            loop.retired.push_back(std::move(it->second));
+            loop.connections.erase(it);
+        }
+        
+        if (conn.recvArmed) cancelOp(loop, conn, URING_RECV);
+        if (conn.sending) cancelOp(loop, conn, URING_SEND);
+        // A pending linked close either runs or comes back cancelled; the
+        // cancelled case closes the descriptor itself
+        if (!conn.closeLinked && !conn.fdClosed) {
+            io_uring_sqe* sqe = uringSqe(loop, &conn, URING_CLOSE);
+            if (sqe) {
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->fd = conn.fd;
+            }
+        }
+    }
+    
+    void onUringAccept(EventLoop& loop, const io_uring_cqe& cqe) {
+        if (!(cqe.flags & IORING_CQE_F_MORE) && running) {
+            armAccept(loop);
+        }
+        if (cqe.res < 0) return;
+        
+        socket_t fd = cqe.res;
+        auto existing = loop.connections.find(fd);
+        if (existing != loop.connections.end()) {
+            // The kernel already reused the number, so its linked close ran
+            existing->second->fdClosed = true;
+            retireUring(loop, *existing->second);
+        }
+        
+        auto conn = std::make_unique<Connection>(fd, ++loop.nextConnectionId, config.parserLimits);
+        if (armRecv(loop, *conn)) {
+            loop.connections[fd] = std::move(conn);
+        } else {
+            CLOSE_SOCKET(fd);
+        }
+    }
+    
+    void onUringRecv(EventLoop& loop, Connection& conn, const io_uring_cqe& cqe) {
+        bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+        if (!more) {
+            conn.recvArmed = false;
+            conn.pendingOps--;
+        }
+        if (cqe.res > 0) {
+            uint16_t bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            if (!conn.closing) {
+                std::memcpy(conn.in.writePtr(cqe.res), loop.recvBuffers->data(bufferId), cqe.res);
+                conn.in.commit(cqe.res);
+            }
+            loop.recvBuffers->recycle(bufferId);
+        }
+        if (conn.closing) return;
+        
+        bool keepOpen = true;
+        if (cqe.res > 0) {
+            conn.lastActivity = std::chrono::steady_clock::now();
+            keepOpen = serviceConnection(loop, conn);
+        } else if (cqe.res == 0) {
+            // A half-closed client still gets the responses it is owed
+            conn.peerClosed = true;
+            keepOpen = serviceConnection(loop, conn);
+        } else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+            keepOpen = false;   // Cancelled by pauseReading(); closing returned above
+        }
+        
+        if (keepOpen && !conn.readPaused && conn.in.readable() >= maxBufferedInput()) {
+            pauseReading(loop, conn);
+        }
+        // Out of buffers or a one-off completion: receive again (buffers
+        // recycled above are queued ahead of the new receive)
+        if (keepOpen && !conn.recvArmed && !conn.peerClosed && !conn.readPaused) {
+            keepOpen = armRecv(loop, conn);
+        }
+        if (!keepOpen) retireUring(loop, conn);
+    }
+    
+    void onUringSend(EventLoop& loop, Connection& conn, const io_uring_cqe& cqe) {
+        conn.pendingOps--;
+        conn.sending = false;
+        if (cqe.res >= 0) conn.out.consume(static_cast<size_t>(cqe.res));
+        if (conn.closing) return;
+        
+        if (cqe.res < 0) {
+            retireUring(loop, conn);
+        } else if (!conn.closeLinked && !serviceConnection(loop, conn)) {
+            retireUring(loop, conn);
+        }
+        // With a close linked, its completion decides what happens next
+    }
+    
+    void onUringClose(EventLoop& loop, Connection& conn, const io_uring_cqe& cqe) {
+        conn.pendingOps--;
+        bool linked = conn.closeLinked;
+        conn.closeLinked = false;
+        
+        if (cqe.res == -ECANCELED && linked) {
+            // The send before it failed or came up short
+            if (conn.closing) {
+                io_uring_sqe* sqe = uringSqe(loop, &conn, URING_CLOSE);
+                if (sqe) {
+                    sqe->opcode = IORING_OP_CLOSE;
+                    sqe->fd = conn.fd;
+                }
+            } else if (!serviceConnection(loop, conn)) {
+                retireUring(loop, conn);
+            }
+            return;
+        }
+        conn.fdClosed = true;
+        retireUring(loop, conn);
+    }
+    
+    void onUringCompletion(EventLoop& loop, const io_uring_cqe& cqe, bool& wakeup) {
+        UringOp op = static_cast<UringOp>(cqe.user_data & URING_OP_MASK);
+        Connection* conn = reinterpret_cast<Connection*>(cqe.user_data & ~URING_OP_MASK);
+        switch (op) {
+        case URING_BUFFERS:
+            break;
+        case URING_ACCEPT:
+            onUringAccept(loop, cqe);
+            break;
+        case URING_WAKE:
+            wakeup = true;
+            if (!(cqe.flags & IORING_CQE_F_MORE)) armWake(loop);
+            break;
+        case URING_RECV:
+            onUringRecv(loop, *conn, cqe);
+            break;
+        case URING_SEND:
+            onUringSend(loop, *conn, cqe);
+            break;
+        case URING_CLOSE:
+            onUringClose(loop, *conn, cqe);
+            break;
+        default:    // URING_SHUTDOWN, URING_CANCEL
+            conn->pendingOps--;
+            break;
+        }
+    }
+    
+    void runUringLoop(EventLoop& loop) {
+        if (config.pinThreads) {
+            pinToCpu(loop.index);
+        }
+        
+        loop.ring = std::make_unique<IoUring>();
+        loop.recvBuffers = std::make_unique<ProvidedBuffers>();
+        loop.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        // Only this thread submits; let the kernel skip cross-thread signalling
+        int result = loop.ring->init(URING_ENTRIES, IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN);
+        if (result == -EINVAL) result = loop.ring->init(URING_ENTRIES);
+        if (result == 0) result = loop.recvBuffers->init(*loop.ring, 0, URING_RECV_BUFFERS, URING_RECV_BUFFER_SIZE);
+        if (result < 0 || loop.wakeFd < 0) {
+            std::cerr << "Failed to create io_uring event loop" << std::endl;
+            return;
+        }
+        
+        armAccept(loop);
+        armWake(loop);
+        
+        auto lastSweep = std::chrono::steady_clock::now();
+        while (running) {
+            result = loop.ring->submitAndWait(1000);
+            loop.enterCalls.store(loop.ring->getEnterCalls(), std::memory_order_relaxed);
+            if (result < 0 && result != -ETIME && result != -EINTR && result != -EBUSY) {
+                std::cerr << "io_uring_enter failed: " << std::strerror(-result) << std::endl;
+                break;
+            }
+            
+            bool wakeup = false;
+            loop.ring->forEachCompletion([&](const io_uring_cqe& cqe) {
+                onUringCompletion(loop, cqe, wakeup);
+            });
+            if (wakeup) {
+                drainCompletions(loop);
+            }
+            
+            loop.retired.erase(std::remove_if(loop.retired.begin(), loop.retired.end(),
+                [](const std::unique_ptr<Connection>& conn) { return conn->pendingOps == 0; }),
+                loop.retired.end());
+            sweepIdleConnections(loop, lastSweep);
+        }
+        
+        // Tearing down the ring cancels everything still in flight
+        stopCompletions(loop);
+        loop.recvBuffers.reset();
+        loop.ring.reset();
+        for (auto& pair : loop.connections) {
+            CLOSE_SOCKET(pair.first);
+        }
+        for (auto& conn : loop.retired) {
+            if (!conn->fdClosed) CLOSE_SOCKET(conn->fd);
+        }
+        loop.connections.clear();
+        loop.retired.clear();
+        if (loop.listener != serverSocket) {
+            CLOSE_SOCKET(loop.listener);
+        }
+    }
+#endif
+#endif
+    
+    // Bound, listening TCP socket on the configured port; SO_REUSEPORT is set
+    // in --reuseport mode so every event loop can bind its own
+    socket_t openListener() {
+        socket_t listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener == INVALID_SOCKET) {
             std::cerr << "Failed to create socket" << std::endl;
-            return false;
+            return INVALID_SOCKET;
         }
         
         // Allow port reuse
         int opt = 1;
 #ifdef _WIN32
-        setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt));
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt));
 #else
-        setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+#ifdef SO_REUSEPORT
+        if (config.reusePort && setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+            std::cerr << "SO_REUSEPORT not supported" << std::endl;
+            CLOSE_SOCKET(listener);
+            return INVALID_SOCKET;
+        }
+#endif
 #endif
         
         struct sockaddr_in serverAddr;
         serverAddr.sin_family = AF_INET;
         serverAddr.sin_addr.s_addr = INADDR_ANY;
-        serverAddr.sin_port = htons(port);
+        serverAddr.sin_port = htons(config.port);
         
-        if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
+        if (bind(listener, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
             std::cerr << "Bind failed" << std::endl;
-            CLOSE_SOCKET(serverSocket);
-            return false;
+            CLOSE_SOCKET(listener);
+            return INVALID_SOCKET;
         }
         
-        if (listen(serverSocket, SOMAXCONN) == SOCKET_ERROR) {
+        if (listen(listener, SOMAXCONN) == SOCKET_ERROR) {
             std::cerr << "Listen failed" << std::endl;
+            CLOSE_SOCKET(listener);
+            return INVALID_SOCKET;
+        }
+        return listener;
+    }
+    
+    void runSnapshots() {
+        std::unique_lock<std::mutex> lock(snapshotMutex);
+        while (!snapshotStopping) {
+            snapshotSignal.wait_for(lock, std::chrono::seconds(config.snapshotIntervalSec));
+            if (snapshotStopping) break;
+            lock.unlock();
+            if (system.getLogStats().sinceCheckpoint > 0) {
+                bool written = config.forkSnapshots ? system.backgroundCheckpoint() : system.checkpoint();
+                if (written) {
+                    CheckpointStats stats = system.getCheckpointStats();
+                    std::stringstream message;
+                    message << "Snapshot written to " << SNAPSHOT_FILE << " in " << static_cast<long long>(stats.lastDurationMs) << " ms";
+                    if (stats.lastForked) {
+                        message << " (fork " << stats.lastForkMs << " ms, copy-on-write " << stats.lastCowBytes / 1024 << " KB)";
+                    }
+                    appLogger().log(LogLevel::INFO, message.str());
+                } else {
+                    appLogger().log(LogLevel::ERROR, std::string("Snapshot to ") + SNAPSHOT_FILE + " failed; the log keeps growing");
+                }
+            }
+            lock.lock();
+        }
+    }
+    
+public:
+    HttpServer(const ServerConfig& config, LostFoundSystem& sys)
+        : config(config), running(false), system(sys), pollerStopped(false), snapshotStopping(false) {
+        serverSocket = INVALID_SOCKET;
+        std::stringstream prefix;
+        prefix << std::hex << std::chrono::system_clock::now().time_since_epoch().count();
+        etagPrefix = prefix.str();
+        cacheStaticHeaders();
+        registerRoutes();
+        appLogger().setRouteNamer([this](int routeId) { return router.routeName(routeId); });
+        workerPool = std::make_unique<WorkerPool>(config.workerThreads, config.maxQueueDepth,
+                                                  std::chrono::milliseconds(config.queueDeadlineMs));
+        webhookPool = std::make_unique<WorkerPool>(2, 64);
+        if (config.snapshotIntervalSec > 0) {
+            snapshotThread = std::thread(&HttpServer::runSnapshots, this);
+        }
+    }
+    
+    ~HttpServer() {
+        if (snapshotThread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(snapshotMutex);
+                snapshotStopping = true;
+            }
+            snapshotSignal.notify_all();
+            snapshotThread.join();
+        }
+        // Join workers before the event loops they post completions to go away
+        workerPool.reset();
+        webhookPool.reset();
+        // The log writer names routes through this server's router
+        appLogger().shutdown();
+#ifndef _WIN32
+        // stop() only shut it down (Windows closes it there)
+        if (serverSocket != INVALID_SOCKET) {
             CLOSE_SOCKET(serverSocket);
+        }
+#endif
+#ifdef HAVE_EPOLL
+        for (auto& loop : eventLoops) {
+            if (loop->epollFd >= 0) close(loop->epollFd);
+            if (loop->wakeFd >= 0) close(loop->wakeFd);
+        }
+#endif
+    }
+    
+    bool start() {
+#ifdef _WIN32
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            std::cerr << "WSAStartup failed" << std::endl;
+            return false;
+        }
+#endif
+        
+        serverSocket = openListener();
+        if (serverSocket == INVALID_SOCKET) {
             return false;
         }
         
@@ -775,90 +2800,158 @@ public:
         std::cout << "╔══════════════════════════════════════════════════════════╗\n";
         std::cout << "║       LOST & FOUND INTELLIGENCE SYSTEM - API SERVER      ║\n";
         std::cout << "╠══════════════════════════════════════════════════════════╣\n";
-        std::cout << "║  Server running on: http://localhost:" << port << "                 ║\n";
+        std::cout << "║  Server running on: http://localhost:" << config.port << "                 ║\n";
         std::cout << "║  Press Ctrl+C to stop                                    ║\n";
         std::cout << "╠══════════════════════════════════════════════════════════╣\n";
         std::cout << "║  Endpoints:                                              ║\n";
         std::cout << "║  • POST /api/lost    - Report lost item                  ║\n";
         std::cout << "║  • POST /api/found   - Report found item & get matches   ║\n";
         std::cout << "║  • GET  /api/search  - Autocomplete suggestions          ║\n";
-        std::cout << "║  • GET  /api/history - Sorted history (BST)              ║\n";
+        std::cout << "║  • GET  /api/history - Sorted history                    ║\n";
         std::cout << "║  • GET  /api/locations - Available locations             ║\n";
         std::cout << "║  • GET  /api/stats   - System statistics                 ║\n";
         std::cout << "╚══════════════════════════════════════════════════════════╝\n";
         std::cout << "\n";
         
-        while (running) {
-            struct sockaddr_in clientAddr;
-            int clientAddrLen = sizeof(clientAddr);
-            
-            socket_t clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, 
-#ifdef _WIN32
-                (int*)&clientAddrLen
-#else
-                (socklen_t*)&clientAddrLen
-#endif
-            );
-            
-            if (clientSocket != INVALID_SOCKET) {
-                std::thread(&HttpServer::handleClient, this, clientSocket).detach();
+#ifdef HAVE_IO_URING
+        if (config.ioMode == IoMode::IO_URING) {
+            std::string unavailable = probeUring();
+            if (unavailable.empty()) {
+                std::cout << "I/O mode: io_uring (" << config.eventLoopThreads << " event loops"
+                          << (config.reusePort ? " with SO_REUSEPORT listeners" : "")
+                          << (config.pinThreads ? ", pinned to CPUs" : "") << ", "
+                          << config.workerThreads << " workers)" << std::endl;
+                return runEventLoops(&HttpServer::runUringLoop);
             }
+            std::cerr << "io_uring unavailable (" << unavailable << "), falling back to epoll" << std::endl;
+            config.ioMode = IoMode::EPOLL;
+        }
+#endif
+#ifdef HAVE_EPOLL
+        if (config.ioMode == IoMode::EPOLL) {
+            std::cout << "I/O mode: epoll (" << config.eventLoopThreads << " event loops"
+                      << (config.reusePort ? " with SO_REUSEPORT listeners" : "")
+                      << (config.pinThreads ? ", pinned to CPUs" : "") << ", "
+                      << config.workerThreads << " workers)" << std::endl;
+            return runEventLoops(&HttpServer::runEventLoop);
         }
+#endif
+        std::cout << "I/O mode: blocking sockets (" << config.workerThreads << " workers)" << std::endl;
+        runThreadPerConnection();
         
         return true;
     }
     
+    // Make start() return: the loops notice within a second, and a blocked
+    // accept() is woken by shutting the listener down. Async-signal-safe.
     void stop() {
         running = false;
-        CLOSE_SOCKET(serverSocket);
 #ifdef _WIN32
-        WSACleanup();
+        CLOSE_SOCKET(serverSocket);
+#else
+        shutdown(serverSocket, SHUT_RDWR);
 #endif
     }
 };
 
 // Global server pointer for signal handling
 HttpServer* globalServer = nullptr;
-LostFoundSystem* globalSystem = nullptr;
 
-void signalHandler(int signal) {
-    std::cout << "\nShutting down server..." << std::endl;
-    if (globalSystem) {
-        globalSystem->saveToFile("data.json");
-        std::cout << "Data saved to data.json" << std::endl;
-    }
+// Only stops the server: the checkpoint takes locks a request or snapshot
+// thread may hold when the signal lands, so main() writes it once start()
+// has returned
+void signalHandler(int) {
     if (globalServer) {
         globalServer->stop();
     }
-    exit(0);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    ServerConfig config = parseServerConfig(argc, argv);
+    
     std::cout << "Initializing Lost & Found System..." << std::endl;
     
     LostFoundSystem system;
-    globalSystem = &system;
     
-    // Load existing data
-    if (system.loadFromFile("data.json")) {
-        std::cout << "Loaded existing data (" << system.getTotalItems() << " items)" << std::endl;
+    // Load existing data: the binary snapshot, or data.json from before there was one
+    bool imported = false;
+    if (std::ifstream(SNAPSHOT_FILE).good()) {
+        std::string snapshotError;
+        if (!system.loadSnapshot(SNAPSHOT_FILE, snapshotError)) {
+            // Starting empty would overwrite it at the next checkpoint
+            std::cerr << "Cannot load snapshot: " << snapshotError << std::endl;
+            return 1;
+        }
+        std::cout << "Loaded existing data (" << system.getTotalItems() << " items, indexes "
+                  << (system.indexesFromImage() ? "from the saved image" : "rebuilt") << ")" << std::endl;
+    } else if (system.loadFromFile(LEGACY_DATA_FILE)) {
+        std::cout << "Imported " << LEGACY_DATA_FILE << " (" << system.getTotalItems() << " items)" << std::endl;
+        imported = true;
     } else {
         std::cout << "Starting with fresh database" << std::endl;
     }
     
-    // Create and start server
-    HttpServer server(8080, system);
-    globalServer = &server;
+    // Redo what happened after that snapshot, then log from here on
+    std::string logError;
+    long long replayed = system.openLog(SNAPSHOT_FILE, config.walOptions, logError);
+    if (replayed < 0) {
+        std::cerr << "Cannot recover from the write-ahead log: " << logError << std::endl;
+        return 1;
+    }
+    if (replayed > 0) {
+        std::cout << "Replayed " << replayed << " logged changes (" << system.getTotalItems() << " items)" << std::endl;
+    }
+    if (replayed > 0 || imported) {
+        system.checkpoint();
+    }
     
-    // Set up signal handler for graceful shutdown
-    signal(SIGINT, signalHandler);
-    signal(SIGTERM, signalHandler);
+    if (!config.exportJsonPath.empty()) {
+        if (!system.saveToFile(config.exportJsonPath)) {
+            std::cerr << "Cannot write " << config.exportJsonPath << std::endl;
+            return 1;
+        }
+        std::cout << "Exported " << system.getTotalItems() << " items to " << config.exportJsonPath << std::endl;
+        return 0;
+    }
     
-    // Start server
-    if (!server.start()) {
-        std::cerr << "Failed to start server" << std::endl;
-        return 1;
+    {
+        // Create and start server
+        HttpServer server(config, system);
+        globalServer = &server;
+        
+        if (!appLogger().start(config.logLevel, config.logFile)) {
+            std::cerr << "Cannot open log file " << config.logFile << ", logging to stdout" << std::endl;
+            appLogger().start(config.logLevel);
+        }
+        
+        // Set up signal handler for graceful shutdown
+        signal(SIGINT, signalHandler);
+        signal(SIGTERM, signalHandler);
+#ifndef _WIN32
+        // Writes to a peer that went away fail with EPIPE instead of killing us
+        signal(SIGPIPE, SIG_IGN);
+#endif
+        
+        // Start server; returns once a signal has stopped it
+        bool started = server.start();
+        
+        // A second Ctrl+C ends the process at once; the log still holds every change
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        globalServer = nullptr;
+        if (!started) {
+            std::cerr << "Failed to start server" << std::endl;
+            return 1;
+        }
+        std::cout << "\nShutting down server..." << std::endl;
+        // Leaving this scope waits for the workers and the snapshot thread
     }
     
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    if (system.checkpoint()) {
+        std::cout << "Data saved to " << SNAPSHOT_FILE << std::endl;
+    }
     return 0;
 }
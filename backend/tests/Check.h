@@ -0,0 +1,92 @@
+//
+// Check.h - Minimal assertions for the test executables
+// CHECK records a failure and carries on, so one run reports every broken
+// invariant; main() returns checkResult().
+//
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <cstdlib>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+inline std::atomic<int>& checkFailures() {
+    static std::atomic<int> failures(0);
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            checkFailures()++; \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto checkActual = (actual); \
+        auto checkExpected = (expected); \
+        if (!(checkActual == checkExpected)) { \
+            checkFailures()++; \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #actual ", " #expected ") failed: " \
+                      << checkActual << " != " << checkExpected << std::endl; \
+        } \
+    } while (0)
+
+inline int checkResult(const char* name) {
+    int failures = checkFailures().load();
+    if (failures == 0) {
+        std::cout << name << ": all checks passed" << std::endl;
+        return 0;
+    }
+    std::cout << name << ": " << failures << " checks failed" << std::endl;
+    return 1;
+}
+
+// ============================================================================
+// SCRATCH DIRECTORY - Fresh directory for files a test writes, removed
+// with its contents when the test is done
+// ============================================================================
+class ScratchDirectory {
+private:
+    std::string path;
+
+public:
+    ScratchDirectory() {
+#ifndef _WIN32
+        char pattern[] = "/tmp/lostfound-test-XXXXXX";
+        if (mkdtemp(pattern) != nullptr) path = pattern;
+#endif
+    }
+
+    ~ScratchDirectory() {
+#ifndef _WIN32
+        if (path.empty()) return;
+        if (DIR* dir = opendir(path.c_str())) {
+            while (dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name != "." && name != "..") std::remove((path + "/" + name).c_str());
+            }
+            closedir(dir);
+        }
+        rmdir(path.c_str());
+#endif
+    }
+
+    ScratchDirectory(const ScratchDirectory&) = delete;
+    ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+    bool ok() const { return !path.empty(); }
+    std::string file(const std::string& name) const { return path + "/" + name; }
+};
+
+#endif // CHECK_H
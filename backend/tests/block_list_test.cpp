@@ -0,0 +1,104 @@
+//
+// block_list_test.cpp - BlockList against a sorted vector, and copies that
+// share blocks: editing a copy never shows through in the original
+//
+
+#include "Check.h"
+#include "BlockList.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+static bool intLess(int a, int b) {
+    return a < b;
+}
+
+static std::vector<int> contents(const BlockList<int>& list) {
+    return std::vector<int>(list.begin(), list.end());
+}
+
+// Random inserts and erases, checking order, size and both bounds against
+// a vector kept the same way
+static void testMatchesSortedVector() {
+    BlockList<int> list;
+    std::vector<int> model;
+    uint64_t state = 88172645463325252ull;
+    auto next = [&state] {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    for (int step = 0; step < 20000; step++) {
+        int value = static_cast<int>(next() % 3000);
+        // Grow for the first half, shrink for the second, so blocks split and merge
+        bool grow = next() % 4 != 0 ? step < 10000 : step >= 10000;
+        if (grow) {
+            list.insert(list.lowerBound(value, intLess), value);
+            model.insert(std::lower_bound(model.begin(), model.end(), value), value);
+        } else {
+            auto at = list.lowerBound(value, intLess);
+            auto modelAt = std::lower_bound(model.begin(), model.end(), value);
+            CHECK_EQ(at == list.end(), modelAt == model.end());
+            if (at == list.end()) continue;
+            CHECK_EQ(*at, *modelAt);
+            list.erase(at);
+            model.erase(modelAt);
+        }
+    }
+    CHECK_EQ(list.size(), model.size());
+    CHECK(contents(list) == model);
+    CHECK(list.blockCount() <= model.size() / (BlockList<int>::BLOCK_SIZE / 4) + 1);
+    for (int value = -1; value <= 3001; value += 7) {
+        auto lower = list.lowerBound(value, intLess);
+        auto upper = list.upperBound(value, intLess);
+        CHECK_EQ(static_cast<size_t>(std::distance(list.begin(), lower)),
+                 static_cast<size_t>(std::lower_bound(model.begin(), model.end(), value) - model.begin()));
+        CHECK_EQ(static_cast<size_t>(std::distance(list.begin(), upper)),
+                 static_cast<size_t>(std::upper_bound(model.begin(), model.end(), value) - model.begin()));
+    }
+    std::vector<int> backwards(list.rbegin(), list.rend());
+    CHECK(std::equal(backwards.begin(), backwards.end(), model.rbegin()));
+}
+
+static void testCopiesDoNotShareChanges() {
+    BlockList<int> original;
+    for (int i = 0; i < 5000; i++) original.push_back(i * 2);
+    std::vector<int> before = contents(original);
+
+    BlockList<int> copy = original;
+    copy.insert(copy.lowerBound(1001, intLess), 1001);
+    copy.erase(copy.lowerBound(4000, intLess));
+    copy.replace(copy.lowerBound(8000, intLess), 8001);
+    copy.push_back(20000);
+    CHECK(contents(original) == before);
+    CHECK_EQ(copy.size(), before.size() + 1);
+    CHECK_EQ(*copy.lowerBound(1001, intLess), 1001);
+    CHECK_EQ(*copy.lowerBound(4000, intLess), 4002);
+    CHECK_EQ(*copy.lowerBound(8000, intLess), 8001);
+
+    // And the other way round
+    BlockList<int> second = copy;
+    std::vector<int> copied = contents(copy);
+    for (int i = 0; i < 600; i++) original.erase(original.begin());
+    CHECK(contents(copy) == copied);
+    CHECK(contents(second) == copied);
+}
+
+static void testAppendsFillBlocks() {
+    BlockList<int> list;
+    CHECK(list.begin() == list.end());
+    size_t count = 10 * BlockList<int>::BLOCK_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        list.insert(list.upperBound(static_cast<int>(i), intLess), static_cast<int>(i));
+    }
+    CHECK_EQ(list.blockCount(), static_cast<size_t>(10));
+    CHECK_EQ(*list.rbegin(), static_cast<int>(count - 1));
+}
+
+int main() {
+    testMatchesSortedVector();
+    testCopiesDoNotShareChanges();
+    testAppendsFillBlocks();
+    return checkResult("block_list_test");
+}
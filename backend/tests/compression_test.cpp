@@ -0,0 +1,154 @@
+//
+// compression_test.cpp - LZ block codec and cold segment round trips
+//
+
+#include "Check.h"
+#include "Compression.h"
+#include "ColdArchive.h"
+#include <random>
+#include <string>
+#include <vector>
+
+static void checkRoundTrip(const std::string& raw) {
+    std::string block = lzCompress(raw.data(), raw.size());
+    std::string decoded;
+    CHECK(lzDecompress(block.data(), block.size(), raw.size(), decoded));
+    CHECK(decoded == raw);
+}
+
+static void testRoundTrips() {
+    checkRoundTrip("");
+    checkRoundTrip("abc");
+    checkRoundTrip("abcd");
+    checkRoundTrip(std::string(100000, 'x'));           // One long overlapping match
+
+    std::mt19937 random(12345);
+    std::string noise(70000, '\0');                      // Literals only, longer than a distance reaches
+    for (char& c : noise) c = static_cast<char>(random());
+    checkRoundTrip(noise);
+
+    std::string records;                                 // What cold blocks hold: repeated fields and id prefixes
+    for (int i = 0; i < 5000; i++) {
+        records += "ITEM-" + std::to_string(100000 + i) + "|Black Wallet|black|Library|Ali|lost|";
+        records += std::string(static_cast<size_t>(random() % 20), static_cast<char>('a' + i % 26));
+    }
+    checkRoundTrip(records);
+    CHECK(lzCompress(records.data(), records.size()).size() < records.size() / 2);
+}
+
+static void testDamagedBlocks() {
+    std::string raw;
+    for (int i = 0; i < 200; i++) raw += "Lost & Found " + std::to_string(i % 7) + " ";
+    std::string block = lzCompress(raw.data(), raw.size());
+    std::string decoded;
+
+    CHECK(!lzDecompress(block.data(), block.size(), raw.size() - 1, decoded));
+    CHECK(!lzDecompress(block.data(), block.size(), raw.size() + 1, decoded));
+    for (size_t cut = 1; cut < block.size(); cut += 7) {
+        CHECK(!lzDecompress(block.data(), cut, raw.size(), decoded));
+    }
+
+    // A match reaching back before the start of the output
+    std::string bad;
+    bad += static_cast<char>(0x10);     // One literal, then a 4 byte match
+    bad += 'a';
+    bad += static_cast<char>(5);
+    bad += static_cast<char>(0);
+    CHECK(!lzDecompress(bad.data(), bad.size(), 5, decoded));
+}
+
+static Item coldItem(int number) {
+    std::string id = "ITEM-" + std::to_string(100000 + number);
+    Item item(id, "Item " + std::to_string(number % 50), "blue", "Library", "Owner " + std::to_string(number),
+              number % 3 == 0 ? "found" : "lost", 1700000000 + number, "Description of item " + id,
+              static_cast<Category>(number % 5), "owner@example.com");
+    item.archived = true;
+    item.claimed = number % 2 == 0;
+    return item;
+}
+
+static void testColdSegment(const ScratchDirectory& scratch) {
+    const int count = 3000;         // Enough for several blocks
+    std::vector<Item> items;
+    for (int i = 0; i < count; i++) items.push_back(coldItem(i));
+    std::vector<const Item*> sorted;
+    for (const Item& item : items) sorted.push_back(&item);
+
+    std::string path = scratch.file("test.cold.1");
+    CHECK(writeFileDurably(path, ColdSegment::encode(sorted)));
+    std::shared_ptr<ColdSegment> segment = std::make_shared<ColdSegment>();
+    std::string error;
+    CHECK(segment->open(path, 1, error));
+    CHECK_EQ(segment->size(), static_cast<size_t>(count));
+    CHECK(segment->bytes() < static_cast<size_t>(count) * 100);
+
+    Item found;
+    for (int i = 0; i < count; i += 97) {
+        size_t at = segment->find(items[i].id);
+        CHECK(at < segment->size());
+        CHECK(segment->item(at, found));
+        CHECK(found.id == items[i].id && found.name == items[i].name && found.timestamp == items[i].timestamp);
+        CHECK(found.category == items[i].category && found.claimed == items[i].claimed && found.archived);
+    }
+    CHECK_EQ(segment->find("ITEM-000000"), segment->size());
+
+    size_t visited = 0;
+    CHECK(segment->forEach([&](const Item& item) {
+        CHECK(item.id == items[visited].id);
+        visited++;
+    }));
+    CHECK_EQ(visited, static_cast<size_t>(count));
+
+    // Tombstones hide items from every read but leave the segment alone
+    ColdArchive archive;
+    archive.add({segment, {}});
+    CHECK(archive.remove(items[10].id));
+    CHECK(!archive.remove(items[10].id));
+    CHECK(!archive.find(items[10].id, found));
+    CHECK(archive.find(items[11].id, found));
+    CHECK_EQ(archive.count(), static_cast<size_t>(count - 1));
+    CHECK_EQ(archive.tombstones(), static_cast<size_t>(1));
+    CHECK_EQ(archive.count(COLD_FOUND), static_cast<size_t>((count + 2) / 3));    // items[10] is lost
+    size_t live = 0;
+    CHECK(archive.forEach([&](const Item& item) {
+        CHECK(item.id != items[10].id);
+        live++;
+    }));
+    CHECK_EQ(live, static_cast<size_t>(count - 1));
+    CHECK(archive.compactionPlan(4) == std::vector<size_t>{0});
+}
+
+static void testDamagedSegment(const ScratchDirectory& scratch) {
+    std::vector<Item> items;
+    for (int i = 0; i < 10; i++) items.push_back(coldItem(i));
+    std::vector<const Item*> sorted;
+    for (const Item& item : items) sorted.push_back(&item);
+    std::string file = ColdSegment::encode(sorted);
+    std::string error;
+
+    std::string truncated = scratch.file("truncated.cold.2");
+    CHECK(writeFileDurably(truncated, file.substr(0, file.size() - 3)));
+    ColdSegment segment;
+    CHECK(!segment.open(truncated, 2, error));
+
+    // A flipped byte inside a block passes open() but not the block checksum
+    std::string flipped = file;
+    flipped[sizeof(ColdHeader) + 5] ^= 0x40;
+    std::string path = scratch.file("flipped.cold.3");
+    CHECK(writeFileDurably(path, flipped));
+    ColdSegment damaged;
+    CHECK(damaged.open(path, 3, error));
+    Item item;
+    CHECK(!damaged.item(0, item));
+    CHECK(!damaged.forEach([](const Item&) {}));
+}
+
+int main() {
+    ScratchDirectory scratch;
+    CHECK(scratch.ok());
+    testRoundTrips();
+    testDamagedBlocks();
+    testColdSegment(scratch);
+    testDamagedSegment(scratch);
+    return checkResult("compression_test");
+}
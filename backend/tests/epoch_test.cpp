@@ -0,0 +1,142 @@
+//
+// epoch_test.cpp - Epoch-based reclamation: nothing is released while a
+// reader that could have loaded it is still pinned
+//
+
+#include "Check.h"
+#include "Epoch.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Versions live in a pool that outlives the test, so a reader looking at a
+// released one sees the flag instead of freed memory
+struct Version {
+    std::atomic<bool> released;
+    int value;
+
+    Version() : released(false), value(0) {}
+};
+
+static void testPinnedReaderHoldsRetired() {
+    EpochDomain domain;
+    bool first = false, second = false;
+    {
+        EpochDomain::Guard guard = domain.pin();
+        domain.retire([&first] { first = true; });
+        CHECK(!first);
+        CHECK_EQ(domain.getStats().pendingRetired, static_cast<size_t>(1));
+    }
+    // The reader is gone; the next retire sweeps the first
+    domain.retire([&second] { second = true; });
+    CHECK(first);
+    CHECK(second);
+    CHECK_EQ(domain.getStats().reclaimed, static_cast<uint64_t>(2));
+}
+
+static void testNestedGuards() {
+    EpochDomain domain;
+    bool released = false;
+    {
+        EpochDomain::Guard outer = domain.pin();
+        {
+            EpochDomain::Guard inner = domain.pin();
+        }
+        // The outer guard still pins this thread
+        domain.retire([&released] { released = true; });
+        CHECK(!released);
+    }
+    domain.retire([] {});
+    CHECK(released);
+}
+
+// A reader pinned on its own thread until unpin()
+class PinnedReader {
+private:
+    std::atomic<bool> pinned, done;
+    std::thread thread;
+
+public:
+    explicit PinnedReader(EpochDomain& domain) : pinned(false), done(false) {
+        thread = std::thread([this, &domain] {
+            EpochDomain::Guard guard = domain.pin();
+            pinned = true;
+            while (!done) std::this_thread::yield();
+        });
+        while (!pinned) std::this_thread::yield();
+    }
+
+    void unpin() {
+        done = true;
+        if (thread.joinable()) thread.join();
+    }
+
+    ~PinnedReader() { unpin(); }
+};
+
+static void testLaterReaderDoesNotHoldOlderRetired() {
+    bool older = false, newer = false;      // Before the domain, which may release into them
+    EpochDomain domain;
+    PinnedReader early(domain);
+    domain.retire([&older] { older = true; });
+    PinnedReader late(domain);
+    early.unpin();
+    // Only the late reader is left, and it loaded the version after older
+    domain.retire([&newer] { newer = true; });
+    CHECK(older);
+    CHECK(!newer);
+    late.unpin();
+}
+
+static void testConcurrentReadersNeverSeeReleased() {
+    const int writers = 2, readers = 6, versionsPerWriter = 20000;
+    std::vector<std::unique_ptr<Version>> pool;
+    for (int i = 0; i < writers * versionsPerWriter + 1; i++) pool.emplace_back(new Version());
+    EpochDomain domain;
+    std::atomic<Version*> current(pool[0].get());
+    std::atomic<int> nextVersion(1);
+    std::atomic<bool> stop(false);
+    std::atomic<long> reads(0), seenReleased(0);
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back([&] {
+            while (!stop) {
+                EpochDomain::Guard guard = domain.pin();
+                Version* version = current.load();
+                for (int spin = 0; spin < 10; spin++) {
+                    if (version->released.load()) seenReleased++;
+                }
+                reads++;
+            }
+        });
+    }
+    std::vector<std::thread> publishers;
+    for (int w = 0; w < writers; w++) {
+        publishers.emplace_back([&] {
+            for (int i = 0; i < versionsPerWriter; i++) {
+                Version* next = pool[nextVersion++].get();
+                Version* old = current.exchange(next);
+                domain.retire([old] { old->released = true; });
+            }
+        });
+    }
+    for (std::thread& publisher : publishers) publisher.join();
+    stop = true;
+    for (std::thread& thread : threads) thread.join();
+
+    CHECK(reads.load() > 0);
+    CHECK_EQ(seenReleased.load(), 0L);
+    EpochStats stats = domain.getStats();
+    CHECK_EQ(stats.reclaimed + stats.pendingRetired, static_cast<uint64_t>(writers * versionsPerWriter));
+    CHECK(!current.load()->released);
+}
+
+int main() {
+    testPinnedReaderHoldsRetired();
+    testNestedGuards();
+    testLaterReaderDoesNotHoldOlderRetired();
+    testConcurrentReadersNeverSeeReleased();
+    return checkResult("epoch_test");
+}
@@ -0,0 +1,257 @@
+//
+// system_stress_test.cpp - Reporters, mutators, readers and checkpoints
+// running against one LostFoundSystem at once. Readers check what must
+// hold at every moment; afterwards the store, history, tries and inverted
+// index must all agree with what the writers did, in memory and after a
+// restart from the snapshot and log.
+//
+
+#include "Check.h"
+#include "System.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int REPORTERS = 4;
+static const int REPORTS_PER_THREAD = 300;
+static const int MUTATORS = 2;
+static const int READERS = 4;
+
+static const char* const COLORS[] = {"red", "blue", "black", "white"};
+static const char* const LOCATIONS[] = {"Library", "Cafeteria", "Main Gate", "Block A"};
+static const char* const CATEGORIES[] = {"electronics", "books", "keys", "bags", "other"};
+
+// What the writers did to one item; each item is only mutated by one thread
+struct Expected {
+    std::string name;
+    std::string color;
+    std::string category;
+    bool claimed = false;
+    bool archived = false;
+    bool deleted = false;
+};
+
+struct Model {
+    std::mutex mutex;
+    std::vector<std::string> ids;           // In report order
+    std::map<std::string, Expected> items;
+};
+
+// One name token unique to the item, so search can pick it out, and no name
+// a prefix of another, so autocomplete on the whole name must list it
+static std::string itemName(int reporter, int number) {
+    char code[16];
+    std::snprintf(code, sizeof(code), "G%dx%04d", reporter, number);
+    return std::string("Gadget ") + code;
+}
+
+static void reportItems(LostFoundSystem& system, Model& model, int reporter) {
+    for (int i = 0; i < REPORTS_PER_THREAD; i++) {
+        Expected expected;
+        expected.name = itemName(reporter, i);
+        expected.color = COLORS[i % 4];
+        expected.category = CATEGORIES[(reporter + i) % 5];
+        std::string location = LOCATIONS[(i / 4) % 4];
+        std::string id;
+        if (i % 2 == 0) {
+            id = system.reportLostItem(expected.name, expected.color, location, "Owner", "Stress item",
+                                       expected.category, "owner@example.com");
+        } else {
+            std::vector<MatchCandidate> matches;
+            id = system.reportFoundItem(expected.name, expected.color, location, "Finder", "Stress item",
+                                        expected.category, "", matches);
+        }
+        CHECK(!id.empty());
+        std::lock_guard<std::mutex> lock(model.mutex);
+        model.ids.push_back(id);
+        model.items[id] = expected;
+    }
+}
+
+// Mutator m owns the items at positions m, m + MUTATORS, ... in report order
+static void mutateItems(LostFoundSystem& system, Model& model, int mutator, const std::atomic<bool>& reporting) {
+    std::mt19937 random(static_cast<unsigned>(mutator + 1));
+    size_t next = static_cast<size_t>(mutator);
+    while (true) {
+        std::string id;
+        {
+            std::lock_guard<std::mutex> lock(model.mutex);
+            if (next < model.ids.size()) id = model.ids[next];
+        }
+        if (id.empty()) {
+            if (!reporting) break;
+            std::this_thread::yield();
+            continue;
+        }
+        next += MUTATORS;
+
+        Expected change;
+        {
+            std::lock_guard<std::mutex> lock(model.mutex);
+            change = model.items[id];
+        }
+        switch (random() % 4) {
+            case 0:
+                CHECK(system.claimItem(id, "Claimer") == MutationStatus::DONE);
+                change.claimed = change.archived = true;
+                break;
+            case 1:
+                CHECK(system.archiveItem(id) == MutationStatus::DONE);
+                change.archived = true;
+                break;
+            case 2:
+                // Archived first, so the delete may find it in a cold segment
+                CHECK(system.archiveItem(id) == MutationStatus::DONE);
+                std::this_thread::yield();
+                CHECK(system.deleteItem(id) == MutationStatus::DONE);
+                CHECK(system.deleteItem(id) == MutationStatus::NOT_FOUND);
+                change.deleted = true;
+                break;
+            default:
+                break;      // Left as reported
+        }
+        std::lock_guard<std::mutex> lock(model.mutex);
+        model.items[id] = change;
+    }
+}
+
+// What must hold however the writers interleave
+static void readConcurrently(LostFoundSystem& system, const std::atomic<bool>& running, int reader) {
+    std::mt19937 random(static_cast<unsigned>(100 + reader));
+    while (running) {
+        std::vector<Item> history = system.getHistory(true);
+        CHECK(std::is_sorted(history.begin(), history.end(),
+                             [](const Item& a, const Item& b) { return a.timestamp < b.timestamp; }));
+
+        std::string color = COLORS[random() % 4];
+        std::vector<Item> results = system.advancedSearch("", color, "", "", "", 0, 0, false);
+        for (const Item& item : results) {
+            CHECK(item.color == color);
+            CHECK(!item.archived);
+        }
+        CHECK(std::is_sorted(results.begin(), results.end(),
+                             [](const Item& a, const Item& b) { return a.id < b.id; }));
+
+        std::string name = itemName(static_cast<int>(random() % REPORTERS), static_cast<int>(random() % REPORTS_PER_THREAD));
+        for (const std::string& suggestion : system.searchAutocomplete(name)) {
+            CHECK(suggestion.compare(0, name.size(), name) == 0);
+        }
+
+        AnalyticsData analytics = system.getAnalytics();
+        CHECK(analytics.claimedItems <= analytics.totalItems);
+    }
+}
+
+// The history keeps every report, deleted ones included. A restart rebuilds
+// it from the snapshot's items and the log, so only reports deleted since
+// the last checkpoint are still there.
+static void checkAgainstModel(LostFoundSystem& system, Model& model, const char* when, bool restarted) {
+    std::cout << "Checking state " << when << std::endl;
+    size_t live = 0, archived = 0;
+    for (const auto& entry : model.items) {
+        const std::string& id = entry.first;
+        const Expected& expected = entry.second;
+        Item item;
+        bool found = system.getItemById(id, item);
+        CHECK(found == !expected.deleted);
+
+        std::vector<Item> indexed = system.advancedSearch(expected.name, "", "", "", "", 0, 0, true);
+        bool searchable = std::any_of(indexed.begin(), indexed.end(), [&id](const Item& hit) { return hit.id == id; });
+        CHECK(searchable == !expected.deleted);
+        std::vector<Item> active = system.advancedSearch(expected.name, "", "", "", "", 0, 0, false);
+        bool activeHit = std::any_of(active.begin(), active.end(), [&id](const Item& hit) { return hit.id == id; });
+        CHECK(activeHit == (!expected.deleted && !expected.archived));
+        if (!found) continue;
+
+        live++;
+        if (expected.archived) archived++;
+        CHECK(item.name == expected.name);
+        CHECK(item.claimed == expected.claimed);
+        CHECK(item.archived == expected.archived);
+
+        std::vector<std::string> names = system.searchAutocomplete(expected.name);
+        CHECK(std::find(names.begin(), names.end(), expected.name) != names.end());
+        names = system.searchAutocompleteByCategory(expected.name, expected.category);
+        CHECK(std::find(names.begin(), names.end(), expected.name) != names.end());
+    }
+    CHECK_EQ(system.getTotalItems(), live);
+    CHECK_EQ(system.getArchivedItemCount(), archived);
+    CHECK_EQ(system.getActiveItemCount() + archived, live);
+    CHECK_EQ(system.countItemsByType("lost") + system.countItemsByType("found"), live);
+
+    std::vector<Item> history = system.getHistory(true);
+    std::vector<std::string> historyIds;
+    for (const Item& item : history) historyIds.push_back(item.id);
+    std::sort(historyIds.begin(), historyIds.end());
+    CHECK(std::adjacent_find(historyIds.begin(), historyIds.end()) == historyIds.end());
+    if (!restarted) CHECK_EQ(history.size(), model.items.size());
+    for (const auto& entry : model.items) {
+        if (!entry.second.deleted) CHECK(std::binary_search(historyIds.begin(), historyIds.end(), entry.first));
+    }
+}
+
+int main() {
+    ScratchDirectory scratch;
+    CHECK(scratch.ok());
+    std::string dataPath = scratch.file("stress.snap");
+    WalOptions options;
+    options.policy = WalSyncPolicy::NEVER;
+    Model model;
+
+    {
+        LostFoundSystem system;
+        std::string error;
+        CHECK_EQ(system.openLog(dataPath, options, error), 0LL);
+
+        std::atomic<bool> reporting(true), running(true);
+        std::vector<std::thread> reporters, others;
+        for (int r = 0; r < REPORTERS; r++) {
+            reporters.emplace_back(reportItems, std::ref(system), std::ref(model), r);
+        }
+        for (int m = 0; m < MUTATORS; m++) {
+            others.emplace_back(mutateItems, std::ref(system), std::ref(model), m, std::cref(reporting));
+        }
+        for (int r = 0; r < READERS; r++) {
+            others.emplace_back(readConcurrently, std::ref(system), std::cref(running), r);
+        }
+        // Checkpoints move archived items to cold segments under the readers;
+        // every other one is written by a forked child
+        std::thread checkpointer([&system, &running] {
+            for (int round = 0; running; round++) {
+                CHECK(round % 2 == 0 ? system.checkpoint() : system.backgroundCheckpoint());
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        });
+
+        for (std::thread& reporter : reporters) reporter.join();
+        reporting = false;
+        for (int m = 0; m < MUTATORS; m++) others[m].join();
+        running = false;
+        for (size_t i = MUTATORS; i < others.size(); i++) others[i].join();
+        checkpointer.join();
+
+        CHECK_EQ(model.items.size(), static_cast<size_t>(REPORTERS * REPORTS_PER_THREAD));
+        CHECK(system.getColdStats().items > 0);
+        checkAgainstModel(system, model, "after the run", false);
+
+        // Some changes only in the log, for the restart to replay
+        std::string id = model.ids.back();
+        if (!model.items[id].deleted) {
+            CHECK(system.deleteItem(id) == MutationStatus::DONE);
+            model.items[id].deleted = true;
+        }
+    }
+
+    LostFoundSystem restarted;
+    std::string error;
+    CHECK(restarted.loadSnapshot(dataPath, error));
+    CHECK(restarted.openLog(dataPath, options, error) > 0);
+    checkAgainstModel(restarted, model, "after a restart", true);
+
+    return checkResult("system_stress_test");
+}
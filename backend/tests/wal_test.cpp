@@ -0,0 +1,232 @@
+//
+// wal_test.cpp - Write-ahead log: group commit, replay, torn tails,
+// rotation, and what a failed write reports
+//
+
+#include "Check.h"
+#include "Wal.h"
+#include "System.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A record header promising more bytes than follow it, as a crash mid-append leaves
+static const char TORN_RECORD[] = "\x10\x00\x00\x00\x01\x02\x03\x04partial";
+
+static std::vector<std::string> replayAll(const std::string& base, uint64_t first, bool& ok) {
+    std::vector<std::string> records;
+    uint64_t last = 0;
+    size_t count = 0;
+    std::string error;
+    ok = WriteAheadLog::replay(base, first, [&records](const std::string& record) { records.push_back(record); },
+                               last, count, error);
+    return records;
+}
+
+static void testConcurrentWritersReplayInOrder(const ScratchDirectory& scratch, WalSyncPolicy policy) {
+    const int writers = 8, perWriter = 500;
+    std::string base = scratch.file(std::string("group.") + walSyncPolicyName(policy) + ".wal");
+    {
+        WriteAheadLog log;
+        WalOptions options;
+        options.policy = policy;
+        options.batchWindow = std::chrono::microseconds(200);
+        CHECK(log.open(base, 1, options));
+
+        std::vector<std::thread> threads;
+        for (int w = 0; w < writers; w++) {
+            threads.emplace_back([&log, w] {
+                for (int i = 0; i < perWriter; i++) {
+                    std::string record = std::to_string(w) + ":" + std::to_string(i);
+                    CHECK(log.commit(log.append({record})));
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+
+        WalStats stats = log.getStats();
+        CHECK_EQ(stats.appended, static_cast<uint64_t>(writers * perWriter));
+        CHECK_EQ(stats.writeErrors, static_cast<uint64_t>(0));
+        CHECK(stats.batches <= stats.appended);
+        if (policy == WalSyncPolicy::ALWAYS) CHECK_EQ(stats.syncs, stats.batches);
+    }
+
+    bool ok = false;
+    std::vector<std::string> records = replayAll(base, 1, ok);
+    CHECK(ok);
+    CHECK_EQ(records.size(), static_cast<size_t>(writers * perWriter));
+    // Each writer's records come back in the order it committed them
+    std::vector<int> next(writers, 0);
+    for (const std::string& record : records) {
+        size_t colon = record.find(':');
+        int writer = std::stoi(record.substr(0, colon));
+        CHECK_EQ(std::stoi(record.substr(colon + 1)), next[writer]);
+        next[writer]++;
+    }
+}
+
+static void testTornTailIsCutOff(const ScratchDirectory& scratch) {
+    std::string base = scratch.file("torn.wal");
+    {
+        WriteAheadLog log;
+        CHECK(log.open(base, 1, WalOptions()));
+        CHECK(log.commit(log.append({"first", "second"})));
+    }
+    {
+        std::ofstream segment(WriteAheadLog::segmentPath(base, 1), std::ios::binary | std::ios::app);
+        segment.write(TORN_RECORD, sizeof(TORN_RECORD) - 1);
+    }
+    bool ok = false;
+    std::vector<std::string> records = replayAll(base, 1, ok);
+    CHECK(ok);
+    CHECK(records == (std::vector<std::string>{"first", "second"}));
+
+    // Cut off, so records appended now follow the intact ones
+    {
+        WriteAheadLog log;
+        CHECK(log.open(base, 1, WalOptions()));
+        CHECK(log.commit(log.append({"third"})));
+    }
+    records = replayAll(base, 1, ok);
+    CHECK(ok);
+    CHECK(records == (std::vector<std::string>{"first", "second", "third"}));
+
+    // Damage anywhere but the newest segment is not a torn append
+    {
+        std::ofstream segment(WriteAheadLog::segmentPath(base, 1), std::ios::binary | std::ios::app);
+        segment.write(TORN_RECORD, sizeof(TORN_RECORD) - 1);
+        std::ofstream newer(WriteAheadLog::segmentPath(base, 2), std::ios::binary);
+    }
+    replayAll(base, 1, ok);
+    CHECK(!ok);
+}
+
+static void testRotation(const ScratchDirectory& scratch) {
+    std::string base = scratch.file("rotate.wal");
+    WriteAheadLog log;
+    WalOptions options;
+    options.policy = WalSyncPolicy::ALWAYS;
+    CHECK(log.open(base, 1, options));
+    CHECK(log.commit(log.append({"old"})));
+    CHECK_EQ(log.rotate(), static_cast<uint64_t>(2));
+    CHECK(log.commit(log.append({"new"})));
+    CHECK_EQ(log.getStats().sinceCheckpoint, static_cast<uint64_t>(1));
+    log.removeBefore(2);
+    log.close();
+
+    bool ok = false;
+    CHECK(replayAll(base, 1, ok).empty());      // Nothing at 1 any more
+    std::vector<std::string> records = replayAll(base, 2, ok);
+    CHECK(ok);
+    CHECK(records == (std::vector<std::string>{"new"}));
+}
+
+// rotate() writes and flushes the queued records itself while the
+// committer waits out its batch window; a commit() already waiting on one
+// of them has to be released by that flush
+static void testRotationReleasesWaitingCommit(const ScratchDirectory& scratch) {
+    std::string base = scratch.file("rotate-commit.wal");
+    WriteAheadLog log;
+    WalOptions options;
+    options.policy = WalSyncPolicy::ALWAYS;
+    options.batchWindow = std::chrono::seconds(2);
+    CHECK(log.open(base, 1, options));
+
+    uint64_t seq = log.append({"waiting"});
+    std::atomic<bool> returned(false);
+    bool committed = false;
+    std::thread waiter([&] {
+        committed = log.commit(seq);
+        returned = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQ(log.rotate(), static_cast<uint64_t>(2));
+    for (int i = 0; i < 100 && !returned; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(returned);
+
+    // A later batch releases it either way, so a failure doesn't hang here
+    CHECK(log.commit(log.append({"later"})));
+    waiter.join();
+    CHECK(committed);
+    log.close();
+    bool ok = false;
+    CHECK(replayAll(base, 1, ok) == (std::vector<std::string>{"waiting", "later"}));
+    CHECK(ok);
+}
+
+#ifdef __linux__
+// Every write to /dev/full fails with ENOSPC
+static bool segmentOnFullDevice(const std::string& base, uint64_t number) {
+    return symlink("/dev/full", WriteAheadLog::segmentPath(base, number).c_str()) == 0;
+}
+
+static void testFailedWriteIsNotAcknowledged(const ScratchDirectory& scratch, WalSyncPolicy policy) {
+    std::string base = scratch.file(std::string("full.") + walSyncPolicyName(policy) + ".wal");
+    CHECK(segmentOnFullDevice(base, 1));
+    WriteAheadLog log;
+    WalOptions options;
+    options.policy = policy;
+    CHECK(log.open(base, 1, options));
+
+    CHECK(!log.commit(log.append({"lost"})));
+    CHECK(log.getStats().writeErrors > 0);
+    // The segment stays broken: later records are refused too, not
+    // written after a gap that replay would stop at
+    CHECK(!log.commit(log.append({"after"})));
+    CHECK(log.commit(0));
+
+    // A fresh segment takes records again
+    CHECK_EQ(log.rotate(), static_cast<uint64_t>(2));
+    CHECK(log.commit(log.append({"recovered"})));
+    log.close();
+    bool ok = false;
+    std::vector<std::string> records = replayAll(base, 2, ok);
+    CHECK(ok);
+    CHECK(records == (std::vector<std::string>{"recovered"}));
+}
+
+static void testSystemReportsLogFailure(const ScratchDirectory& scratch) {
+    std::string dataPath = scratch.file("full.snap");
+    LostFoundSystem system;
+    WalOptions options;
+    options.policy = WalSyncPolicy::ALWAYS;
+    std::string error;
+    CHECK_EQ(system.openLog(dataPath, options, error), 0LL);
+    // Replay would read the device forever, so it only comes in at the
+    // checkpoint's rotation
+    CHECK(segmentOnFullDevice(dataPath + ".wal", 2));
+    CHECK(system.checkpoint());
+
+    // Applied in memory, but not acknowledged
+    CHECK(system.reportLostItem("Umbrella", "red", "Library", "Ann", "Red umbrella", "other", "").empty());
+    CHECK_EQ(system.getTotalItems(), static_cast<size_t>(1));
+    std::string id = system.getAllItems().front().id;
+    CHECK(system.claimItem(id, "Bo") == MutationStatus::LOG_FAILED);
+    CHECK(system.deleteItem("ITEM-999999") == MutationStatus::NOT_FOUND);
+    std::vector<MatchCandidate> matches;
+    CHECK(system.reportFoundItem("Umbrella", "red", "Library", "Bo", "Red umbrella", "other", "", matches).empty());
+    CHECK(!system.setWebhookUrl("http://localhost/hook"));
+}
+#endif
+
+int main() {
+    ScratchDirectory scratch;
+    CHECK(scratch.ok());
+    testConcurrentWritersReplayInOrder(scratch, WalSyncPolicy::ALWAYS);
+    testConcurrentWritersReplayInOrder(scratch, WalSyncPolicy::EVERYSEC);
+    testConcurrentWritersReplayInOrder(scratch, WalSyncPolicy::NEVER);
+    testTornTailIsCutOff(scratch);
+    testRotation(scratch);
+    testRotationReleasesWaitingCommit(scratch);
+#ifdef __linux__
+    testFailedWriteIsNotAcknowledged(scratch, WalSyncPolicy::ALWAYS);
+    testFailedWriteIsNotAcknowledged(scratch, WalSyncPolicy::NEVER);
+    testSystemReportsLogFailure(scratch);
+#endif
+    return checkResult("wal_test");
+}